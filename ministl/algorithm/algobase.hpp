@@ -1,5 +1,6 @@
 #ifndef MINISTL_ALGOBASE_H
 #define MINISTL_ALGOBASE_H
+#include <cstring>
 #include "../iterator/iterator.hpp"
 #include "../utils/util.hpp"
 
@@ -0,0 +1,3 @@
+#pragma once
+
+#include "./container/btree_set.hpp"
\ No newline at end of file
@@ -0,0 +1,3 @@
+#pragma once
+
+#include "./container/compact_map.hpp"
\ No newline at end of file
@@ -21,6 +21,12 @@ inline void construct(T1* ptr, const T2& value) {
   ::new ((void*)ptr) T1(value);
 }
 
+// 以任意参数原地构造，供emplace系列使用
+template <class T, class... Args>
+inline void construct(T* ptr, Args&&... args) {
+  ::new ((void*)ptr) T(std::forward<Args>(args)...);
+}
+
 // destroy
 template <class T>
 inline void destroy(T* pointer) {
@@ -5,6 +5,7 @@
 #include "../configurator/allocator.hpp"
 #include "../configurator/memory.hpp"
 #include "../functor/functor.hpp"
+#include "../functor/hash_func.hpp"
 #include "../iterator/iterator.hpp"
 #include "../utils/exceptdef.hpp"
 #include "../utils/util.hpp"
@@ -1561,6 +1562,81 @@ bool operator>=(const basic_string<CharType, CharTraits>& lhs,
                 const basic_string<CharType, CharTraits>& rhs) {
   return lhs.compare(rhs) >= 0;
 }
+
+// 与C风格字符串比较，不构造临时的basic_string
+template <class CharType, class CharTraits>
+bool operator==(const basic_string<CharType, CharTraits>& lhs,
+                const CharType* rhs) {
+  return lhs.compare(rhs) == 0;
+}
+template <class CharType, class CharTraits>
+bool operator==(const CharType* lhs,
+                const basic_string<CharType, CharTraits>& rhs) {
+  return rhs.compare(lhs) == 0;
+}
+template <class CharType, class CharTraits>
+bool operator!=(const basic_string<CharType, CharTraits>& lhs,
+                const CharType* rhs) {
+  return lhs.compare(rhs) != 0;
+}
+template <class CharType, class CharTraits>
+bool operator!=(const CharType* lhs,
+                const basic_string<CharType, CharTraits>& rhs) {
+  return rhs.compare(lhs) != 0;
+}
+template <class CharType, class CharTraits>
+bool operator<(const basic_string<CharType, CharTraits>& lhs,
+               const CharType* rhs) {
+  return lhs.compare(rhs) < 0;
+}
+template <class CharType, class CharTraits>
+bool operator<(const CharType* lhs,
+               const basic_string<CharType, CharTraits>& rhs) {
+  return rhs.compare(lhs) > 0;
+}
+template <class CharType, class CharTraits>
+bool operator<=(const basic_string<CharType, CharTraits>& lhs,
+                const CharType* rhs) {
+  return lhs.compare(rhs) <= 0;
+}
+template <class CharType, class CharTraits>
+bool operator<=(const CharType* lhs,
+                const basic_string<CharType, CharTraits>& rhs) {
+  return rhs.compare(lhs) >= 0;
+}
+template <class CharType, class CharTraits>
+bool operator>(const basic_string<CharType, CharTraits>& lhs,
+               const CharType* rhs) {
+  return lhs.compare(rhs) > 0;
+}
+template <class CharType, class CharTraits>
+bool operator>(const CharType* lhs,
+               const basic_string<CharType, CharTraits>& rhs) {
+  return rhs.compare(lhs) < 0;
+}
+template <class CharType, class CharTraits>
+bool operator>=(const basic_string<CharType, CharTraits>& lhs,
+                const CharType* rhs) {
+  return lhs.compare(rhs) >= 0;
+}
+template <class CharType, class CharTraits>
+bool operator>=(const CharType* lhs,
+                const basic_string<CharType, CharTraits>& rhs) {
+  return rhs.compare(lhs) <= 0;
+}
+
+// 字符串的hash，定义了is_transparent，可直接对C风格字符串计算
+// 对同样的字符序列与hash<const char*>结果相同
+template <class CharType, class CharTraits>
+struct hash<basic_string<CharType, CharTraits>> {
+  typedef void is_transparent;
+  size_t operator()(const basic_string<CharType, CharTraits>& s) const {
+    return _ministl_hash_string(s.data(), s.size());
+  }
+  size_t operator()(const CharType* s) const {
+    return _ministl_hash_string(s, CharTraits::length(s));
+  }
+};
 _MINISTL_END
 
 #endif
\ No newline at end of file
@@ -0,0 +1,1172 @@
+#ifndef MINISTL_BTREE_H
+#define MINISTL_BTREE_H
+
+#include "../configurator/allocator.hpp"
+#include "../iterator/iterator.hpp"
+#include "../utils/util.hpp"
+
+_MINISTL_BEGIN
+
+// B+树：元素全部存放在叶节点中，叶节点串成双向环状链表，内部节点只存分隔键
+// 每个节点占NodeBytes字节（默认256，即4条缓存行），一次缓存缺失可以比较几十个键，
+// 树高远低于rb_tree，每个元素也不再需要三个指针与颜色
+
+// 节点公共部分
+struct _btree_node_base {
+  typedef _btree_node_base* base_ptr;
+
+  base_ptr parent;          // 父节点，根节点为0
+  unsigned short position;  // 在父节点children中的下标
+  unsigned short count;     // 叶节点为元素个数，内部节点为键个数
+  bool leaf;
+};
+// 叶节点链接，header也是一个不存元素的叶
+struct _btree_leaf_base : public _btree_node_base {
+  _btree_leaf_base* prev;
+  _btree_leaf_base* next;
+};
+// 叶节点：N个元素
+template <class Value, size_t N>
+struct _btree_leaf_node : public _btree_leaf_base {
+  alignas(Value) unsigned char storage[N * sizeof(Value)];
+
+  Value* values() { return reinterpret_cast<Value*>(storage); }
+};
+// 内部节点：M个分隔键与M+1个子节点
+// children[i]中的键都不小于keys[i-1]且不大于keys[i]
+template <class Key, size_t M>
+struct _btree_inner_node : public _btree_node_base {
+  base_ptr children[M + 1];
+  alignas(Key) unsigned char storage[M * sizeof(Key)];
+
+  Key* keys() { return reinterpret_cast<Key*>(storage); }
+};
+
+// 每个节点能容纳的元素个数，至少为Min
+template <size_t NodeBytes, size_t Head, size_t Slot, size_t Min>
+struct _btree_slots {
+  static const size_t fit = NodeBytes > Head ? (NodeBytes - Head) / Slot : 0;
+  static const size_t value =
+      fit < Min ? Min : (fit > 65535 ? 65535 : fit);  // count为unsigned short
+};
+
+// 将src搬到未构造的dst上，src随后被销毁
+template <class T>
+inline void _btree_relocate(T* dst, T* src) {
+  ::new ((void*)dst) T(std::move(*src));
+  destroy(src);
+}
+// 在有c个元素的数组a的位置p插入x
+template <class T>
+void _btree_insert_value(T* a, size_t c, size_t p, const T& x) {
+  for (size_t i = c; i > p; --i)
+    _btree_relocate(a + i, a + i - 1);
+  try {
+    construct(a + p, x);
+  } catch (...) {
+    for (size_t i = p; i < c; ++i)  // 复制失败，把元素搬回原处
+      _btree_relocate(a + i, a + i + 1);
+    throw;
+  }
+}
+// 删除有c个元素的数组a的位置p
+template <class T>
+void _btree_erase_value(T* a, size_t c, size_t p) {
+  destroy(a + p);
+  for (size_t i = p + 1; i < c; ++i)
+    _btree_relocate(a + i - 1, a + i);
+}
+
+// 迭代器：所在叶节点与叶内下标，end()为(header, 0)
+template <class Value, class Ref, class Ptr, size_t N>
+struct _btree_iterator {
+  typedef _btree_iterator<Value, Value&, Value*, N> iterator;
+  typedef _btree_iterator<Value, const Value&, const Value*, N> const_iterator;
+  typedef _btree_iterator<Value, Ref, Ptr, N> self;
+  typedef _btree_leaf_node<Value, N>* link_type;
+
+  typedef bidirectional_iterator_tag iterator_category;
+  typedef Value value_type;
+  typedef Ptr pointer;
+  typedef Ref reference;
+  typedef size_t size_type;
+  typedef ptrdiff_t difference_type;
+
+  _btree_leaf_base* node;
+  size_type pos;
+
+  _btree_iterator() {}
+  _btree_iterator(_btree_leaf_base* x, size_type p) : node(x), pos(p) {}
+  _btree_iterator(const iterator& x) : node(x.node), pos(x.pos) {}
+
+  reference operator*() const {
+    return static_cast<link_type>(node)->values()[pos];
+  }
+  pointer operator->() const { return &(operator*()); }
+
+  self& operator++() {
+    if (++pos == node->count) {  // 叶节点不会为空，走到header即为end()
+      node = node->next;
+      pos = 0;
+    }
+    return *this;
+  }
+  self operator++(int) {
+    self tmp = *this;
+    ++*this;
+    return tmp;
+  }
+  self& operator--() {
+    if (pos == 0) {
+      node = node->prev;
+      pos = node->count - 1;
+    } else
+      --pos;
+    return *this;
+  }
+  self operator--(int) {
+    self tmp = *this;
+    --*this;
+    return tmp;
+  }
+};
+template <class Value, class Ref1, class Ptr1, class Ref2, class Ptr2, size_t N>
+inline bool operator==(const _btree_iterator<Value, Ref1, Ptr1, N>& x,
+                       const _btree_iterator<Value, Ref2, Ptr2, N>& y) {
+  return x.node == y.node && x.pos == y.pos;
+}
+template <class Value, class Ref1, class Ptr1, class Ref2, class Ptr2, size_t N>
+inline bool operator!=(const _btree_iterator<Value, Ref1, Ptr1, N>& x,
+                       const _btree_iterator<Value, Ref2, Ptr2, N>& y) {
+  return !(x == y);
+}
+
+// btree，接口与rb_tree相同
+template <class Key,
+          class Value,
+          class KeyOfValue,
+          class Compare,
+          class Alloc = alloc,
+          size_t NodeBytes = 256>
+class btree {
+ public:
+  // 叶节点至少4个元素，内部节点至少3个键
+  static const size_t leaf_slots =
+      _btree_slots<NodeBytes, sizeof(_btree_leaf_base), sizeof(Value), 4>::
+          value;
+  static const size_t inner_slots =
+      _btree_slots<NodeBytes,
+                   sizeof(_btree_node_base) + sizeof(void*),
+                   sizeof(Key) + sizeof(void*),
+                   3>::value;
+
+ protected:
+  typedef _btree_node_base* base_ptr;
+  typedef _btree_leaf_base* leaf_base_ptr;
+  typedef _btree_leaf_node<Value, leaf_slots> leaf_node;
+  typedef _btree_inner_node<Key, inner_slots> inner_node;
+  typedef allocator<leaf_node, Alloc> leaf_allocator;
+  typedef allocator<inner_node, Alloc> inner_allocator;
+  typedef allocator<_btree_leaf_base, Alloc> header_allocator;
+
+  // 删除后元素个数低于此值时向兄弟借或与兄弟合并
+  static const size_t leaf_min = leaf_slots / 2;
+  static const size_t inner_min = inner_slots / 2;
+
+ public:
+  typedef Key key_type;
+  typedef Value value_type;
+  typedef value_type* pointer;
+  typedef const value_type* const_pointer;
+  typedef value_type& reference;
+  typedef const value_type& const_reference;
+  typedef size_t size_type;
+  typedef ptrdiff_t difference_type;
+
+  typedef _btree_iterator<value_type, reference, pointer, leaf_slots>
+      iterator;
+  typedef _btree_iterator<value_type,
+                          const_reference,
+                          const_pointer,
+                          leaf_slots>
+      const_iterator;
+  typedef ministl::reverse_iterator<iterator> reverse_iterator;
+  typedef ministl::reverse_iterator<const_iterator> const_reverse_iterator;
+
+ protected:
+  leaf_base_ptr header;  // 叶链表的哨兵
+  base_ptr root;         // 空树时为0
+  size_type node_count;  // 元素个数
+  Compare key_compare;
+
+  static leaf_node* leaf(base_ptr x) { return static_cast<leaf_node*>(x); }
+  static inner_node* inner(base_ptr x) { return static_cast<inner_node*>(x); }
+  static const Key& key(const value_type& v) { return KeyOfValue()(v); }
+
+  leaf_node* get_leaf() {
+    leaf_node* x = leaf_allocator::allocate();
+    x->leaf = true;
+    x->count = 0;
+    x->parent = 0;
+    x->position = 0;
+    return x;
+  }
+  void put_leaf(leaf_node* x) { leaf_allocator::deallocate(x); }
+  inner_node* get_inner() {
+    inner_node* x = inner_allocator::allocate();
+    x->leaf = false;
+    x->count = 0;
+    x->parent = 0;
+    x->position = 0;
+    return x;
+  }
+  void put_inner(inner_node* x) { inner_allocator::deallocate(x); }
+
+  // 将x链接在叶链表中y之后
+  static void link_after(leaf_base_ptr y, leaf_base_ptr x) {
+    x->prev = y;
+    x->next = y->next;
+    y->next->prev = x;
+    y->next = x;
+  }
+  static void unlink(leaf_base_ptr x) {
+    x->prev->next = x->next;
+    x->next->prev = x->prev;
+  }
+  // 令x成为p的第i个子节点
+  static void set_child(inner_node* p, size_type i, base_ptr x) {
+    p->children[i] = x;
+    x->parent = p;
+    x->position = (unsigned short)i;
+  }
+
+  void init() {
+    header = header_allocator::allocate();
+    header->leaf = true;
+    header->count = 0;
+    header->parent = 0;
+    header->position = 0;
+    header->prev = header;
+    header->next = header;
+    root = 0;
+    node_count = 0;
+  }
+
+  // 节点内二分查找，LK为Key，或是透明比较器能与Key比较的任意型别
+  template <class LK>
+  size_type leaf_lower(leaf_node* x, const LK& k) const;
+  template <class LK>
+  size_type leaf_upper(leaf_node* x, const LK& k) const;
+  template <class LK>
+  size_type inner_lower(inner_node* x, const LK& k) const;
+  template <class LK>
+  size_type inner_upper(inner_node* x, const LK& k) const;
+  // 自根向下找到k应在的叶节点，p为叶内位置
+  template <class LK>
+  leaf_node* lower_leaf(const LK& k, size_type& p) const {
+    base_ptr x = root;
+    while (!x->leaf)
+      x = inner(x)->children[inner_lower(inner(x), k)];
+    p = leaf_lower(leaf(x), k);
+    return leaf(x);
+  }
+  template <class LK>
+  leaf_node* upper_leaf(const LK& k, size_type& p) const {
+    base_ptr x = root;
+    while (!x->leaf)
+      x = inner(x)->children[inner_upper(inner(x), k)];
+    p = leaf_upper(leaf(x), k);
+    return leaf(x);
+  }
+  // 查找的实现
+  template <class LK>
+  iterator _lower_bound(const LK& k) const {
+    if (root == 0)
+      return iterator(header, 0);
+    size_type p;
+    leaf_node* x = lower_leaf(k, p);
+    return make_iter(x, p);
+  }
+  template <class LK>
+  iterator _upper_bound(const LK& k) const {
+    if (root == 0)
+      return iterator(header, 0);
+    size_type p;
+    leaf_node* x = upper_leaf(k, p);
+    return make_iter(x, p);
+  }
+  template <class LK>
+  iterator _find(const LK& k) const {
+    iterator j = _lower_bound(k);
+    return (j.node == header || key_compare(k, key(*j))) ? iterator(header, 0)
+                                                         : j;
+  }
+  template <class LK>
+  size_type _count(const LK& k) const {
+    size_type n = 0;
+    for (iterator j = _lower_bound(k);
+         j.node != header && !key_compare(k, key(*j)); ++j)
+      ++n;
+    return n;
+  }
+  // 叶内位置p越过末尾时即为下一个叶的开头
+  static iterator make_iter(leaf_base_ptr x, size_type p) {
+    if (p == x->count)
+      return iterator(x->next, 0);
+    return iterator(x, p);
+  }
+
+  iterator _insert_first(const value_type& v);
+  iterator _insert_leaf(leaf_node* x, size_type p, const value_type& v);
+  void _insert_parent(base_ptr x, Key& k, base_ptr y, inner_node**& spare);
+  void _insert_child(inner_node* p, size_type i, Key& k, base_ptr y);
+  void _remove_child(inner_node* p, size_type i);
+  void _rebalance_leaf(leaf_node*& x, size_type& p);
+  void _rebalance_inner(inner_node* x);
+  void _erase_leaf(leaf_node* x);
+  void _clear(base_ptr x);
+  base_ptr _copy(base_ptr x, inner_node* p, leaf_base_ptr& tail);
+  template <class InputIter>
+  void _assign_sorted(InputIter first, InputIter last);
+  // 以x为根的子树中最小的键
+  static const Key& _min_key(base_ptr x) {
+    while (!x->leaf)
+      x = inner(x)->children[0];
+    return key(leaf(x)->values()[0]);
+  }
+
+ public:
+  btree(const Compare& comp = Compare()) : key_compare(comp) { init(); }
+  btree(const btree& x) : key_compare(x.key_compare) {
+    init();
+    if (x.root != 0) {
+      leaf_base_ptr tail = header;
+      try {
+        root = _copy(x.root, 0, tail);
+      } catch (...) {
+        header_allocator::deallocate(header);
+        throw;
+      }
+      tail->next = header;
+      header->prev = tail;
+      node_count = x.node_count;
+    }
+  }
+  // 直接取走x的header与根，x换上一个新的空header，O(1)
+  btree(btree&& x)
+      : header(x.header),
+        root(x.root),
+        node_count(x.node_count),
+        key_compare(x.key_compare) {
+    x.init();
+  }
+  ~btree() {
+    clear();
+    header_allocator::deallocate(header);
+  }
+  btree& operator=(const btree& x) {
+    if (this != &x) {
+      btree tmp(x);
+      swap(tmp);
+    }
+    return *this;
+  }
+  // 与x交换全部节点，x的原有节点随后在x析构时释放
+  btree& operator=(btree&& x) {
+    swap(x);
+    return *this;
+  }
+
+  Compare key_comp() const { return key_compare; }
+  iterator begin() { return iterator(header->next, 0); }
+  const_iterator begin() const { return const_iterator(header->next, 0); }
+  const_iterator cbegin() const { return begin(); }
+  iterator end() { return iterator(header, 0); }
+  const_iterator end() const { return const_iterator(header, 0); }
+  const_iterator cend() const { return end(); }
+  reverse_iterator rbegin() { return reverse_iterator(end()); }
+  const_reverse_iterator rbegin() const {
+    return const_reverse_iterator(end());
+  }
+  reverse_iterator rend() { return reverse_iterator(begin()); }
+  const_reverse_iterator rend() const {
+    return const_reverse_iterator(begin());
+  }
+
+  bool empty() const { return node_count == 0; }
+  size_type size() const { return node_count; }
+  size_type max_size() const { return size_type(-1); }
+  // 只交换指针，O(1)
+  void swap(btree& x) {
+    std::swap(header, x.header);
+    std::swap(root, x.root);
+    std::swap(node_count, x.node_count);
+    std::swap(key_compare, x.key_compare);
+  }
+
+  // 插入，键值不可重复
+  pair<iterator, bool> insert_unique(const value_type& v);
+  // pos为end()且v大于所有元素时直接追加到最右叶节点
+  iterator insert_unique(iterator pos, const value_type& v) {
+    if (pos == end() && node_count != 0 &&
+        key_compare(key(*--end()), key(v))) {
+      leaf_node* x = leaf(header->prev);
+      return _insert_leaf(x, x->count, v);
+    }
+    return insert_unique(v).first;
+  }
+  template <class InputIter>
+  void insert_unique(InputIter first, InputIter last) {
+    for (; first != last; ++first)
+      insert_unique(end(), *first);
+  }
+  // 由调用者保证[first,last)严格递增，空树时自底向上直接建树，O(n)，否则逐个插入
+  template <class InputIter>
+  void insert_unique(sorted_unique_t, InputIter first, InputIter last) {
+    if (root == 0)
+      _assign_sorted(first, last);
+    else
+      insert_unique(first, last);
+  }
+  // 以args构造出元素后插入，元素在叶节点间搬动，无法直接构造在叶节点中
+  template <class... Args>
+  pair<iterator, bool> emplace_unique(Args&&... args) {
+    return insert_unique(value_type(std::forward<Args>(args)...));
+  }
+  // 先以k查找，只在k不存在时才以args构造元素插入，k须等于所构造元素的键值
+  template <class... Args>
+  pair<iterator, bool> try_emplace_unique(const Key& k, Args&&... args) {
+    if (root == 0)
+      return pair<iterator, bool>(
+          _insert_first(value_type(std::forward<Args>(args)...)), true);
+    size_type p;
+    leaf_node* x = lower_leaf(k, p);
+    iterator j = make_iter(x, p);
+    if (j != end() && !key_compare(k, key(*j)))
+      return pair<iterator, bool>(j, false);
+    return pair<iterator, bool>(
+        _insert_leaf(x, p, value_type(std::forward<Args>(args)...)), true);
+  }
+  // 插入，允许键值重复
+  iterator insert_equal(const value_type& v);
+  iterator insert_equal(iterator pos, const value_type& v) {
+    if (pos == end() && node_count != 0 &&
+        !key_compare(key(v), key(*--end()))) {
+      leaf_node* x = leaf(header->prev);
+      return _insert_leaf(x, x->count, v);
+    }
+    return insert_equal(v);
+  }
+  template <class InputIter>
+  void insert_equal(InputIter first, InputIter last) {
+    for (; first != last; ++first)
+      insert_equal(end(), *first);
+  }
+
+  template <class... Args>
+  iterator emplace_equal(Args&&... args) {
+    return insert_equal(value_type(std::forward<Args>(args)...));
+  }
+  // 删除pos所指元素，返回其后继
+  iterator erase(iterator pos);
+  size_type erase(const Key& k);
+  iterator erase(iterator first, iterator last);
+  // 删除pred(元素)为真的所有元素，返回删除的个数
+  template <class Predicate>
+  size_type erase_if(Predicate pred) {
+    size_type n = node_count;
+    for (iterator it = begin(); it != end();) {
+      if (pred(*it))
+        it = erase(it);
+      else
+        ++it;
+    }
+    return n - node_count;
+  }
+  void clear() {
+    if (root != 0) {
+      _clear(root);
+      root = 0;
+      header->prev = header;
+      header->next = header;
+      node_count = 0;
+    }
+  }
+
+  iterator find(const Key& k) { return _find(k); }
+  const_iterator find(const Key& k) const { return _find(k); }
+  size_type count(const Key& k) const { return _count(k); }
+  iterator lower_bound(const Key& k) { return _lower_bound(k); }
+  const_iterator lower_bound(const Key& k) const { return _lower_bound(k); }
+  iterator upper_bound(const Key& k) { return _upper_bound(k); }
+  const_iterator upper_bound(const Key& k) const { return _upper_bound(k); }
+  pair<iterator, iterator> equal_range(const Key& k) {
+    return pair<iterator, iterator>(_lower_bound(k), _upper_bound(k));
+  }
+  pair<const_iterator, const_iterator> equal_range(const Key& k) const {
+    return pair<const_iterator, const_iterator>(_lower_bound(k),
+                                                _upper_bound(k));
+  }
+
+  // 比较器定义了is_transparent时，可直接以能与Key比较的其他型别查找
+  template <class LK, class C = Compare, class = typename C::is_transparent>
+  iterator find(const LK& k) {
+    return _find(k);
+  }
+  template <class LK, class C = Compare, class = typename C::is_transparent>
+  const_iterator find(const LK& k) const {
+    return _find(k);
+  }
+  template <class LK, class C = Compare, class = typename C::is_transparent>
+  size_type count(const LK& k) const {
+    return _count(k);
+  }
+  template <class LK, class C = Compare, class = typename C::is_transparent>
+  iterator lower_bound(const LK& k) {
+    return _lower_bound(k);
+  }
+  template <class LK, class C = Compare, class = typename C::is_transparent>
+  const_iterator lower_bound(const LK& k) const {
+    return _lower_bound(k);
+  }
+  template <class LK, class C = Compare, class = typename C::is_transparent>
+  iterator upper_bound(const LK& k) {
+    return _upper_bound(k);
+  }
+  template <class LK, class C = Compare, class = typename C::is_transparent>
+  const_iterator upper_bound(const LK& k) const {
+    return _upper_bound(k);
+  }
+  template <class LK, class C = Compare, class = typename C::is_transparent>
+  pair<iterator, iterator> equal_range(const LK& k) {
+    return pair<iterator, iterator>(_lower_bound(k), _upper_bound(k));
+  }
+  template <class LK, class C = Compare, class = typename C::is_transparent>
+  pair<const_iterator, const_iterator> equal_range(const LK& k) const {
+    return pair<const_iterator, const_iterator>(_lower_bound(k),
+                                                _upper_bound(k));
+  }
+
+  friend bool operator==(const btree& x, const btree& y) {
+    return x.size() == y.size() && ministl::equal(x.begin(), x.end(), y.begin());
+  }
+  friend bool operator<(const btree& x, const btree& y) {
+    return ministl::lexicographical_compare(x.begin(), x.end(), y.begin(),
+                                            y.end());
+  }
+};
+
+template <class K, class V, class KoV, class C, class A, size_t NB>
+template <class LK>
+typename btree<K, V, KoV, C, A, NB>::size_type
+btree<K, V, KoV, C, A, NB>::leaf_lower(leaf_node* x, const LK& k) const {
+  const V* v = x->values();
+  size_type lo = 0, hi = x->count;
+  while (lo < hi) {
+    size_type mid = (lo + hi) / 2;
+    if (key_compare(key(v[mid]), k))
+      lo = mid + 1;
+    else
+      hi = mid;
+  }
+  return lo;
+}
+template <class K, class V, class KoV, class C, class A, size_t NB>
+template <class LK>
+typename btree<K, V, KoV, C, A, NB>::size_type
+btree<K, V, KoV, C, A, NB>::leaf_upper(leaf_node* x, const LK& k) const {
+  const V* v = x->values();
+  size_type lo = 0, hi = x->count;
+  while (lo < hi) {
+    size_type mid = (lo + hi) / 2;
+    if (key_compare(k, key(v[mid])))
+      hi = mid;
+    else
+      lo = mid + 1;
+  }
+  return lo;
+}
+template <class K, class V, class KoV, class C, class A, size_t NB>
+template <class LK>
+typename btree<K, V, KoV, C, A, NB>::size_type
+btree<K, V, KoV, C, A, NB>::inner_lower(inner_node* x, const LK& k) const {
+  const K* keys = x->keys();
+  size_type lo = 0, hi = x->count;
+  while (lo < hi) {
+    size_type mid = (lo + hi) / 2;
+    if (key_compare(keys[mid], k))
+      lo = mid + 1;
+    else
+      hi = mid;
+  }
+  return lo;
+}
+template <class K, class V, class KoV, class C, class A, size_t NB>
+template <class LK>
+typename btree<K, V, KoV, C, A, NB>::size_type
+btree<K, V, KoV, C, A, NB>::inner_upper(inner_node* x, const LK& k) const {
+  const K* keys = x->keys();
+  size_type lo = 0, hi = x->count;
+  while (lo < hi) {
+    size_type mid = (lo + hi) / 2;
+    if (key_compare(k, keys[mid]))
+      hi = mid;
+    else
+      lo = mid + 1;
+  }
+  return lo;
+}
+
+template <class K, class V, class KoV, class C, class A, size_t NB>
+pair<typename btree<K, V, KoV, C, A, NB>::iterator, bool>
+btree<K, V, KoV, C, A, NB>::insert_unique(const value_type& v) {
+  if (root == 0)
+    return pair<iterator, bool>(_insert_first(v), true);
+  size_type p;
+  leaf_node* x = lower_leaf(key(v), p);
+  // 等于k的元素可能是下一个叶节点的第一个元素
+  iterator j = make_iter(x, p);
+  if (j != end() && !key_compare(key(v), key(*j)))
+    return pair<iterator, bool>(j, false);
+  return pair<iterator, bool>(_insert_leaf(x, p, v), true);
+}
+
+template <class K, class V, class KoV, class C, class A, size_t NB>
+typename btree<K, V, KoV, C, A, NB>::iterator
+btree<K, V, KoV, C, A, NB>::insert_equal(const value_type& v) {
+  if (root == 0)
+    return _insert_first(v);
+  size_type p;
+  leaf_node* x = upper_leaf(key(v), p);
+  return _insert_leaf(x, p, v);
+}
+
+// 空树时建立根叶节点
+template <class K, class V, class KoV, class C, class A, size_t NB>
+typename btree<K, V, KoV, C, A, NB>::iterator
+btree<K, V, KoV, C, A, NB>::_insert_first(const value_type& v) {
+  leaf_node* x = get_leaf();
+  try {
+    construct(x->values(), v);
+  } catch (...) {
+    put_leaf(x);
+    throw;
+  }
+  x->count = 1;
+  link_after(header, x);
+  root = x;
+  node_count = 1;
+  return iterator(x, 0);
+}
+
+// 在叶节点x的位置p插入v，x已满时分裂
+template <class K, class V, class KoV, class C, class A, size_t NB>
+typename btree<K, V, KoV, C, A, NB>::iterator
+btree<K, V, KoV, C, A, NB>::_insert_leaf(leaf_node* x,
+                                         size_type p,
+                                         const value_type& v) {
+  if (x->count < leaf_slots) {
+    _btree_insert_value(x->values(), x->count, p, v);
+    ++x->count;
+    ++node_count;
+    return iterator(x, p);
+  }
+  // 先配置好分裂需要的所有节点：新叶节点，以及沿途每个已满的祖先各一个
+  inner_node* spare[64];
+  size_type need = 0;
+  base_ptr q = x->parent;
+  while (q != 0 && q->count == inner_slots) {
+    ++need;
+    q = q->parent;
+  }
+  if (q == 0)
+    ++need;  // 根节点也要分裂
+  leaf_node* y = get_leaf();
+  size_type got = 0;
+  try {
+    for (; got < need; ++got)
+      spare[got] = get_inner();
+  } catch (...) {
+    while (got > 0)
+      put_inner(spare[--got]);
+    put_leaf(y);
+    throw;
+  }
+
+  V* a = x->values();
+  V* b = y->values();
+  const bool append = p == leaf_slots && x->next == header;
+  const size_type mid = leaf_slots / 2;
+  inner_node** s = spare;
+  try {
+    // 先复制一份分隔键，之后沿途只搬动键，可能失败的复制都发生在改动树之前
+    K sep(key(append ? v : a[mid]));
+    if (append) {
+      // 在最右叶节点末尾追加：不搬动元素，新叶节点只放v，顺序插入得到满的叶节点
+      construct(b, v);
+      y->count = 1;
+      ++node_count;
+    } else {
+      for (size_type i = mid; i < leaf_slots; ++i)
+        _btree_relocate(b + i - mid, a + i);
+      y->count = (unsigned short)(leaf_slots - mid);
+      x->count = (unsigned short)mid;
+    }
+    link_after(x, y);
+    _insert_parent(x, sep, y, s);
+  } catch (...) {
+    for (size_type i = 0; i < need; ++i)
+      put_inner(spare[i]);
+    put_leaf(y);
+    throw;
+  }
+  if (append)
+    return iterator(y, 0);
+  // 两半都不满，再插入v
+  if (p <= x->count)
+    return _insert_leaf(x, p, v);
+  return _insert_leaf(y, p - x->count, v);
+}
+
+// x分裂出了右侧的兄弟y，以k为分隔键将y插入x的父节点，k被搬走
+template <class K, class V, class KoV, class C, class A, size_t NB>
+void btree<K, V, KoV, C, A, NB>::_insert_parent(base_ptr x,
+                                                K& k,
+                                                base_ptr y,
+                                                inner_node**& spare) {
+  if (x->parent == 0) {  // x为根，树长高一层
+    inner_node* r = *spare++;
+    ::new ((void*)r->keys()) K(std::move(k));
+    r->count = 1;
+    set_child(r, 0, x);
+    set_child(r, 1, y);
+    root = r;
+    return;
+  }
+  inner_node* p = inner(x->parent);
+  const size_type i = x->position;
+  if (p->count < inner_slots) {
+    _insert_child(p, i, k, y);
+    return;
+  }
+  // p已满，分裂出q，两半都不少于inner_min个键
+  const size_type m = inner_slots;
+  const size_type h = m / 2;
+  inner_node* q = *spare++;
+  K* pk = p->keys();
+  K* qk = q->keys();
+  if (i == h) {  // k恰好位于中间，直接上移
+    for (size_type j = h; j < m; ++j)
+      _btree_relocate(qk + j - h, pk + j);
+    set_child(q, 0, y);
+    for (size_type j = h + 1; j <= m; ++j)
+      set_child(q, j - h, p->children[j]);
+    p->count = (unsigned short)h;
+    q->count = (unsigned short)(m - h);
+    _insert_parent(p, k, q, spare);
+    return;
+  }
+  // i在左半时多留一个键给右半，插入后两半相当
+  const size_type mid = i < h ? (m - 1) / 2 : h;
+  for (size_type j = mid + 1; j < m; ++j)
+    _btree_relocate(qk + j - mid - 1, pk + j);
+  for (size_type j = mid + 1; j <= m; ++j)
+    set_child(q, j - mid - 1, p->children[j]);
+  p->count = (unsigned short)mid;
+  q->count = (unsigned short)(m - mid - 1);
+  K up(std::move(pk[mid]));  // pk[mid]上移到父节点
+  destroy(pk + mid);
+  if (i < h)
+    _insert_child(p, i, k, y);
+  else
+    _insert_child(q, i - mid - 1, k, y);
+  _insert_parent(p, up, q, spare);
+}
+
+// 在未满的内部节点p中，于第i个子节点之后插入分隔键k与子节点y，k被搬走
+template <class K, class V, class KoV, class C, class A, size_t NB>
+void btree<K, V, KoV, C, A, NB>::_insert_child(inner_node* p,
+                                               size_type i,
+                                               K& k,
+                                               base_ptr y) {
+  K* pk = p->keys();
+  for (size_type j = p->count; j > i; --j)
+    _btree_relocate(pk + j, pk + j - 1);
+  ::new ((void*)(pk + i)) K(std::move(k));
+  for (size_type j = p->count + 1; j > i + 1; --j)
+    set_child(p, j, p->children[j - 1]);
+  set_child(p, i + 1, y);
+  ++p->count;
+}
+
+// 删除内部节点p的第i个键与第i+1个子节点
+template <class K, class V, class KoV, class C, class A, size_t NB>
+void btree<K, V, KoV, C, A, NB>::_remove_child(inner_node* p, size_type i) {
+  _btree_erase_value(p->keys(), p->count, i);
+  for (size_type j = i + 1; j < p->count; ++j)
+    set_child(p, j, p->children[j + 1]);
+  --p->count;
+}
+
+template <class K, class V, class KoV, class C, class A, size_t NB>
+typename btree<K, V, KoV, C, A, NB>::iterator
+btree<K, V, KoV, C, A, NB>::erase(iterator pos) {
+  leaf_node* x = leaf(pos.node);
+  size_type p = pos.pos;
+  _btree_erase_value(x->values(), x->count, p);
+  --x->count;
+  --node_count;
+  _rebalance_leaf(x, p);  // x与p随元素的搬动一起调整，仍指向原来的后继
+  return make_iter(x, p);
+}
+
+template <class K, class V, class KoV, class C, class A, size_t NB>
+typename btree<K, V, KoV, C, A, NB>::size_type
+btree<K, V, KoV, C, A, NB>::erase(const K& k) {
+  iterator first = lower_bound(k);
+  size_type n = 0;
+  while (first != end() && !key_compare(k, key(*first))) {
+    first = erase(first);
+    ++n;
+  }
+  return n;
+}
+
+template <class K, class V, class KoV, class C, class A, size_t NB>
+typename btree<K, V, KoV, C, A, NB>::iterator
+btree<K, V, KoV, C, A, NB>::erase(iterator first, iterator last) {
+  if (first == begin() && last == end()) {
+    clear();
+    return end();
+  }
+  // 删除会搬动元素使last失效，先逐叶计数
+  size_type n = last.pos - first.pos;
+  for (leaf_base_ptr x = first.node; x != last.node; x = x->next)
+    n += x->count;
+  node_count -= n;
+  // 每次删去一个叶节点中连续的一段
+  while (n > 0) {
+    leaf_node* x = leaf(first.node);
+    size_type p = first.pos;
+    const size_type c = x->count - p < n ? x->count - p : n;
+    n -= c;
+    if (c == x->count && x != root) {  // 整个叶节点都删除，直接摘除
+      first = iterator(x->next, 0);
+      _erase_leaf(x);
+      continue;
+    }
+    V* v = x->values();
+    for (size_type j = p; j < p + c; ++j)
+      destroy(v + j);
+    for (size_type j = p + c; j < x->count; ++j)
+      _btree_relocate(v + j - c, v + j);
+    x->count = (unsigned short)(x->count - c);
+    // 一次可能少了多个元素，反复向兄弟借直至不少于leaf_min
+    do
+      _rebalance_leaf(x, p);
+    while (x != header && x != root && x->count < leaf_min);
+    first = make_iter(x, p);
+  }
+  return first;
+}
+
+// 销毁叶节点x的全部元素，将其从叶链表与父节点中摘除，x不为根
+template <class K, class V, class KoV, class C, class A, size_t NB>
+void btree<K, V, KoV, C, A, NB>::_erase_leaf(leaf_node* x) {
+  ministl::destroy(x->values(), x->values() + x->count);
+  inner_node* parent = inner(x->parent);
+  const size_type i = x->position;
+  unlink(x);
+  put_leaf(x);
+  if (i > 0) {
+    _remove_child(parent, i - 1);
+  } else {  // 删除第一个子节点，连同第一个分隔键
+    _btree_erase_value(parent->keys(), parent->count, 0);
+    for (size_type j = 0; j < parent->count; ++j)
+      set_child(parent, j, parent->children[j + 1]);
+    --parent->count;
+  }
+  _rebalance_inner(parent);
+}
+
+// 叶节点x的元素过少时向兄弟借一个，借不到则与兄弟合并
+// p为x中的一个位置，随元素一起搬动
+template <class K, class V, class KoV, class C, class A, size_t NB>
+void btree<K, V, KoV, C, A, NB>::_rebalance_leaf(leaf_node*& x,
+                                                 size_type& p) {
+  if (x == root) {
+    if (x->count == 0) {
+      unlink(x);
+      put_leaf(x);
+      root = 0;
+      x = static_cast<leaf_node*>(header);
+      p = 0;
+    }
+    return;
+  }
+  if (x->count >= leaf_min)
+    return;
+  inner_node* parent = inner(x->parent);
+  const size_type i = x->position;
+  leaf_node* l = i > 0 ? leaf(parent->children[i - 1]) : 0;
+  leaf_node* r = i < parent->count ? leaf(parent->children[i + 1]) : 0;
+  V* xv = x->values();
+  if (l != 0 && l->count > leaf_min) {  // 取左兄弟的最后一个元素
+    for (size_type j = x->count; j > 0; --j)
+      _btree_relocate(xv + j, xv + j - 1);
+    _btree_relocate(xv, l->values() + l->count - 1);
+    --l->count;
+    ++x->count;
+    ++p;
+    parent->keys()[i - 1] = key(xv[0]);
+    return;
+  }
+  if (r != 0 && r->count > leaf_min) {  // 取右兄弟的第一个元素
+    V* rv = r->values();
+    _btree_relocate(xv + x->count, rv);
+    for (size_type j = 1; j < r->count; ++j)
+      _btree_relocate(rv + j - 1, rv + j);
+    ++x->count;
+    --r->count;
+    parent->keys()[i] = key(rv[0]);
+    return;
+  }
+  leaf_node* dst = l != 0 ? l : x;  // 总是将右边的并入左边
+  leaf_node* src = l != 0 ? x : r;
+  V* dv = dst->values();
+  V* sv = src->values();
+  if (src == x) {
+    p += dst->count;
+    x = dst;
+  }
+  for (size_type j = 0; j < src->count; ++j)
+    _btree_relocate(dv + dst->count + j, sv + j);
+  dst->count += src->count;
+  unlink(src);
+  _remove_child(parent, src->position - 1);
+  put_leaf(src);
+  _rebalance_inner(parent);
+}
+
+// 内部节点x的键过少时经由父节点向兄弟借一个，借不到则与兄弟合并
+template <class K, class V, class KoV, class C, class A, size_t NB>
+void btree<K, V, KoV, C, A, NB>::_rebalance_inner(inner_node* x) {
+  if (x == root) {
+    if (x->count == 0) {  // 根只剩一个子节点，树降低一层
+      root = x->children[0];
+      root->parent = 0;
+      root->position = 0;
+      put_inner(x);
+    }
+    return;
+  }
+  if (x->count >= inner_min)
+    return;
+  inner_node* parent = inner(x->parent);
+  const size_type i = x->position;
+  inner_node* l = i > 0 ? inner(parent->children[i - 1]) : 0;
+  inner_node* r = i < parent->count ? inner(parent->children[i + 1]) : 0;
+  K* xk = x->keys();
+  K* pk = parent->keys();
+  if (l != 0 && l->count > inner_min) {  // 父节点的分隔键下移，l的最后一个键上移
+    _btree_insert_value(xk, x->count, 0, pk[i - 1]);
+    for (size_type j = x->count + 1; j > 0; --j)
+      set_child(x, j, x->children[j - 1]);
+    set_child(x, 0, l->children[l->count]);
+    ++x->count;
+    pk[i - 1] = l->keys()[l->count - 1];
+    destroy(l->keys() + l->count - 1);
+    --l->count;
+    return;
+  }
+  if (r != 0 && r->count > inner_min) {  // 父节点的分隔键下移，r的第一个键上移
+    construct(xk + x->count, pk[i]);
+    set_child(x, x->count + 1, r->children[0]);
+    ++x->count;
+    pk[i] = r->keys()[0];
+    _btree_erase_value(r->keys(), r->count, 0);
+    for (size_type j = 0; j < r->count; ++j)
+      set_child(r, j, r->children[j + 1]);
+    --r->count;
+    return;
+  }
+  inner_node* dst = l != 0 ? l : x;
+  inner_node* src = l != 0 ? x : r;
+  K* dk = dst->keys();
+  K* sk = src->keys();
+  const size_type k = src->position - 1;  // 两者之间的分隔键
+  construct(dk + dst->count, pk[k]);
+  for (size_type j = 0; j < src->count; ++j)
+    _btree_relocate(dk + dst->count + 1 + j, sk + j);
+  for (size_type j = 0; j <= src->count; ++j)
+    set_child(dst, dst->count + 1 + j, src->children[j]);
+  dst->count += src->count + 1;
+  _remove_child(parent, k);
+  put_inner(src);
+  _rebalance_inner(parent);
+}
+
+template <class K, class V, class KoV, class C, class A, size_t NB>
+void btree<K, V, KoV, C, A, NB>::_clear(base_ptr x) {
+  if (x->leaf) {
+    ministl::destroy(leaf(x)->values(), leaf(x)->values() + x->count);
+    put_leaf(leaf(x));
+    return;
+  }
+  inner_node* y = inner(x);
+  for (size_type i = 0; i <= y->count; ++i) {
+    if (i < y->count)
+      MINISTL_PREFETCH(y->children[i + 1]);
+    _clear(y->children[i]);
+  }
+  ministl::destroy(y->keys(), y->keys() + y->count);
+  put_inner(y);
+}
+
+// 复制以x为根的子树，p为新的父节点，复制出的叶节点依次接在tail之后
+template <class K, class V, class KoV, class C, class A, size_t NB>
+typename btree<K, V, KoV, C, A, NB>::base_ptr
+btree<K, V, KoV, C, A, NB>::_copy(base_ptr x,
+                                  inner_node* p,
+                                  leaf_base_ptr& tail) {
+  if (x->leaf) {
+    leaf_node* y = get_leaf();
+    V* xv = leaf(x)->values();
+    V* yv = y->values();
+    try {
+      for (; y->count < x->count; ++y->count)
+        construct(yv + y->count, xv[y->count]);
+    } catch (...) {
+      ministl::destroy(yv, yv + y->count);
+      put_leaf(y);
+      throw;
+    }
+    y->parent = p;
+    y->position = x->position;
+    y->prev = tail;
+    tail->next = y;
+    tail = y;
+    return y;
+  }
+  inner_node* src = inner(x);
+  inner_node* y = get_inner();
+  size_type n = 0;  // 已复制的子节点数
+  try {
+    for (; y->count < src->count; ++y->count)
+      construct(y->keys() + y->count, src->keys()[y->count]);
+    for (; n <= src->count; ++n) {
+      MINISTL_PREFETCH(src->children[n]);
+      y->children[n] = _copy(src->children[n], y, tail);
+    }
+  } catch (...) {
+    for (size_type i = 0; i < n; ++i)
+      _clear(y->children[i]);
+    ministl::destroy(y->keys(), y->keys() + y->count);
+    put_inner(y);
+    throw;
+  }
+  y->parent = p;
+  y->position = x->position;
+  return y;
+}
+
+// 空树时由严格递增的[first,last)建树：依次装满叶节点，最后两个叶节点平分，
+// 再自底向上每层把子节点尽量平均地分给最少个数的内部节点
+// 同一层中尚未挂到父节点的节点以parent串起；中途抛出异常时已建的部分全部释放
+template <class K, class V, class KoV, class C, class A, size_t NB>
+template <class InputIter>
+void btree<K, V, KoV, C, A, NB>::_assign_sorted(InputIter first,
+                                                InputIter last) {
+  size_type c = 0;  // 当前层的节点数
+  base_ptr level = 0, head = 0;
+  try {
+    leaf_node* x = 0;
+    for (; first != last; ++first) {
+      if (x == 0 || x->count == leaf_slots) {
+        x = get_leaf();
+        link_after(header->prev, x);
+        ++c;
+      }
+      construct(x->values() + x->count, *first);
+      ++x->count;
+      ++node_count;
+    }
+    if (c == 0)
+      return;
+    if (c > 1 && x->count < leaf_min) {
+      leaf_node* l = leaf(x->prev);
+      const size_type keep = (l->count + x->count) / 2;
+      const size_type m = l->count - keep;
+      V* xv = x->values();
+      for (size_type j = x->count; j > 0; --j)
+        _btree_relocate(xv + j - 1 + m, xv + j - 1);
+      for (size_type j = 0; j < m; ++j)
+        _btree_relocate(xv + j, l->values() + keep + j);
+      l->count = (unsigned short)keep;
+      x->count = (unsigned short)(x->count + m);
+    }
+    for (leaf_base_ptr y = header->next; y != header; y = y->next)
+      y->parent = y->next == header ? 0 : y->next;
+    level = header->next;
+    while (c > 1) {
+      const size_type np = (c + inner_slots) / (inner_slots + 1);
+      const size_type per = c / np, extra = c % np;
+      base_ptr tail = 0;
+      head = 0;
+      for (size_type i = 0; i < np; ++i) {
+        inner_node* p = get_inner();
+        if (tail != 0)
+          tail->parent = p;
+        else
+          head = p;
+        tail = p;
+        // 先挂第一个子节点，再逐个构造分隔键并挂上对应的子节点，p始终可被_clear
+        const size_type k = per + (i < extra ? 1 : 0);
+        base_ptr next = level->parent;
+        set_child(p, 0, level);
+        level = next;
+        for (size_type j = 1; j < k; ++j) {
+          next = level->parent;
+          construct(p->keys() + j - 1, _min_key(level));
+          ++p->count;
+          set_child(p, j, level);
+          level = next;
+        }
+        p->parent = 0;
+      }
+      level = head;
+      head = 0;
+      c = np;
+    }
+  } catch (...) {
+    if (level == 0) {  // 还在建叶节点，沿叶链表释放
+      for (leaf_base_ptr y = header->next; y != header;) {
+        leaf_base_ptr next = y->next;
+        _clear(y);
+        y = next;
+      }
+    } else {
+      for (base_ptr q = head; q != 0;) {
+        base_ptr next = q->parent;
+        _clear(q);
+        q = next;
+      }
+      for (base_ptr q = level; q != 0;) {
+        base_ptr next = q->parent;
+        _clear(q);
+        q = next;
+      }
+    }
+    header->prev = header;
+    header->next = header;
+    node_count = 0;
+    throw;
+  }
+  root = level;
+  root->parent = 0;
+  root->position = 0;
+}
+
+_MINISTL_END
+
+#endif
@@ -0,0 +1,411 @@
+#ifndef MINISTL_BTREE_MAP_H
+#define MINISTL_BTREE_MAP_H
+
+#include "../configurator/allocator.hpp"
+#include "../functor/functor.hpp"
+#include "../utils/util.hpp"
+#include "btree.hpp"
+
+_MINISTL_BEGIN
+
+// 以B+树为底层的map，接口与map相同
+// 插入与删除会搬动叶节点内的元素，除被删除的元素外，迭代器也会失效
+template <class Key,
+          class T,
+          class Compare = std::less<Key>,
+          class Alloc = alloc>
+class btree_map {
+ public:
+  typedef Key key_type;
+  typedef T data_type;
+  typedef T mapped_type;
+  typedef pair<Key, T> value_type;
+  typedef Compare key_compare;
+  class value_compare : public binary_function<value_type, value_type, bool> {
+    friend class btree_map<Key, T, Compare, Alloc>;
+
+   protected:
+    Compare comp;
+    value_compare(Compare c) : comp(c) {}
+
+   public:
+    bool operator()(const value_type& x, const value_type& y) const {
+      return comp(x.first, y.first);
+    }
+  };
+
+ private:
+  typedef btree<key_type, value_type, select1st<value_type>, key_compare, Alloc>
+      rep_type;
+  rep_type t;
+
+ public:
+  typedef typename rep_type::pointer pointer;
+  typedef typename rep_type::const_pointer const_pointer;
+  typedef typename rep_type::reference reference;
+  typedef typename rep_type::const_reference const_reference;
+  typedef typename rep_type::iterator iterator;
+  typedef typename rep_type::const_iterator const_iterator;
+  typedef typename rep_type::reverse_iterator reverse_iterator;
+  typedef typename rep_type::const_reverse_iterator const_reverse_iterator;
+  typedef typename rep_type::size_type size_type;
+  typedef typename rep_type::difference_type difference_type;
+
+  btree_map() : t(Compare()) {}
+  explicit btree_map(const Compare& comp) : t(comp) {}
+  template <class InputIter>
+  btree_map(InputIter first, InputIter last) : t(Compare()) {
+    t.insert_unique(first, last);
+  }
+  template <class InputIter>
+  btree_map(InputIter first, InputIter last, const Compare& comp) : t(comp) {
+    t.insert_unique(first, last);
+  }
+  // 由调用者保证[first,last)严格递增，自底向上直接建树，O(n)
+  template <class InputIter>
+  btree_map(sorted_unique_t, InputIter first, InputIter last) : t(Compare()) {
+    t.insert_unique(sorted_unique, first, last);
+  }
+  template <class InputIter>
+  btree_map(sorted_unique_t,
+            InputIter first,
+            InputIter last,
+            const Compare& comp)
+      : t(comp) {
+    t.insert_unique(sorted_unique, first, last);
+  }
+  btree_map(const btree_map& x) : t(x.t) {}
+  // 移动与swap都只交换指针，O(1)
+  btree_map(btree_map&& x) : t(std::move(x.t)) {}
+  btree_map& operator=(const btree_map& x) {
+    t = x.t;
+    return *this;
+  }
+  btree_map& operator=(btree_map&& x) {
+    t = std::move(x.t);
+    return *this;
+  }
+
+  key_compare key_comp() const { return t.key_comp(); }
+  value_compare value_comp() const { return value_compare(t.key_comp()); }
+  iterator begin() { return t.begin(); }
+  const_iterator begin() const { return t.begin(); }
+  iterator end() { return t.end(); }
+  const_iterator end() const { return t.end(); }
+  reverse_iterator rbegin() { return t.rbegin(); }
+  reverse_iterator rend() { return t.rend(); }
+  const_reverse_iterator rbegin() const { return t.rbegin(); }
+  const_reverse_iterator rend() const { return t.rend(); }
+  const_iterator cbegin() const { return begin(); }
+  const_iterator cend() const { return end(); }
+  const_reverse_iterator crbegin() const { return rbegin(); }
+  const_reverse_iterator crend() const { return rend(); }
+
+  bool empty() const { return t.empty(); }
+  size_type size() const { return t.size(); }
+  size_type max_size() const { return t.max_size(); }
+
+  // 先查找，只在k不存在时才构造元素
+  T& operator[](const key_type& k) {
+    return (*t.try_emplace_unique(k, _emplace_second, k).first).second;
+  }
+  void swap(btree_map& x) { t.swap(x.t); }
+  // 插入
+  pair<iterator, bool> insert(const value_type& x) {
+    return t.insert_unique(x);
+  }
+  iterator insert(iterator pos, const value_type& x) {
+    return t.insert_unique(pos, x);
+  }
+  template <class InputIter>
+  void insert(InputIter first, InputIter last) {
+    t.insert_unique(first, last);
+  }
+  // 由调用者保证[first,last)严格递增，空容器时直接建树
+  template <class InputIter>
+  void insert(sorted_unique_t, InputIter first, InputIter last) {
+    t.insert_unique(sorted_unique, first, last);
+  }
+  // 以args构造元素后插入，键值已存在时构造出的元素被丢弃
+  template <class... Args>
+  pair<iterator, bool> emplace(Args&&... args) {
+    return t.emplace_unique(std::forward<Args>(args)...);
+  }
+  template <class... Args>
+  iterator emplace_hint(iterator, Args&&... args) {
+    return t.emplace_unique(std::forward<Args>(args)...).first;
+  }
+  // k不存在时以k与args构造元素，k已存在时什么也不做，args不会被移动
+  template <class... Args>
+  pair<iterator, bool> try_emplace(const key_type& k, Args&&... args) {
+    return t.try_emplace_unique(k, _emplace_second, k,
+                                std::forward<Args>(args)...);
+  }
+  template <class... Args>
+  iterator try_emplace(iterator, const key_type& k, Args&&... args) {
+    return try_emplace(k, std::forward<Args>(args)...).first;
+  }
+  // k不存在时插入(k, obj)，否则将obj赋值给已有元素
+  template <class M>
+  pair<iterator, bool> insert_or_assign(const key_type& k, M&& obj) {
+    pair<iterator, bool> r =
+        t.try_emplace_unique(k, _emplace_second, k, std::forward<M>(obj));
+    if (!r.second)
+      (*r.first).second = std::forward<M>(obj);
+    return r;
+  }
+  template <class M>
+  iterator insert_or_assign(iterator, const key_type& k, M&& obj) {
+    return insert_or_assign(k, std::forward<M>(obj)).first;
+  }
+  // 删除，返回被删元素的后继
+  iterator erase(iterator pos) { return t.erase(pos); }
+  size_type erase(const key_type& x) { return t.erase(x); }
+  iterator erase(iterator first, iterator last) { return t.erase(first, last); }
+  void clear() { t.clear(); }
+  // 操作
+  iterator find(const key_type& x) { return t.find(x); }
+  const_iterator find(const key_type& x) const { return t.find(x); }
+  size_type count(const key_type& x) const { return t.count(x); }
+  iterator lower_bound(const key_type& x) { return t.lower_bound(x); }
+  const_iterator lower_bound(const key_type& x) const {
+    return t.lower_bound(x);
+  }
+  iterator upper_bound(const key_type& x) { return t.upper_bound(x); }
+  const_iterator upper_bound(const key_type& x) const {
+    return t.upper_bound(x);
+  }
+  pair<iterator, iterator> equal_range(const key_type& x) {
+    return t.equal_range(x);
+  }
+  pair<const_iterator, const_iterator> equal_range(const key_type& x) const {
+    return t.equal_range(x);
+  }
+  // 比较器定义了is_transparent时，可以不构造key_type直接查找
+  template <class K, class C = Compare, class = typename C::is_transparent>
+  iterator find(const K& x) {
+    return t.find(x);
+  }
+  template <class K, class C = Compare, class = typename C::is_transparent>
+  const_iterator find(const K& x) const {
+    return t.find(x);
+  }
+  template <class K, class C = Compare, class = typename C::is_transparent>
+  size_type count(const K& x) const {
+    return t.count(x);
+  }
+  template <class K, class C = Compare, class = typename C::is_transparent>
+  iterator lower_bound(const K& x) {
+    return t.lower_bound(x);
+  }
+  template <class K, class C = Compare, class = typename C::is_transparent>
+  const_iterator lower_bound(const K& x) const {
+    return t.lower_bound(x);
+  }
+  template <class K, class C = Compare, class = typename C::is_transparent>
+  iterator upper_bound(const K& x) {
+    return t.upper_bound(x);
+  }
+  template <class K, class C = Compare, class = typename C::is_transparent>
+  const_iterator upper_bound(const K& x) const {
+    return t.upper_bound(x);
+  }
+  template <class K, class C = Compare, class = typename C::is_transparent>
+  pair<iterator, iterator> equal_range(const K& x) {
+    return t.equal_range(x);
+  }
+  template <class K, class C = Compare, class = typename C::is_transparent>
+  pair<const_iterator, const_iterator> equal_range(const K& x) const {
+    return t.equal_range(x);
+  }
+  friend bool operator==(const btree_map& x, const btree_map& y) {
+    return x.t == y.t;
+  }
+  friend bool operator<(const btree_map& x, const btree_map& y) {
+    return x.t < y.t;
+  }
+  // 删除pred为真的所有元素，O(n)
+  template <class Predicate>
+  friend size_type erase_if(btree_map& c, Predicate pred) {
+    return c.t.erase_if(pred);
+  }
+};
+
+// 允许键值重复的btree_map
+template <class Key,
+          class T,
+          class Compare = std::less<Key>,
+          class Alloc = alloc>
+class btree_multimap {
+ public:
+  typedef Key key_type;
+  typedef T data_type;
+  typedef T mapped_type;
+  typedef pair<Key, T> value_type;
+  typedef Compare key_compare;
+  class value_compare : public binary_function<value_type, value_type, bool> {
+    friend class btree_multimap<Key, T, Compare, Alloc>;
+
+   protected:
+    Compare comp;
+    value_compare(Compare c) : comp(c) {}
+
+   public:
+    bool operator()(const value_type& x, const value_type& y) const {
+      return comp(x.first, y.first);
+    }
+  };
+
+ private:
+  typedef btree<key_type, value_type, select1st<value_type>, key_compare, Alloc>
+      rep_type;
+  rep_type t;
+
+ public:
+  typedef typename rep_type::pointer pointer;
+  typedef typename rep_type::const_pointer const_pointer;
+  typedef typename rep_type::reference reference;
+  typedef typename rep_type::const_reference const_reference;
+  typedef typename rep_type::iterator iterator;
+  typedef typename rep_type::const_iterator const_iterator;
+  typedef typename rep_type::reverse_iterator reverse_iterator;
+  typedef typename rep_type::const_reverse_iterator const_reverse_iterator;
+  typedef typename rep_type::size_type size_type;
+  typedef typename rep_type::difference_type difference_type;
+
+  btree_multimap() : t(Compare()) {}
+  explicit btree_multimap(const Compare& comp) : t(comp) {}
+  template <class InputIter>
+  btree_multimap(InputIter first, InputIter last) : t(Compare()) {
+    t.insert_equal(first, last);
+  }
+  template <class InputIter>
+  btree_multimap(InputIter first, InputIter last, const Compare& comp)
+      : t(comp) {
+    t.insert_equal(first, last);
+  }
+  btree_multimap(const btree_multimap& x) : t(x.t) {}
+  // 移动与swap都只交换指针，O(1)
+  btree_multimap(btree_multimap&& x) : t(std::move(x.t)) {}
+  btree_multimap& operator=(const btree_multimap& x) {
+    t = x.t;
+    return *this;
+  }
+  btree_multimap& operator=(btree_multimap&& x) {
+    t = std::move(x.t);
+    return *this;
+  }
+
+  key_compare key_comp() const { return t.key_comp(); }
+  value_compare value_comp() const { return value_compare(t.key_comp()); }
+  iterator begin() { return t.begin(); }
+  const_iterator begin() const { return t.begin(); }
+  iterator end() { return t.end(); }
+  const_iterator end() const { return t.end(); }
+  reverse_iterator rbegin() { return t.rbegin(); }
+  reverse_iterator rend() { return t.rend(); }
+  const_reverse_iterator rbegin() const { return t.rbegin(); }
+  const_reverse_iterator rend() const { return t.rend(); }
+  const_iterator cbegin() const { return begin(); }
+  const_iterator cend() const { return end(); }
+  const_reverse_iterator crbegin() const { return rbegin(); }
+  const_reverse_iterator crend() const { return rend(); }
+
+  bool empty() const { return t.empty(); }
+  size_type size() const { return t.size(); }
+  size_type max_size() const { return t.max_size(); }
+  void swap(btree_multimap& x) { t.swap(x.t); }
+  // 插入，等价的键值插在已有元素之后
+  iterator insert(const value_type& x) { return t.insert_equal(x); }
+  iterator insert(iterator pos, const value_type& x) {
+    return t.insert_equal(pos, x);
+  }
+  template <class InputIter>
+  void insert(InputIter first, InputIter last) {
+    t.insert_equal(first, last);
+  }
+  // 以args构造元素后插入
+  template <class... Args>
+  iterator emplace(Args&&... args) {
+    return t.emplace_equal(std::forward<Args>(args)...);
+  }
+  template <class... Args>
+  iterator emplace_hint(iterator, Args&&... args) {
+    return t.emplace_equal(std::forward<Args>(args)...);
+  }
+  // 删除
+  iterator erase(iterator pos) { return t.erase(pos); }
+  size_type erase(const key_type& x) { return t.erase(x); }
+  iterator erase(iterator first, iterator last) { return t.erase(first, last); }
+  void clear() { t.clear(); }
+  // 操作
+  iterator find(const key_type& x) { return t.find(x); }
+  const_iterator find(const key_type& x) const { return t.find(x); }
+  size_type count(const key_type& x) const { return t.count(x); }
+  iterator lower_bound(const key_type& x) { return t.lower_bound(x); }
+  const_iterator lower_bound(const key_type& x) const {
+    return t.lower_bound(x);
+  }
+  iterator upper_bound(const key_type& x) { return t.upper_bound(x); }
+  const_iterator upper_bound(const key_type& x) const {
+    return t.upper_bound(x);
+  }
+  pair<iterator, iterator> equal_range(const key_type& x) {
+    return t.equal_range(x);
+  }
+  pair<const_iterator, const_iterator> equal_range(const key_type& x) const {
+    return t.equal_range(x);
+  }
+  // 比较器定义了is_transparent时，可以不构造key_type直接查找
+  template <class K, class C = Compare, class = typename C::is_transparent>
+  iterator find(const K& x) {
+    return t.find(x);
+  }
+  template <class K, class C = Compare, class = typename C::is_transparent>
+  const_iterator find(const K& x) const {
+    return t.find(x);
+  }
+  template <class K, class C = Compare, class = typename C::is_transparent>
+  size_type count(const K& x) const {
+    return t.count(x);
+  }
+  template <class K, class C = Compare, class = typename C::is_transparent>
+  iterator lower_bound(const K& x) {
+    return t.lower_bound(x);
+  }
+  template <class K, class C = Compare, class = typename C::is_transparent>
+  const_iterator lower_bound(const K& x) const {
+    return t.lower_bound(x);
+  }
+  template <class K, class C = Compare, class = typename C::is_transparent>
+  iterator upper_bound(const K& x) {
+    return t.upper_bound(x);
+  }
+  template <class K, class C = Compare, class = typename C::is_transparent>
+  const_iterator upper_bound(const K& x) const {
+    return t.upper_bound(x);
+  }
+  template <class K, class C = Compare, class = typename C::is_transparent>
+  pair<iterator, iterator> equal_range(const K& x) {
+    return t.equal_range(x);
+  }
+  template <class K, class C = Compare, class = typename C::is_transparent>
+  pair<const_iterator, const_iterator> equal_range(const K& x) const {
+    return t.equal_range(x);
+  }
+  friend bool operator==(const btree_multimap& x, const btree_multimap& y) {
+    return x.t == y.t;
+  }
+  friend bool operator<(const btree_multimap& x, const btree_multimap& y) {
+    return x.t < y.t;
+  }
+  // 删除pred为真的所有元素，O(n)
+  template <class Predicate>
+  friend size_type erase_if(btree_multimap& c, Predicate pred) {
+    return c.t.erase_if(pred);
+  }
+};
+
+_MINISTL_END
+
+#endif
@@ -0,0 +1,302 @@
+#ifndef MINISTL_BTREE_SET_H
+#define MINISTL_BTREE_SET_H
+
+#include "../configurator/allocator.hpp"
+#include "../functor/functor.hpp"
+#include "../iterator/iterator.hpp"
+#include "../utils/util.hpp"
+#include "btree.hpp"
+
+_MINISTL_BEGIN
+
+// 以B+树为底层的set，接口与set相同
+// 插入与删除会搬动叶节点内的元素，除被删除的元素外，迭代器也会失效
+template <class Key, class Compare = std::less<Key>, class Alloc = alloc>
+class btree_set {
+ public:
+  typedef Key key_type;
+  typedef Key value_type;
+  typedef Compare key_compare;
+  typedef Compare value_compare;
+
+ private:
+  typedef btree<key_type, value_type, identity<value_type>, key_compare, Alloc>
+      rep_type;
+  typedef typename rep_type::iterator rep_iterator;
+  rep_type t;
+
+ public:
+  typedef typename rep_type::const_pointer pointer;
+  typedef typename rep_type::const_pointer const_pointer;
+  typedef typename rep_type::const_reference reference;
+  typedef typename rep_type::const_reference const_reference;
+  typedef typename rep_type::const_iterator iterator;
+  typedef typename rep_type::const_iterator const_iterator;
+  typedef typename rep_type::const_reverse_iterator reverse_iterator;
+  typedef typename rep_type::const_reverse_iterator const_reverse_iterator;
+  typedef typename rep_type::size_type size_type;
+  typedef typename rep_type::difference_type difference_type;
+
+  btree_set() : t(Compare()) {}
+  explicit btree_set(const Compare& comp) : t(comp) {}
+  template <class InputIter>
+  btree_set(InputIter first, InputIter last) : t(Compare()) {
+    t.insert_unique(first, last);
+  }
+  template <class InputIter>
+  btree_set(InputIter first, InputIter last, const Compare& comp) : t(comp) {
+    t.insert_unique(first, last);
+  }
+  // 由调用者保证[first,last)严格递增，自底向上直接建树，O(n)
+  template <class InputIter>
+  btree_set(sorted_unique_t, InputIter first, InputIter last) : t(Compare()) {
+    t.insert_unique(sorted_unique, first, last);
+  }
+  template <class InputIter>
+  btree_set(sorted_unique_t,
+            InputIter first,
+            InputIter last,
+            const Compare& comp)
+      : t(comp) {
+    t.insert_unique(sorted_unique, first, last);
+  }
+  btree_set(const btree_set& x) : t(x.t) {}
+  // 移动与swap都只交换指针，O(1)
+  btree_set(btree_set&& x) : t(std::move(x.t)) {}
+  btree_set& operator=(const btree_set& x) {
+    t = x.t;
+    return *this;
+  }
+  btree_set& operator=(btree_set&& x) {
+    t = std::move(x.t);
+    return *this;
+  }
+
+  key_compare key_comp() const { return t.key_comp(); }
+  value_compare value_comp() const { return t.key_comp(); }
+  iterator begin() const { return t.begin(); }
+  iterator end() const { return t.end(); }
+  reverse_iterator rbegin() const { return t.rbegin(); }
+  reverse_iterator rend() const { return t.rend(); }
+  const_iterator cbegin() const { return begin(); }
+  const_iterator cend() const { return end(); }
+  bool empty() const { return t.empty(); }
+  size_type size() const { return t.size(); }
+  size_type max_size() const { return t.max_size(); }
+  void swap(btree_set& x) { t.swap(x.t); }
+
+  // insert/erase
+  pair<iterator, bool> insert(const value_type& x) {
+    pair<rep_iterator, bool> p = t.insert_unique(x);
+    return pair<iterator, bool>(p.first, p.second);
+  }
+  iterator insert(iterator pos, const value_type& x) {
+    return t.insert_unique(rep_iterator(pos.node, pos.pos), x);
+  }
+  template <class InputIter>
+  void insert(InputIter first, InputIter last) {
+    t.insert_unique(first, last);
+  }
+  // 由调用者保证[first,last)严格递增，空容器时直接建树
+  template <class InputIter>
+  void insert(sorted_unique_t, InputIter first, InputIter last) {
+    t.insert_unique(sorted_unique, first, last);
+  }
+  // 以args构造元素后插入，键值已存在时构造出的元素被丢弃
+  template <class... Args>
+  pair<iterator, bool> emplace(Args&&... args) {
+    pair<rep_iterator, bool> p = t.emplace_unique(std::forward<Args>(args)...);
+    return pair<iterator, bool>(p.first, p.second);
+  }
+  template <class... Args>
+  iterator emplace_hint(iterator, Args&&... args) {
+    return emplace(std::forward<Args>(args)...).first;
+  }
+  iterator erase(iterator pos) {
+    return t.erase(rep_iterator(pos.node, pos.pos));
+  }
+  size_type erase(const key_type& x) { return t.erase(x); }
+  iterator erase(iterator first, iterator last) {
+    return t.erase(rep_iterator(first.node, first.pos),
+                   rep_iterator(last.node, last.pos));
+  }
+  void clear() { t.clear(); }
+
+  // set operations:
+  iterator find(const key_type& x) const { return t.find(x); }
+  size_type count(const key_type& x) const { return t.count(x); }
+  iterator lower_bound(const key_type& x) const { return t.lower_bound(x); }
+  iterator upper_bound(const key_type& x) const { return t.upper_bound(x); }
+  pair<iterator, iterator> equal_range(const key_type& x) const {
+    return t.equal_range(x);
+  }
+  // 比较器定义了is_transparent时，可以不构造key_type直接查找
+  template <class K, class C = Compare, class = typename C::is_transparent>
+  iterator find(const K& x) const {
+    return t.find(x);
+  }
+  template <class K, class C = Compare, class = typename C::is_transparent>
+  size_type count(const K& x) const {
+    return t.count(x);
+  }
+  template <class K, class C = Compare, class = typename C::is_transparent>
+  iterator lower_bound(const K& x) const {
+    return t.lower_bound(x);
+  }
+  template <class K, class C = Compare, class = typename C::is_transparent>
+  iterator upper_bound(const K& x) const {
+    return t.upper_bound(x);
+  }
+  template <class K, class C = Compare, class = typename C::is_transparent>
+  pair<iterator, iterator> equal_range(const K& x) const {
+    return t.equal_range(x);
+  }
+  friend bool operator==(const btree_set& x, const btree_set& y) {
+    return x.t == y.t;
+  }
+  friend bool operator<(const btree_set& x, const btree_set& y) {
+    return x.t < y.t;
+  }
+  // 删除pred为真的所有元素，O(n)
+  template <class Predicate>
+  friend size_type erase_if(btree_set& c, Predicate pred) {
+    return c.t.erase_if(pred);
+  }
+};
+
+// 允许键值重复的btree_set
+template <class Key, class Compare = std::less<Key>, class Alloc = alloc>
+class btree_multiset {
+ public:
+  typedef Key key_type;
+  typedef Key value_type;
+  typedef Compare key_compare;
+  typedef Compare value_compare;
+
+ private:
+  typedef btree<key_type, value_type, identity<value_type>, key_compare, Alloc>
+      rep_type;
+  typedef typename rep_type::iterator rep_iterator;
+  rep_type t;
+
+ public:
+  typedef typename rep_type::const_pointer pointer;
+  typedef typename rep_type::const_pointer const_pointer;
+  typedef typename rep_type::const_reference reference;
+  typedef typename rep_type::const_reference const_reference;
+  typedef typename rep_type::const_iterator iterator;
+  typedef typename rep_type::const_iterator const_iterator;
+  typedef typename rep_type::const_reverse_iterator reverse_iterator;
+  typedef typename rep_type::const_reverse_iterator const_reverse_iterator;
+  typedef typename rep_type::size_type size_type;
+  typedef typename rep_type::difference_type difference_type;
+
+  btree_multiset() : t(Compare()) {}
+  explicit btree_multiset(const Compare& comp) : t(comp) {}
+  template <class InputIter>
+  btree_multiset(InputIter first, InputIter last) : t(Compare()) {
+    t.insert_equal(first, last);
+  }
+  template <class InputIter>
+  btree_multiset(InputIter first, InputIter last, const Compare& comp)
+      : t(comp) {
+    t.insert_equal(first, last);
+  }
+  btree_multiset(const btree_multiset& x) : t(x.t) {}
+  // 移动与swap都只交换指针，O(1)
+  btree_multiset(btree_multiset&& x) : t(std::move(x.t)) {}
+  btree_multiset& operator=(const btree_multiset& x) {
+    t = x.t;
+    return *this;
+  }
+  btree_multiset& operator=(btree_multiset&& x) {
+    t = std::move(x.t);
+    return *this;
+  }
+
+  key_compare key_comp() const { return t.key_comp(); }
+  value_compare value_comp() const { return t.key_comp(); }
+  iterator begin() const { return t.begin(); }
+  iterator end() const { return t.end(); }
+  reverse_iterator rbegin() const { return t.rbegin(); }
+  reverse_iterator rend() const { return t.rend(); }
+  const_iterator cbegin() const { return begin(); }
+  const_iterator cend() const { return end(); }
+  bool empty() const { return t.empty(); }
+  size_type size() const { return t.size(); }
+  size_type max_size() const { return t.max_size(); }
+  void swap(btree_multiset& x) { t.swap(x.t); }
+
+  // insert/erase
+  iterator insert(const value_type& x) { return t.insert_equal(x); }
+  iterator insert(iterator pos, const value_type& x) {
+    return t.insert_equal(rep_iterator(pos.node, pos.pos), x);
+  }
+  template <class InputIter>
+  void insert(InputIter first, InputIter last) {
+    t.insert_equal(first, last);
+  }
+  // 以args构造元素后插入
+  template <class... Args>
+  iterator emplace(Args&&... args) {
+    return t.emplace_equal(std::forward<Args>(args)...);
+  }
+  template <class... Args>
+  iterator emplace_hint(iterator, Args&&... args) {
+    return t.emplace_equal(std::forward<Args>(args)...);
+  }
+  iterator erase(iterator pos) {
+    return t.erase(rep_iterator(pos.node, pos.pos));
+  }
+  size_type erase(const key_type& x) { return t.erase(x); }
+  iterator erase(iterator first, iterator last) {
+    return t.erase(rep_iterator(first.node, first.pos),
+                   rep_iterator(last.node, last.pos));
+  }
+  void clear() { t.clear(); }
+
+  // multiset operations:
+  iterator find(const key_type& x) const { return t.find(x); }
+  size_type count(const key_type& x) const { return t.count(x); }
+  iterator lower_bound(const key_type& x) const { return t.lower_bound(x); }
+  iterator upper_bound(const key_type& x) const { return t.upper_bound(x); }
+  pair<iterator, iterator> equal_range(const key_type& x) const {
+    return t.equal_range(x);
+  }
+  // 比较器定义了is_transparent时，可以不构造key_type直接查找
+  template <class K, class C = Compare, class = typename C::is_transparent>
+  iterator find(const K& x) const {
+    return t.find(x);
+  }
+  template <class K, class C = Compare, class = typename C::is_transparent>
+  size_type count(const K& x) const {
+    return t.count(x);
+  }
+  template <class K, class C = Compare, class = typename C::is_transparent>
+  iterator lower_bound(const K& x) const {
+    return t.lower_bound(x);
+  }
+  template <class K, class C = Compare, class = typename C::is_transparent>
+  iterator upper_bound(const K& x) const {
+    return t.upper_bound(x);
+  }
+  template <class K, class C = Compare, class = typename C::is_transparent>
+  pair<iterator, iterator> equal_range(const K& x) const {
+    return t.equal_range(x);
+  }
+  friend bool operator==(const btree_multiset& x, const btree_multiset& y) {
+    return x.t == y.t;
+  }
+  friend bool operator<(const btree_multiset& x, const btree_multiset& y) {
+    return x.t < y.t;
+  }
+  // 删除pred为真的所有元素，O(n)
+  template <class Predicate>
+  friend size_type erase_if(btree_multiset& c, Predicate pred) {
+    return c.t.erase_if(pred);
+  }
+};
+
+_MINISTL_END
+
+#endif
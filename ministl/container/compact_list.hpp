@@ -0,0 +1,372 @@
+#ifndef MINISTL_COMPACT_LIST_H
+#define MINISTL_COMPACT_LIST_H
+
+#include "../algorithm/algobase.hpp"
+#include "../configurator/allocator.hpp"
+#include "../configurator/construct.hpp"
+#include "../functor/functor.hpp"
+#include "../iterator/iterator.hpp"
+#include "../utils/util.hpp"
+#include "index_slab.hpp"
+#include "stl_list.hpp"
+
+_MINISTL_BEGIN
+
+// 以32位下标链接的节点，list<int>的节点由24字节减为12字节
+template <class T>
+struct _compact_list_node {
+  _index_type next;  // 须为第一个成员，见_index_slab
+  _index_type prev;
+  alignas(T) unsigned char storage[sizeof(T)];
+
+  T& data() { return *reinterpret_cast<T*>(storage); }
+};
+
+template <class T, class Ref, class Ptr, class List>
+struct _compact_list_iterator {
+  typedef _compact_list_iterator<T, T&, T*, List> iterator;
+  typedef _compact_list_iterator<T, const T&, const T*, List> const_iterator;
+  typedef _compact_list_iterator<T, Ref, Ptr, List> self;
+
+  typedef bidirectional_iterator_tag iterator_category;
+  typedef T value_type;
+  typedef Ptr pointer;
+  typedef Ref reference;
+  typedef ptrdiff_t difference_type;
+
+  const List* l;
+  _index_type node;  // 0为end()
+
+  _compact_list_iterator() : l(0), node(0) {}
+  _compact_list_iterator(const List* lp, _index_type x) : l(lp), node(x) {}
+  _compact_list_iterator(const iterator& x) : l(x.l), node(x.node) {}
+
+  reference operator*() const { return l->N(node).data(); }
+  pointer operator->() const { return &(operator*()); }
+
+  self& operator++() {
+    node = l->N(node).next;
+    return *this;
+  }
+  self operator++(int) {
+    self tmp = *this;
+    ++*this;
+    return tmp;
+  }
+  self& operator--() {
+    node = l->N(node).prev;
+    return *this;
+  }
+  self operator--(int) {
+    self tmp = *this;
+    --*this;
+    return tmp;
+  }
+
+  bool operator==(const self& x) const { return node == x.node; }
+  bool operator!=(const self& x) const { return node != x.node; }
+};
+
+// compact_list：接口与list相同的双向环状链表，节点以32位下标链接，
+// 存于容器自有的块中；下标0为空白节点，即end()
+// 节点不能在两个compact_list之间转移，因此不提供splice与merge
+template <class T, class Alloc = alloc>
+class compact_list {
+ public:
+  typedef T value_type;
+  typedef value_type* pointer;
+  typedef const value_type* const_pointer;
+  typedef value_type& reference;
+  typedef const value_type& const_reference;
+  typedef size_t size_type;
+  typedef ptrdiff_t difference_type;
+  typedef _compact_list_iterator<T, T&, T*, compact_list> iterator;
+  typedef _compact_list_iterator<T, const T&, const T*, compact_list>
+      const_iterator;
+  typedef ministl::reverse_iterator<iterator> reverse_iterator;
+  typedef ministl::reverse_iterator<const_iterator> const_reverse_iterator;
+
+ private:
+  template <class, class, class, class>
+  friend struct _compact_list_iterator;
+
+  typedef _index_type index_type;
+  typedef _compact_list_node<T> list_node;
+  static const index_type max_nodes = index_type(-1) >> 1;
+
+  _index_slab<list_node, Alloc> slab;
+  size_type node_count;
+
+  list_node& N(index_type x) const { return slab[x]; }
+
+  void empty_initialize() {
+    index_type h = slab.allocate(max_nodes);  // 必为0
+    N(h).next = h;
+    N(h).prev = h;
+  }
+  index_type create_node(const T& x) {
+    index_type p = slab.allocate(max_nodes);
+    try {
+      construct(&N(p).data(), x);
+    } catch (...) {
+      slab.deallocate(p);
+      throw;
+    }
+    return p;
+  }
+  void destroy_node(index_type p) {
+    destroy(&N(p).data());
+    slab.deallocate(p);
+  }
+
+ public:
+  compact_list() : node_count(0) { empty_initialize(); }
+  compact_list(const compact_list& x) : node_count(0) {
+    empty_initialize();
+    for (const_iterator it = x.begin(); it != x.end(); ++it)
+      push_back(*it);
+  }
+  // 被移动的链表仍持有一个空白节点
+  compact_list(compact_list&& x) : node_count(0) {
+    empty_initialize();
+    swap(x);
+  }
+  ~compact_list() { clear(); }
+  compact_list& operator=(const compact_list& x);
+  compact_list& operator=(compact_list&& x) {
+    swap(x);
+    return *this;
+  }
+
+  iterator begin() { return iterator(this, N(0).next); }
+  const_iterator begin() const { return const_iterator(this, N(0).next); }
+  iterator end() { return iterator(this, 0); }
+  const_iterator end() const { return const_iterator(this, 0); }
+  reverse_iterator rbegin() { return reverse_iterator(end()); }
+  const_reverse_iterator rbegin() const {
+    return const_reverse_iterator(end());
+  }
+  reverse_iterator rend() { return reverse_iterator(begin()); }
+  const_reverse_iterator rend() const {
+    return const_reverse_iterator(begin());
+  }
+  const_iterator cbegin() const { return begin(); }
+  const_iterator cend() const { return end(); }
+  const_reverse_iterator crbegin() const { return rbegin(); }
+  const_reverse_iterator crend() const { return rend(); }
+
+  bool empty() const { return node_count == 0; }
+  size_type size() const { return node_count; }
+  size_type max_size() const { return max_nodes - 1; }
+
+  reference front() { return *begin(); }
+  const_reference front() const { return *begin(); }
+  reference back() { return *(--end()); }
+  const_reference back() const { return *(--end()); }
+
+  iterator insert(const_iterator position, const T& x);
+  void push_back(const T& x) { insert(end(), x); }
+  void push_front(const T& x) { insert(begin(), x); }
+  iterator erase(const_iterator position);
+  iterator erase(const_iterator first, const_iterator last) {
+    while (first != last)
+      first = erase(first);
+    return iterator(this, last.node);
+  }
+  void pop_front() { erase(begin()); }
+  void pop_back() { erase(--end()); }
+  // 元素无需析构时不必遍历，O(1)；下标全部作废，块留待重用
+  void clear();
+
+  void remove(const T& value);
+  void unique();
+  void reverse();
+  // 稳定排序，同list::sort将节点收集到数组中排序后一次性重新链接，
+  // 数组存放32位下标，与list共用每线程的缓冲区
+  void sort() { sort(less<T>()); }
+  template <class Compare>
+  void sort(Compare comp);
+  // 迭代器记有所属的链表，交换与移动后原有的迭代器失效
+  void swap(compact_list& x) {
+    slab.swap(x.slab);
+    std::swap(node_count, x.node_count);
+  }
+
+  friend bool operator==(const compact_list& x, const compact_list& y) {
+    return x.size() == y.size() && ministl::equal(x.begin(), x.end(), y.begin());
+  }
+  friend bool operator<(const compact_list& x, const compact_list& y) {
+    return ministl::lexicographical_compare(x.begin(), x.end(), y.begin(),
+                                            y.end());
+  }
+};
+
+template <class T, class Alloc>
+compact_list<T, Alloc>& compact_list<T, Alloc>::operator=(
+    const compact_list& x) {
+  if (this != &x) {
+    iterator first = begin();
+    const_iterator first2 = x.begin();
+    for (; first != end() && first2 != x.end(); ++first, ++first2)
+      *first = *first2;
+    if (first2 == x.end())
+      erase(first, end());
+    else
+      for (; first2 != x.end(); ++first2)
+        push_back(*first2);
+  }
+  return *this;
+}
+
+template <class T, class Alloc>
+typename compact_list<T, Alloc>::iterator compact_list<T, Alloc>::insert(
+    const_iterator position,
+    const T& x) {
+  index_type tmp = create_node(x);
+  index_type next = position.node;
+  index_type prev = N(next).prev;
+  N(tmp).next = next;
+  N(tmp).prev = prev;
+  N(prev).next = tmp;
+  N(next).prev = tmp;
+  ++node_count;
+  return iterator(this, tmp);
+}
+
+template <class T, class Alloc>
+typename compact_list<T, Alloc>::iterator compact_list<T, Alloc>::erase(
+    const_iterator position) {
+  index_type x = position.node;
+  index_type next = N(x).next;
+  index_type prev = N(x).prev;
+  N(prev).next = next;
+  N(next).prev = prev;
+  destroy_node(x);
+  --node_count;
+  return iterator(this, next);
+}
+
+template <class T, class Alloc>
+void compact_list<T, Alloc>::clear() {
+  if (!std::is_trivially_destructible<T>::value) {
+    for (index_type cur = N(0).next; cur != 0; cur = N(cur).next)
+      destroy(&N(cur).data());
+  }
+  slab.reset();
+  N(0).next = 0;
+  N(0).prev = 0;
+  node_count = 0;
+}
+
+template <class T, class Alloc>
+void compact_list<T, Alloc>::remove(const T& value) {
+  iterator first = begin();
+  while (first != end()) {
+    if (*first == value)
+      first = erase(first);
+    else
+      ++first;
+  }
+}
+
+// 移除连续而相同的元素，只留一个
+template <class T, class Alloc>
+void compact_list<T, Alloc>::unique() {
+  iterator first = begin();
+  if (first == end())
+    return;
+  iterator next = first;
+  while (++next != end()) {
+    if (*first == *next) {
+      erase(next);
+      next = first;
+    } else {
+      first = next;
+    }
+  }
+}
+
+// 交换每个节点的前后链接，不搬动元素
+template <class T, class Alloc>
+void compact_list<T, Alloc>::reverse() {
+  index_type cur = 0;
+  do {
+    index_type next = N(cur).next;
+    N(cur).next = N(cur).prev;
+    N(cur).prev = next;
+    cur = next;
+  } while (cur != 0);
+}
+
+// 先对长度为16的小段做插入排序，再自底向上两两归并，a与tmp轮流作为输出
+template <class T, class Alloc>
+template <class Compare>
+void compact_list<T, Alloc>::sort(Compare comp) {
+  const size_type n = node_count;
+  if (n < 2)
+    return;
+  _list_sort_buffer& shared = _list_sort_buffer::local();
+  _list_sort_buffer local;
+  _list_sort_buffer& buf = shared.busy ? local : shared;
+  // 缓冲区以void*计，2n个下标只需不到n个void*的空间
+  const size_type words =
+      (2 * n * sizeof(index_type) + sizeof(void*) - 1) / sizeof(void*);
+  index_type* a = reinterpret_cast<index_type*>(buf.reserve(words));
+  index_type* tmp = a + n;
+  buf.busy = true;
+  size_type i = 0;
+  for (index_type cur = N(0).next; cur != 0; cur = N(cur).next)
+    a[i++] = cur;
+  try {
+    const size_type run = 16;
+    for (size_type lo = 0; lo < n; lo += run) {
+      size_type hi = lo + run < n ? lo + run : n;
+      for (size_type i = lo + 1; i < hi; ++i) {
+        index_type v = a[i];
+        size_type j = i;
+        for (; j > lo && comp(N(v).data(), N(a[j - 1]).data()); --j)
+          a[j] = a[j - 1];
+        a[j] = v;
+      }
+    }
+    for (size_type width = run; width < n; width *= 2) {
+      for (size_type lo = 0; lo < n; lo += 2 * width) {
+        size_type mid = lo + width < n ? lo + width : n;
+        size_type hi = lo + 2 * width < n ? lo + 2 * width : n;
+        size_type i = lo, j = mid, k = lo;
+        while (i < mid && j < hi) {
+          // 只有右侧严格小于左侧时才取右侧，保证稳定
+          if (comp(N(a[j]).data(), N(a[i]).data()))
+            tmp[k++] = a[j++];
+          else
+            tmp[k++] = a[i++];
+        }
+        while (i < mid)
+          tmp[k++] = a[i++];
+        while (j < hi)
+          tmp[k++] = a[j++];
+      }
+      index_type* t = a;
+      a = tmp;
+      tmp = t;
+    }
+  } catch (...) {
+    // 链接在重新链接之前未被改动，链表保持原状
+    buf.busy = false;
+    throw;
+  }
+  // 按数组顺序重新链接所有节点
+  index_type prev = 0;
+  for (size_type i = 0; i < n; ++i) {
+    N(prev).next = a[i];
+    N(a[i]).prev = prev;
+    prev = a[i];
+  }
+  N(prev).next = 0;
+  N(0).prev = prev;
+  buf.busy = false;
+}
+
+_MINISTL_END
+
+#endif
\ No newline at end of file
@@ -0,0 +1,115 @@
+#ifndef MINISTL_COMPACT_SET_H
+#define MINISTL_COMPACT_SET_H
+
+#include "../configurator/allocator.hpp"
+#include "../functor/functor.hpp"
+#include "../iterator/iterator.hpp"
+#include "../utils/util.hpp"
+#include "index_tree.hpp"
+
+_MINISTL_BEGIN
+
+// compact_set：接口与set相同，节点以32位下标链接，存于容器自有的块中
+// 每个节点省下一半的链接开销，一条缓存行能放下的节点约为set的两倍；
+// 元素个数不能超过2^31 - 2，迭代器与元素地址在元素被删除之前保持有效
+template <class Key, class Compare = std::less<Key>, class Alloc = alloc>
+class compact_set {
+ public:
+  typedef Key key_type;
+  typedef Key value_type;
+  typedef Compare key_compare;
+  typedef Compare value_compare;
+
+ private:
+  typedef index_rb_tree<key_type,
+                        value_type,
+                        identity<value_type>,
+                        key_compare,
+                        Alloc>
+      rep_type;
+  rep_type t;
+
+ public:
+  typedef typename rep_type::const_pointer pointer;
+  typedef typename rep_type::const_pointer const_pointer;
+  typedef typename rep_type::const_reference reference;
+  typedef typename rep_type::const_reference const_reference;
+  typedef typename rep_type::const_iterator iterator;
+  typedef typename rep_type::const_iterator const_iterator;
+  typedef typename rep_type::const_reverse_iterator const_reverse_iterator;
+  typedef typename rep_type::const_reverse_iterator reverse_iterator;
+  typedef typename rep_type::size_type size_type;
+  typedef typename rep_type::difference_type difference_type;
+
+  compact_set() : t(Compare()) {}
+  explicit compact_set(const Compare& comp) : t(comp) {}
+
+  template <class InputIter>
+  compact_set(InputIter first, InputIter last) : t(Compare()) {
+    t.insert_unique(first, last);
+  }
+  template <class InputIter>
+  compact_set(InputIter first, InputIter last, const Compare& comp)
+      : t(comp) {
+    t.insert_unique(first, last);
+  }
+
+  compact_set(const compact_set& x) : t(x.t) {}
+  compact_set(compact_set&& x) : t(std::move(x.t)) {}
+  compact_set& operator=(const compact_set& x) {
+    t = x.t;
+    return *this;
+  }
+  compact_set& operator=(compact_set&& x) {
+    t = std::move(x.t);
+    return *this;
+  }
+
+  // accessors
+  key_compare key_comp() const { return t.key_comp(); }
+  value_compare value_comp() const { return t.key_comp(); }
+  iterator begin() const { return t.begin(); }
+  iterator end() const { return t.end(); }
+  reverse_iterator rbegin() const { return t.rbegin(); }
+  reverse_iterator rend() const { return t.rend(); }
+  const_iterator cbegin() const { return begin(); }
+  const_iterator cend() const { return end(); }
+  bool empty() const { return t.empty(); }
+  size_type size() const { return t.size(); }
+  size_type max_size() const { return t.max_size(); }
+  void swap(compact_set& x) { t.swap(x.t); }
+
+  // insert/erase
+  pair<iterator, bool> insert(const value_type& x) {
+    pair<typename rep_type::iterator, bool> p = t.insert_unique(x);
+    return pair<iterator, bool>(p.first, p.second);
+  }
+  template <class InputIter>
+  void insert(InputIter first, InputIter last) {
+    t.insert_unique(first, last);
+  }
+  void erase(iterator position) { t.erase(position); }
+  size_type erase(const key_type& x) { return t.erase(x); }
+  void erase(iterator first, iterator last) { t.erase(first, last); }
+  void clear() { t.clear(); }
+
+  // set operations:
+  iterator find(const key_type& x) const { return t.find(x); }
+  size_type count(const key_type& x) const { return t.count(x); }
+  iterator lower_bound(const key_type& x) const { return t.lower_bound(x); }
+  iterator upper_bound(const key_type& x) const { return t.upper_bound(x); }
+  pair<iterator, iterator> equal_range(const key_type& x) const {
+    return t.equal_range(x);
+  }
+
+  friend bool operator==(const compact_set& x, const compact_set& y) {
+    return x.t == y.t;
+  }
+  friend bool operator<(const compact_set& x, const compact_set& y) {
+    return x.t < y.t;
+  }
+};
+
+_MINISTL_END
+
+#endif
\ No newline at end of file
@@ -0,0 +1,254 @@
+#ifndef MINISTL_CONCURRENT_MAP_H
+#define MINISTL_CONCURRENT_MAP_H
+
+#include <atomic>
+#include <climits>
+#include <mutex>
+
+#include "../configurator/allocator.hpp"
+#include "../utils/util.hpp"
+#include "persistent_map.hpp"
+
+_MINISTL_BEGIN
+
+// 基于epoch的内存回收
+// 每个线程持有一条记录，读者进入临界区时把全局epoch写入自己的记录，离开时清零
+// 写者换上新版本后推进全局epoch，并以推进后的值标记旧版本；
+// 所有记录都为0或不小于该标记时，已没有读者能看到旧版本，可以回收
+// 每条记录独占一条缓存行，读者写自己的记录时互不争用
+struct alignas(64) _epoch_record {
+  std::atomic<unsigned long long> epoch;  // 0表示不在读临界区
+  std::atomic<bool> in_use;               // 是否有线程持有本记录
+  unsigned nest;  // 嵌套的临界区层数，只由持有者访问
+  _epoch_record* next;
+
+  _epoch_record() : epoch(0), in_use(true), nest(0), next(0) {}
+};
+
+// 所有记录串成一条只增不减的链表，线程退出后记录留待新线程重用
+inline std::atomic<_epoch_record*>& _epoch_records() {
+  static std::atomic<_epoch_record*> head(nullptr);
+  return head;
+}
+inline std::atomic<unsigned long long>& _epoch_global() {
+  static std::atomic<unsigned long long> epoch(1);
+  return epoch;
+}
+
+inline _epoch_record* _epoch_acquire_record() {
+  std::atomic<_epoch_record*>& head = _epoch_records();
+  for (_epoch_record* r = head.load(); r; r = r->next) {
+    bool expected = false;
+    if (!r->in_use.load(std::memory_order_relaxed) &&
+        r->in_use.compare_exchange_strong(expected, true))
+      return r;
+  }
+  _epoch_record* r = new _epoch_record;
+  r->next = head.load();
+  while (!head.compare_exchange_weak(r->next, r)) {
+  }
+  return r;
+}
+
+// 线程第一次读时取得记录，线程退出时交还
+struct _epoch_thread {
+  _epoch_record* rec;
+  _epoch_thread() : rec(_epoch_acquire_record()) {}
+  ~_epoch_thread() { rec->in_use.store(false, std::memory_order_release); }
+};
+inline _epoch_record* _epoch_local() {
+  static thread_local _epoch_thread t;
+  return t.rec;
+}
+
+// 正在读临界区中的线程所记录的最小epoch，没有读者时为ULLONG_MAX
+inline unsigned long long _epoch_min_active() {
+  unsigned long long m = ULLONG_MAX;
+  for (_epoch_record* r = _epoch_records().load(); r; r = r->next) {
+    unsigned long long e = r->epoch.load();
+    if (e != 0 && e < m)
+      m = e;
+  }
+  return m;
+}
+
+// 读临界区，存活期间看到的版本不会被回收；可以嵌套，须在同一线程内析构
+class _epoch_guard {
+  _epoch_record* rec;
+
+  _epoch_guard(const _epoch_guard&);
+  _epoch_guard& operator=(const _epoch_guard&);
+
+ public:
+  _epoch_guard() : rec(_epoch_local()) {
+    if (rec->nest++ == 0)
+      rec->epoch.store(_epoch_global().load());
+  }
+  _epoch_guard(_epoch_guard&& x) : rec(x.rec) { x.rec = 0; }
+  ~_epoch_guard() {
+    if (rec && --rec->nest == 0)
+      rec->epoch.store(0, std::memory_order_release);
+  }
+};
+
+// 读多写少的有序map：读者不加锁也不等待，写者之间以互斥量串行
+// 每个版本是一个persistent_map：写者复制当前版本为O(1)，在副本上的每次修改
+// 只新建根到目标的O(log n)个节点，其余与当前版本共享，再以一次原子操作发布，
+// 读者看到的总是某个完整的版本；旧版本经epoch确认无人再读后释放，
+// 只有它独有的节点随之回收
+// 节点的引用计数不是原子的，但只有持有write_mutex的写者会增减它，
+// 读者只读取节点的元素与子节点指针，互不冲突
+// 写者配置节点时可能与其他线程并发，默认使用malloc_alloc而非内存池
+template <class Key,
+          class T,
+          class Compare = std::less<Key>,
+          class Alloc = malloc_alloc>
+class concurrent_map {
+ public:
+  typedef persistent_map<Key, T, Compare, Alloc> map_type;
+  typedef typename map_type::key_type key_type;
+  typedef typename map_type::mapped_type mapped_type;
+  typedef typename map_type::value_type value_type;
+  typedef typename map_type::size_type size_type;
+
+ private:
+  struct version {
+    map_type m;
+    unsigned long long retired;  // 被替换时的epoch
+    version* next;
+    version() : retired(0), next(0) {}
+    explicit version(const map_type& x) : m(x), retired(0), next(0) {}
+  };
+
+  std::atomic<version*> cur;
+  // 以下只由持有write_mutex的写者访问
+  std::mutex write_mutex;
+  version* retired;  // 等待回收的旧版本
+
+  concurrent_map(const concurrent_map&);
+  concurrent_map& operator=(const concurrent_map&);
+
+ public:
+  // 当前版本的只读视图，存活期间不受写者影响；须在创建它的线程内析构
+  class snapshot {
+    _epoch_guard guard;  // 须先于读取cur进入临界区
+    const map_type* m;
+
+   public:
+    explicit snapshot(const concurrent_map& c) : m(&c.cur.load()->m) {}
+    snapshot(snapshot&& x) : guard(std::move(x.guard)), m(x.m) {}
+    const map_type& operator*() const { return *m; }
+    const map_type* operator->() const { return m; }
+  };
+
+  concurrent_map() : cur(new version), retired(0) {}
+  explicit concurrent_map(const map_type& x)
+      : cur(new version(x)), retired(0) {}
+  // 析构时不能再有读者
+  ~concurrent_map() {
+    delete cur.load();
+    _delete_list(retired);
+  }
+
+  // 读取，均不加锁
+  snapshot read() const { return snapshot(*this); }
+  // 找到k时把实值复制到out
+  bool get(const key_type& k, mapped_type& out) const {
+    snapshot s(*this);
+    typename map_type::const_iterator it = s->find(k);
+    if (it == s->end())
+      return false;
+    out = (*it).second;
+    return true;
+  }
+  bool contains(const key_type& k) const { return read()->count(k) != 0; }
+  size_type size() const { return read()->size(); }
+  bool empty() const { return read()->empty(); }
+
+  // 写入，f在当前版本的副本上修改，返回后副本发布为新版本
+  // 副本与当前版本共享节点，f中的每次修改为O(log n)
+  // f抛出异常时什么也不发布
+  template <class F>
+  void update(F f) {
+    std::lock_guard<std::mutex> lock(write_mutex);
+    version* v = new version(cur.load()->m);
+    try {
+      f(v->m);
+    } catch (...) {
+      delete v;
+      throw;
+    }
+    _publish(v);
+  }
+  // k已存在时不发布
+  bool insert(const value_type& x) {
+    std::lock_guard<std::mutex> lock(write_mutex);
+    if (cur.load()->m.count(x.first))
+      return false;
+    version* v = new version(cur.load()->m);
+    try {
+      v->m.insert(x);
+    } catch (...) {
+      delete v;
+      throw;
+    }
+    _publish(v);
+    return true;
+  }
+  template <class M>
+  void insert_or_assign(const key_type& k, M&& obj) {
+    update([&](map_type& m) { m.insert_or_assign(k, std::forward<M>(obj)); });
+  }
+  size_type erase(const key_type& k) {
+    std::lock_guard<std::mutex> lock(write_mutex);
+    if (!cur.load()->m.count(k))
+      return 0;
+    version* v = new version(cur.load()->m);
+    try {
+      v->m.erase(k);
+    } catch (...) {
+      delete v;
+      throw;
+    }
+    _publish(v);
+    return 1;
+  }
+  void clear() {
+    std::lock_guard<std::mutex> lock(write_mutex);
+    _publish(new version);
+  }
+
+ private:
+  // 发布v，旧版本以推进后的epoch标记，挂入待回收链表
+  void _publish(version* v) {
+    version* old = cur.exchange(v);
+    old->retired = _epoch_global().fetch_add(1) + 1;
+    old->next = retired;
+    retired = old;
+    _reclaim();
+  }
+  // 回收已没有读者的旧版本，不等待仍在读的读者
+  void _reclaim() {
+    unsigned long long min_active = _epoch_min_active();
+    version** link = &retired;
+    while (version* r = *link) {
+      if (min_active >= r->retired) {
+        *link = r->next;
+        delete r;
+      } else {
+        link = &r->next;
+      }
+    }
+  }
+  static void _delete_list(version* v) {
+    while (v) {
+      version* next = v->next;
+      delete v;
+      v = next;
+    }
+  }
+};
+
+_MINISTL_END
+
+#endif
\ No newline at end of file
@@ -0,0 +1,281 @@
+#ifndef MINISTL_COUNTED_MULTISET_H
+#define MINISTL_COUNTED_MULTISET_H
+
+#include "../configurator/allocator.hpp"
+#include "../functor/functor.hpp"
+#include "../iterator/iterator.hpp"
+#include "../utils/util.hpp"
+#include "rb_tree.hpp"
+
+_MINISTL_BEGIN
+
+// node所指节点存有键值与其出现次数，index为该键值的第几次出现（从0起）
+// 逐个走过每一次出现，end()为(header, 0)
+template <class Key, class TreeIter>
+struct _counted_iterator {
+  typedef bidirectional_iterator_tag iterator_category;
+  typedef Key value_type;
+  typedef const Key* pointer;
+  typedef const Key& reference;
+  typedef ptrdiff_t difference_type;
+  typedef _counted_iterator<Key, TreeIter> self;
+
+  TreeIter node;
+  size_t index;
+
+  _counted_iterator() : index(0) {}
+  _counted_iterator(TreeIter x, size_t i) : node(x), index(i) {}
+
+  reference operator*() const { return node->first; }
+  pointer operator->() const { return &(operator*()); }
+
+  self& operator++() {
+    if (++index == node->second) {
+      ++node;
+      index = 0;
+    }
+    return *this;
+  }
+  self operator++(int) {
+    self tmp = *this;
+    ++*this;
+    return tmp;
+  }
+  self& operator--() {
+    if (index == 0) {
+      --node;
+      index = node->second;
+    }
+    --index;
+    return *this;
+  }
+  self operator--(int) {
+    self tmp = *this;
+    --*this;
+    return tmp;
+  }
+
+  bool operator==(const self& x) const {
+    return node == x.node && index == x.index;
+  }
+  bool operator!=(const self& x) const { return !(*this == x); }
+};
+
+// counted_multiset：接口与multiset相同，但相同的键值只占一个节点，节点中记录出现次数
+// 内存随不同键值的个数增长，与插入的总次数无关，适合大量重复的计数场合
+// count为O(log n)；迭代器仍逐个走过每一次出现，删除某键值的一次出现时
+// 总是去掉最后一次，指向该键值最后一次出现的迭代器随之失效
+template <class Key, class Compare = std::less<Key>, class Alloc = alloc>
+class counted_multiset {
+ public:
+  typedef Key key_type;
+  typedef Key value_type;
+  typedef Compare key_compare;
+  typedef Compare value_compare;
+
+ private:
+  typedef pair<Key, size_t> node_value;  // 键值与出现次数，次数不为0
+  typedef rb_tree<key_type, node_value, select1st<node_value>, Compare, Alloc>
+      rep_type;
+  typedef typename rep_type::iterator rep_iterator;
+  rep_type t;
+  size_t total;  // 所有键值出现次数之和
+
+ public:
+  typedef const value_type* pointer;
+  typedef const value_type* const_pointer;
+  typedef const value_type& reference;
+  typedef const value_type& const_reference;
+  typedef _counted_iterator<Key, typename rep_type::const_iterator> iterator;
+  typedef iterator const_iterator;
+  typedef ministl::reverse_iterator<iterator> reverse_iterator;
+  typedef reverse_iterator const_reverse_iterator;
+  typedef size_t size_type;
+  typedef ptrdiff_t difference_type;
+
+  counted_multiset() : t(Compare()), total(0) {}
+  explicit counted_multiset(const Compare& comp) : t(comp), total(0) {}
+
+  template <class InputIter>
+  counted_multiset(InputIter first, InputIter last) : t(Compare()), total(0) {
+    insert(first, last);
+  }
+  template <class InputIter>
+  counted_multiset(InputIter first, InputIter last, const Compare& comp)
+      : t(comp), total(0) {
+    insert(first, last);
+  }
+
+  counted_multiset(const counted_multiset& x) : t(x.t), total(x.total) {}
+  counted_multiset(counted_multiset&& x)
+      : t(std::move(x.t)), total(x.total) {
+    x.total = 0;
+  }
+  counted_multiset& operator=(const counted_multiset& x) {
+    t = x.t;
+    total = x.total;
+    return *this;
+  }
+  counted_multiset& operator=(counted_multiset&& x) {
+    swap(x);
+    return *this;
+  }
+
+  // accessors
+  key_compare key_comp() const { return t.key_comp(); }
+  value_compare value_comp() const { return t.key_comp(); }
+  iterator begin() const { return iterator(t.begin(), 0); }
+  iterator end() const { return iterator(t.end(), 0); }
+  reverse_iterator rbegin() const { return reverse_iterator(end()); }
+  reverse_iterator rend() const { return reverse_iterator(begin()); }
+  const_iterator cbegin() const { return begin(); }
+  const_iterator cend() const { return end(); }
+  bool empty() const { return total == 0; }
+  // 所有元素的个数，重复的键值各计一次
+  size_type size() const { return total; }
+  // 不同键值的个数，即节点数
+  size_type distinct_size() const { return t.size(); }
+  size_type max_size() const { return size_type(-1); }
+  void swap(counted_multiset& x) {
+    t.swap(x.t);
+    std::swap(total, x.total);
+  }
+
+  // insert/erase
+  // 插入一个x，返回指向它的迭代器，它排在与x相等的元素之后
+  iterator insert(const value_type& x) { return insert_n(x, 1); }
+  // 插入n个x，返回指向其中第一个的迭代器；n为0时返回lower_bound(x)
+  // 不与insert(first, last)同名，以免整数键值被当作迭代器区间
+  iterator insert_n(const value_type& x, size_type n);
+  template <class InputIter>
+  void insert(InputIter first, InputIter last) {
+    for (; first != last; ++first)
+      insert_n(*first, 1);
+  }
+  // 删除position所指的一次出现
+  void erase(iterator position) {
+    rep_iterator i = t.mutable_iterator(position.node);
+    if (--i->second == 0)
+      t.erase(i);
+    --total;
+  }
+  // 删除键值为x的所有元素，返回删除的个数
+  size_type erase(const key_type& x) {
+    rep_iterator i = t.find(x);
+    if (i == t.end())
+      return 0;
+    size_type n = i->second;
+    t.erase(i);
+    total -= n;
+    return n;
+  }
+  void erase(iterator first, iterator last);
+  void clear() {
+    t.clear();
+    total = 0;
+  }
+
+  // multiset operations:
+  iterator find(const key_type& x) const { return iterator(t.find(x), 0); }
+  // 节点中记有次数，O(log n)
+  size_type count(const key_type& x) const {
+    typename rep_type::const_iterator i = t.find(x);
+    return i == t.end() ? 0 : i->second;
+  }
+  iterator lower_bound(const key_type& x) const {
+    return iterator(t.lower_bound(x), 0);
+  }
+  iterator upper_bound(const key_type& x) const {
+    return iterator(t.upper_bound(x), 0);
+  }
+  pair<iterator, iterator> equal_range(const key_type& x) const {
+    return pair<iterator, iterator>(lower_bound(x), upper_bound(x));
+  }
+
+  // 逐个节点比较键值与次数，不必展开重复的元素
+  friend bool operator==(const counted_multiset& x,
+                         const counted_multiset& y) {
+    if (x.total != y.total || x.t.size() != y.t.size())
+      return false;
+    typename rep_type::const_iterator i = x.t.begin();
+    typename rep_type::const_iterator j = y.t.begin();
+    for (; i != x.t.end(); ++i, ++j)
+      if (i->second != j->second || x.t.key_comp()(i->first, j->first) ||
+          x.t.key_comp()(j->first, i->first))
+        return false;
+    return true;
+  }
+  friend bool operator<(const counted_multiset& x, const counted_multiset& y) {
+    return x._less(y);
+  }
+
+ private:
+  bool _less(const counted_multiset& y) const;
+};
+
+template <class Key, class Compare, class Alloc>
+typename counted_multiset<Key, Compare, Alloc>::iterator
+counted_multiset<Key, Compare, Alloc>::insert_n(const value_type& x,
+                                                size_type n) {
+  if (n == 0)
+    return lower_bound(x);
+  rep_iterator i = t.lower_bound(x);
+  if (i == t.end() || key_comp()(x, i->first))
+    i = t.insert_unique(i, node_value(x, 0));
+  size_type pos = i->second;
+  i->second += n;
+  total += n;
+  return iterator(i, pos);
+}
+
+// 两端的节点可能只删去部分出现，中间的节点整段交给rb_tree的区间删除
+template <class Key, class Compare, class Alloc>
+void counted_multiset<Key, Compare, Alloc>::erase(iterator first,
+                                                  iterator last) {
+  if (first == begin() && last == end()) {
+    clear();
+    return;
+  }
+  if (first.node != last.node && first.index != 0) {
+    rep_iterator i = t.mutable_iterator(first.node);
+    total -= i->second - first.index;
+    i->second = first.index;
+    ++first.node;
+    first.index = 0;
+  }
+  if (first.node != last.node) {
+    for (typename rep_type::const_iterator i = first.node; i != last.node; ++i)
+      total -= i->second;
+    t.erase(t.mutable_iterator(first.node), t.mutable_iterator(last.node));
+  }
+  // 此时first与last位于同一节点，去掉其中[first.index, last.index)的出现
+  if (last.index > first.index) {
+    rep_iterator i = t.mutable_iterator(last.node);
+    i->second -= last.index - first.index;
+    total -= last.index - first.index;
+  }
+}
+
+// 按展开后的序列做字典序比较：键值相同而次数不同时，次数少的一方先走到
+// 下一个更大的键值，除非它已经结束
+template <class Key, class Compare, class Alloc>
+bool counted_multiset<Key, Compare, Alloc>::_less(
+    const counted_multiset& y) const {
+  typename rep_type::const_iterator i = t.begin();
+  typename rep_type::const_iterator j = y.t.begin();
+  for (; i != t.end() && j != y.t.end(); ++i, ++j) {
+    if (key_comp()(i->first, j->first))
+      return true;
+    if (key_comp()(j->first, i->first))
+      return false;
+    if (i->second < j->second)
+      return ++i == t.end();
+    if (j->second < i->second)
+      return ++j != y.t.end();
+  }
+  return i == t.end() && j != y.t.end();
+}
+
+_MINISTL_END
+
+#endif
\ No newline at end of file
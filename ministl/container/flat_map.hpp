@@ -0,0 +1,366 @@
+#ifndef MINISTL_FLAT_MAP_H
+#define MINISTL_FLAT_MAP_H
+
+#include "../configurator/allocator.hpp"
+#include "../functor/functor.hpp"
+#include "../iterator/iterator.hpp"
+#include "../utils/util.hpp"
+#include "flat_tree.hpp"
+#include "stl_vector.hpp"
+
+_MINISTL_BEGIN
+
+// flat_map 迭代器，同时指向键数组和值数组中的同一位置
+// V 为 T 或 const T
+template <class Key, class V>
+struct _flat_map_iterator {
+  typedef _flat_map_iterator<Key, typename std::remove_const<V>::type>
+      iterator;
+  typedef _flat_map_iterator<Key, const V> const_iterator;
+  typedef _flat_map_iterator<Key, V> self;
+
+  typedef random_access_iterator_tag iterator_category;
+  typedef pair<Key, typename std::remove_const<V>::type> value_type;
+  typedef pair<const Key&, V&> reference;
+  typedef _flat_map_arrow<reference> pointer;
+  typedef ptrdiff_t difference_type;
+  typedef size_t size_type;
+
+  const Key* k;
+  V* v;
+
+  _flat_map_iterator() : k(0), v(0) {}
+  _flat_map_iterator(const Key* kp, V* vp) : k(kp), v(vp) {}
+  _flat_map_iterator(const iterator& x) : k(x.k), v(x.v) {}
+
+  reference operator*() const { return reference(*k, *v); }
+  pointer operator->() const { return pointer(operator*()); }
+  reference operator[](difference_type n) const {
+    return reference(k[n], v[n]);
+  }
+
+  self& operator++() {
+    ++k, ++v;
+    return *this;
+  }
+  self operator++(int) {
+    self tmp = *this;
+    ++*this;
+    return tmp;
+  }
+  self& operator--() {
+    --k, --v;
+    return *this;
+  }
+  self operator--(int) {
+    self tmp = *this;
+    --*this;
+    return tmp;
+  }
+  self& operator+=(difference_type n) {
+    k += n, v += n;
+    return *this;
+  }
+  self& operator-=(difference_type n) { return *this += -n; }
+  self operator+(difference_type n) const { return self(k + n, v + n); }
+  self operator-(difference_type n) const { return self(k - n, v - n); }
+  difference_type operator-(const self& x) const { return k - x.k; }
+
+  bool operator==(const self& x) const { return k == x.k; }
+  bool operator!=(const self& x) const { return k != x.k; }
+  bool operator<(const self& x) const { return k < x.k; }
+  bool operator>(const self& x) const { return x < *this; }
+  bool operator<=(const self& x) const { return !(x < *this); }
+  bool operator>=(const self& x) const { return !(*this < x); }
+};
+
+// flat_map：以两个有序vector分别保存键和值的关联容器
+// 接口与map相同；查找为连续内存上的二分，插入删除需要搬动元素，为O(n)，
+// 适合建好后以查询为主的表。每个元素没有节点的三个指针和颜色，
+// 遍历时只是线性扫描
+template <class Key,
+          class T,
+          class Compare = std::less<Key>,
+          class Alloc = alloc>
+class flat_map {
+ public:
+  typedef Key key_type;
+  typedef T data_type;
+  typedef T mapped_type;
+  typedef pair<Key, T> value_type;
+  typedef Compare key_compare;
+
+  class value_compare : public binary_function<value_type, value_type, bool> {
+    friend class flat_map<Key, T, Compare, Alloc>;
+
+   protected:
+    Compare comp;
+    value_compare(Compare c) : comp(c) {}
+
+   public:
+    bool operator()(const value_type& x, const value_type& y) const {
+      return comp(x.first, y.first);
+    }
+  };
+
+  typedef _flat_map_iterator<Key, T> iterator;
+  typedef _flat_map_iterator<Key, const T> const_iterator;
+  typedef ministl::reverse_iterator<iterator> reverse_iterator;
+  typedef ministl::reverse_iterator<const_iterator> const_reverse_iterator;
+  typedef typename iterator::reference reference;
+  typedef typename const_iterator::reference const_reference;
+  typedef typename iterator::pointer pointer;
+  typedef typename const_iterator::pointer const_pointer;
+  typedef size_t size_type;
+  typedef ptrdiff_t difference_type;
+
+ private:
+  vector<Key, Alloc> keys;  // 有序且不重复的键
+  vector<T, Alloc> vals;    // 与keys一一对应的值
+  Compare comp;
+
+  size_type index_of(const_iterator pos) const { return pos.k - keys.begin(); }
+  iterator make_iter(size_type i) {
+    return iterator(keys.begin() + i, vals.begin() + i);
+  }
+  const_iterator make_iter(size_type i) const {
+    return const_iterator(keys.begin() + i, vals.begin() + i);
+  }
+  size_type lower_index(const key_type& k) const {
+    return _flat_lower_bound(keys.begin(), keys.end(), k, comp) -
+           keys.begin();
+  }
+  // 在下标i处插入，维持键值两个数组同步
+  iterator insert_at(size_type i, const key_type& k, const T& v) {
+    keys.insert(keys.begin() + i, k);
+    try {
+      vals.insert(vals.begin() + i, v);
+    } catch (...) {
+      keys.erase(keys.begin() + i);
+      throw;
+    }
+    return make_iter(i);
+  }
+  // 将idx所列的批量元素与现有元素归并，重复的键只保留先出现的一个
+  void merge_batch(const vector<Key, Alloc>& bk,
+                   const vector<T, Alloc>& bv,
+                   const vector<size_t, Alloc>& idx);
+  template <class InputIter>
+  void insert_range(InputIter first, InputIter last, bool sorted);
+
+ public:
+  flat_map() : comp(Compare()) {}
+  explicit flat_map(const Compare& c) : comp(c) {}
+
+  template <class InputIter>
+  flat_map(InputIter first, InputIter last) : comp(Compare()) {
+    insert_range(first, last, false);
+  }
+  template <class InputIter>
+  flat_map(InputIter first, InputIter last, const Compare& c) : comp(c) {
+    insert_range(first, last, false);
+  }
+  // 输入已严格递增时不再排序
+  template <class InputIter>
+  flat_map(sorted_unique_t, InputIter first, InputIter last)
+      : comp(Compare()) {
+    insert_range(first, last, true);
+  }
+  template <class InputIter>
+  flat_map(sorted_unique_t,
+           InputIter first,
+           InputIter last,
+           const Compare& c)
+      : comp(c) {
+    insert_range(first, last, true);
+  }
+
+  flat_map(const flat_map& x) : keys(x.keys), vals(x.vals), comp(x.comp) {}
+  flat_map& operator=(const flat_map& x) {
+    keys = x.keys;
+    vals = x.vals;
+    comp = x.comp;
+    return *this;
+  }
+
+  key_compare key_comp() const { return comp; }
+  value_compare value_comp() const { return value_compare(comp); }
+  // 迭代器
+  iterator begin() { return make_iter(0); }
+  const_iterator begin() const { return make_iter(0); }
+  iterator end() { return make_iter(size()); }
+  const_iterator end() const { return make_iter(size()); }
+  reverse_iterator rbegin() { return reverse_iterator(end()); }
+  reverse_iterator rend() { return reverse_iterator(begin()); }
+  const_reverse_iterator rbegin() const {
+    return const_reverse_iterator(end());
+  }
+  const_reverse_iterator rend() const {
+    return const_reverse_iterator(begin());
+  }
+  const_iterator cbegin() const { return begin(); }
+  const_iterator cend() const { return end(); }
+  const_reverse_iterator crbegin() const { return rbegin(); }
+  const_reverse_iterator crend() const { return rend(); }
+
+  bool empty() const { return keys.empty(); }
+  size_type size() const { return keys.size(); }
+  size_type max_size() const { return keys.max_size(); }
+  size_type capacity() const { return keys.capacity(); }
+  void reserve(size_type n) {
+    keys.reserve(n);
+    vals.reserve(n);
+  }
+
+  T& operator[](const key_type& k) {
+    size_type i = lower_index(k);
+    if (i == size() || comp(k, keys[i]))
+      insert_at(i, k, T());
+    return vals[i];
+  }
+  void swap(flat_map& x) {
+    keys.swap(x.keys);
+    vals.swap(x.vals);
+    Compare tmp = comp;
+    comp = x.comp;
+    x.comp = tmp;
+  }
+  // 插入
+  pair<iterator, bool> insert(const value_type& x) {
+    size_type i = lower_index(x.first);
+    if (i != size() && !comp(x.first, keys[i]))
+      return pair<iterator, bool>(make_iter(i), false);
+    return pair<iterator, bool>(insert_at(i, x.first, x.second), true);
+  }
+  // x恰好应位于pos之前时不需要查找
+  iterator insert(iterator pos, const value_type& x) {
+    size_type i = index_of(pos);
+    if ((i == 0 || comp(keys[i - 1], x.first)) &&
+        (i == size() || comp(x.first, keys[i])))
+      return insert_at(i, x.first, x.second);
+    return insert(x).first;
+  }
+  // 批量插入：排序后与现有元素一次归并，O(n + k log k)
+  template <class InputIter>
+  void insert(InputIter first, InputIter last) {
+    insert_range(first, last, false);
+  }
+  template <class InputIter>
+  void insert(sorted_unique_t, InputIter first, InputIter last) {
+    insert_range(first, last, true);
+  }
+  // 删除
+  iterator erase(iterator pos) {
+    size_type i = index_of(pos);
+    keys.erase(keys.begin() + i);
+    vals.erase(vals.begin() + i);
+    return make_iter(i);
+  }
+  size_type erase(const key_type& k) {
+    iterator it = find(k);
+    if (it == end())
+      return 0;
+    erase(it);
+    return 1;
+  }
+  iterator erase(iterator first, iterator last) {
+    size_type i = index_of(first);
+    size_type j = index_of(last);
+    keys.erase(keys.begin() + i, keys.begin() + j);
+    vals.erase(vals.begin() + i, vals.begin() + j);
+    return make_iter(i);
+  }
+  void clear() {
+    keys.clear();
+    vals.clear();
+  }
+  // 查找
+  iterator find(const key_type& k) {
+    size_type i = lower_index(k);
+    return (i == size() || comp(k, keys[i])) ? end() : make_iter(i);
+  }
+  const_iterator find(const key_type& k) const {
+    size_type i = lower_index(k);
+    return (i == size() || comp(k, keys[i])) ? end() : make_iter(i);
+  }
+  size_type count(const key_type& k) const { return find(k) == end() ? 0 : 1; }
+  iterator lower_bound(const key_type& k) { return make_iter(lower_index(k)); }
+  const_iterator lower_bound(const key_type& k) const {
+    return make_iter(lower_index(k));
+  }
+  iterator upper_bound(const key_type& k) {
+    return make_iter(_flat_upper_bound(keys.begin(), keys.end(), k, comp) -
+                     keys.begin());
+  }
+  const_iterator upper_bound(const key_type& k) const {
+    return make_iter(_flat_upper_bound(keys.begin(), keys.end(), k, comp) -
+                     keys.begin());
+  }
+  pair<iterator, iterator> equal_range(const key_type& k) {
+    return pair<iterator, iterator>(lower_bound(k), upper_bound(k));
+  }
+  pair<const_iterator, const_iterator> equal_range(const key_type& k) const {
+    return pair<const_iterator, const_iterator>(lower_bound(k),
+                                                upper_bound(k));
+  }
+
+  friend bool operator==(const flat_map& x, const flat_map& y) {
+    return x.keys == y.keys && x.vals == y.vals;
+  }
+};
+
+template <class Key, class T, class Compare, class Alloc>
+template <class InputIter>
+void flat_map<Key, T, Compare, Alloc>::insert_range(InputIter first,
+                                                    InputIter last,
+                                                    bool sorted) {
+  vector<Key, Alloc> bk;
+  vector<T, Alloc> bv;
+  for (; first != last; ++first) {
+    bk.push_back((*first).first);
+    bv.push_back((*first).second);
+  }
+  vector<size_t, Alloc> idx;
+  idx.reserve(bk.size());
+  for (size_t i = 0; i < bk.size(); ++i)
+    idx.push_back(i);
+  if (!sorted)
+    _flat_sort_index(idx, bk.begin(), comp);
+  merge_batch(bk, bv, idx);
+}
+
+template <class Key, class T, class Compare, class Alloc>
+void flat_map<Key, T, Compare, Alloc>::merge_batch(
+    const vector<Key, Alloc>& bk,
+    const vector<T, Alloc>& bv,
+    const vector<size_t, Alloc>& idx) {
+  const size_type n = idx.size();
+  if (n == 0)
+    return;
+  const size_type m = size();
+  vector<Key, Alloc> nk;
+  vector<T, Alloc> nv;
+  nk.reserve(m + n);
+  nv.reserve(m + n);
+  size_type i = 0, j = 0;
+  while (i < m || j < n) {
+    // 键相同时先取已有元素，随后的重复键被跳过，与map::insert的语义一致
+    bool take_old =
+        j == n || (i < m && !comp(bk[idx[j]], keys[i]));
+    const Key& k = take_old ? keys[i] : bk[idx[j]];
+    if (nk.empty() || comp(nk.back(), k)) {
+      nk.push_back(k);
+      nv.push_back(take_old ? vals[i] : bv[idx[j]]);
+    }
+    if (take_old)
+      ++i;
+    else
+      ++j;
+  }
+  keys.swap(nk);
+  vals.swap(nv);
+}
+
+_MINISTL_END
+
+#endif
@@ -0,0 +1,218 @@
+#ifndef MINISTL_FLAT_SET_H
+#define MINISTL_FLAT_SET_H
+
+#include "../configurator/allocator.hpp"
+#include "../functor/functor.hpp"
+#include "../iterator/iterator.hpp"
+#include "../utils/util.hpp"
+#include "flat_tree.hpp"
+#include "stl_vector.hpp"
+
+_MINISTL_BEGIN
+
+// flat_set：以有序vector保存键的集合，接口与set相同
+// 查找为连续内存上的二分，插入删除为O(n)，适合以查询为主的静态数据
+template <class Key, class Compare = std::less<Key>, class Alloc = alloc>
+class flat_set {
+ public:
+  typedef Key key_type;
+  typedef Key value_type;
+  typedef Compare key_compare;
+  typedef Compare value_compare;
+
+ private:
+  typedef vector<Key, Alloc> rep_type;
+  rep_type keys;  // 有序且不重复
+  Compare comp;
+
+ public:
+  // 与set相同，元素不可经由迭代器修改
+  typedef const Key* pointer;
+  typedef const Key* const_pointer;
+  typedef const Key& reference;
+  typedef const Key& const_reference;
+  typedef const Key* iterator;
+  typedef const Key* const_iterator;
+  typedef ministl::reverse_iterator<const_iterator> reverse_iterator;
+  typedef ministl::reverse_iterator<const_iterator> const_reverse_iterator;
+  typedef size_t size_type;
+  typedef ptrdiff_t difference_type;
+
+ private:
+  size_type lower_index(const key_type& k) const {
+    return _flat_lower_bound(keys.begin(), keys.end(), k, comp) -
+           keys.begin();
+  }
+  typename rep_type::iterator mutable_iter(iterator pos) {
+    return keys.begin() + (pos - keys.begin());
+  }
+  void merge_batch(const rep_type& bk, const vector<size_t, Alloc>& idx);
+  template <class InputIter>
+  void insert_range(InputIter first, InputIter last, bool sorted);
+
+ public:
+  flat_set() : comp(Compare()) {}
+  explicit flat_set(const Compare& c) : comp(c) {}
+
+  template <class InputIter>
+  flat_set(InputIter first, InputIter last) : comp(Compare()) {
+    insert_range(first, last, false);
+  }
+  template <class InputIter>
+  flat_set(InputIter first, InputIter last, const Compare& c) : comp(c) {
+    insert_range(first, last, false);
+  }
+  // 输入已严格递增时不再排序
+  template <class InputIter>
+  flat_set(sorted_unique_t, InputIter first, InputIter last)
+      : comp(Compare()) {
+    insert_range(first, last, true);
+  }
+  template <class InputIter>
+  flat_set(sorted_unique_t,
+           InputIter first,
+           InputIter last,
+           const Compare& c)
+      : comp(c) {
+    insert_range(first, last, true);
+  }
+
+  flat_set(const flat_set& x) : keys(x.keys), comp(x.comp) {}
+  flat_set& operator=(const flat_set& x) {
+    keys = x.keys;
+    comp = x.comp;
+    return *this;
+  }
+
+  // accessors
+  key_compare key_comp() const { return comp; }
+  value_compare value_comp() const { return comp; }
+  iterator begin() const { return keys.begin(); }
+  iterator end() const { return keys.end(); }
+  reverse_iterator rbegin() const { return reverse_iterator(end()); }
+  reverse_iterator rend() const { return reverse_iterator(begin()); }
+  const_iterator cbegin() const { return begin(); }
+  const_iterator cend() const { return end(); }
+  bool empty() const { return keys.empty(); }
+  size_type size() const { return keys.size(); }
+  size_type max_size() const { return keys.max_size(); }
+  size_type capacity() const { return keys.capacity(); }
+  void reserve(size_type n) { keys.reserve(n); }
+  void swap(flat_set& x) {
+    keys.swap(x.keys);
+    Compare tmp = comp;
+    comp = x.comp;
+    x.comp = tmp;
+  }
+
+  // insert/erase
+  pair<iterator, bool> insert(const value_type& x) {
+    size_type i = lower_index(x);
+    if (i != size() && !comp(x, keys[i]))
+      return pair<iterator, bool>(begin() + i, false);
+    keys.insert(keys.begin() + i, x);
+    return pair<iterator, bool>(begin() + i, true);
+  }
+  // x恰好应位于position之前时不需要查找
+  iterator insert(iterator position, const value_type& x) {
+    size_type i = position - begin();
+    if ((i == 0 || comp(keys[i - 1], x)) &&
+        (i == size() || comp(x, keys[i]))) {
+      keys.insert(keys.begin() + i, x);
+      return begin() + i;
+    }
+    return insert(x).first;
+  }
+  // 批量插入：排序后与现有元素一次归并
+  template <class InputIter>
+  void insert(InputIter first, InputIter last) {
+    insert_range(first, last, false);
+  }
+  template <class InputIter>
+  void insert(sorted_unique_t, InputIter first, InputIter last) {
+    insert_range(first, last, true);
+  }
+  iterator erase(iterator position) {
+    return keys.erase(mutable_iter(position));
+  }
+  size_type erase(const key_type& x) {
+    iterator it = find(x);
+    if (it == end())
+      return 0;
+    erase(it);
+    return 1;
+  }
+  iterator erase(iterator first, iterator last) {
+    return keys.erase(mutable_iter(first), mutable_iter(last));
+  }
+  void clear() { keys.clear(); }
+
+  // set operations:
+  iterator find(const key_type& x) const {
+    size_type i = lower_index(x);
+    return (i == size() || comp(x, keys[i])) ? end() : begin() + i;
+  }
+  size_type count(const key_type& x) const { return find(x) == end() ? 0 : 1; }
+  iterator lower_bound(const key_type& x) const {
+    return _flat_lower_bound(keys.begin(), keys.end(), x, comp);
+  }
+  iterator upper_bound(const key_type& x) const {
+    return _flat_upper_bound(keys.begin(), keys.end(), x, comp);
+  }
+  pair<iterator, iterator> equal_range(const key_type& x) const {
+    return pair<iterator, iterator>(lower_bound(x), upper_bound(x));
+  }
+
+  friend bool operator==(const flat_set& x, const flat_set& y) {
+    return x.keys == y.keys;
+  }
+  friend bool operator<(const flat_set& x, const flat_set& y) {
+    return x.keys < y.keys;
+  }
+};
+
+template <class Key, class Compare, class Alloc>
+template <class InputIter>
+void flat_set<Key, Compare, Alloc>::insert_range(InputIter first,
+                                                 InputIter last,
+                                                 bool sorted) {
+  rep_type bk;
+  for (; first != last; ++first)
+    bk.push_back(*first);
+  vector<size_t, Alloc> idx;
+  idx.reserve(bk.size());
+  for (size_t i = 0; i < bk.size(); ++i)
+    idx.push_back(i);
+  if (!sorted)
+    _flat_sort_index(idx, bk.begin(), comp);
+  merge_batch(bk, idx);
+}
+
+// 将idx所列的批量元素与现有元素归并，重复的键只保留先出现的一个
+template <class Key, class Compare, class Alloc>
+void flat_set<Key, Compare, Alloc>::merge_batch(
+    const rep_type& bk,
+    const vector<size_t, Alloc>& idx) {
+  const size_type n = idx.size();
+  if (n == 0)
+    return;
+  const size_type m = size();
+  rep_type nk;
+  nk.reserve(m + n);
+  size_type i = 0, j = 0;
+  while (i < m || j < n) {
+    bool take_old = j == n || (i < m && !comp(bk[idx[j]], keys[i]));
+    const Key& k = take_old ? keys[i] : bk[idx[j]];
+    if (nk.empty() || comp(nk.back(), k))
+      nk.push_back(k);
+    if (take_old)
+      ++i;
+    else
+      ++j;
+  }
+  keys.swap(nk);
+}
+
+_MINISTL_END
+
+#endif
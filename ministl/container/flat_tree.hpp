@@ -0,0 +1,78 @@
+#ifndef MINISTL_FLAT_TREE_H
+#define MINISTL_FLAT_TREE_H
+
+#include "../algorithm/stl_algorithm.hpp"
+#include "../iterator/iterator.hpp"
+#include "../utils/util.hpp"
+#include "stl_vector.hpp"
+
+_MINISTL_BEGIN
+
+// flat_map / flat_set 的公共部分：以有序vector保存键值
+
+// operator-> 的代理：迭代器解引用得到的是临时的pair引用
+template <class Ref>
+struct _flat_map_arrow {
+  Ref ref;
+  _flat_map_arrow(const Ref& r) : ref(r) {}
+  Ref* operator->() { return &ref; }
+};
+
+// 按keys[idx[i]]对下标数组做稳定的自底向上归并排序
+// 批量插入时先排下标，键与值只在最后合并时搬动一次
+template <class Key, class Compare, class Alloc>
+void _flat_sort_index(vector<size_t, Alloc>& idx,
+                      const Key* keys,
+                      Compare comp) {
+  const size_t n = idx.size();
+  if (n < 2)
+    return;
+  vector<size_t, Alloc> buf(n, 0);
+  size_t* a = idx.begin();
+  size_t* tmp = buf.begin();
+  for (size_t width = 1; width < n; width *= 2) {
+    for (size_t lo = 0; lo < n; lo += 2 * width) {
+      size_t mid = lo + width < n ? lo + width : n;
+      size_t hi = lo + 2 * width < n ? lo + 2 * width : n;
+      size_t i = lo, j = mid, k = lo;
+      while (i < mid && j < hi) {
+        // 只有右侧严格小于左侧时才取右侧，保证稳定
+        if (comp(keys[a[j]], keys[a[i]]))
+          tmp[k++] = a[j++];
+        else
+          tmp[k++] = a[i++];
+      }
+      while (i < mid)
+        tmp[k++] = a[i++];
+      while (j < hi)
+        tmp[k++] = a[j++];
+    }
+    size_t* t = a;
+    a = tmp;
+    tmp = t;
+  }
+  if (a != idx.begin())
+    idx.swap(buf);
+}
+
+// 在有序数组[first, last)中二分查找，复用algo.hpp中的_lower_bound/_upper_bound
+template <class Key, class K, class Compare>
+inline const Key* _flat_lower_bound(const Key* first,
+                                    const Key* last,
+                                    const K& k,
+                                    Compare comp) {
+  return _lower_bound(first, last, k, comp, ptrdiff_t(0),
+                      random_access_iterator_tag());
+}
+template <class Key, class K, class Compare>
+inline const Key* _flat_upper_bound(const Key* first,
+                                    const Key* last,
+                                    const K& k,
+                                    Compare comp) {
+  return _upper_bound(first, last, k, comp, ptrdiff_t(0),
+                      random_access_iterator_tag());
+}
+
+_MINISTL_END
+
+#endif
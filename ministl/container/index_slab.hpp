@@ -0,0 +1,112 @@
+#ifndef MINISTL_INDEX_SLAB_H
+#define MINISTL_INDEX_SLAB_H
+
+#include <cstdint>
+
+#include "../configurator/allocator.hpp"
+#include "../utils/exceptdef.hpp"
+#include "../utils/util.hpp"
+
+_MINISTL_BEGIN
+
+// compact_list / compact_set / compact_map 的节点存储
+// 节点之间以32位下标而非指针链接，64位平台上每条链接省下4字节
+// 下标经_index_slab换算为地址：节点存于若干块中，第c块有2^(c+3)个节点，
+// 块按需配置且不再移动，元素的地址在其被删除之前保持不变
+
+typedef uint32_t _index_type;
+
+// x的前导0个数，x不为0
+inline unsigned _index_clz(_index_type x) {
+#if defined(__GNUC__) || defined(__clang__)
+  return __builtin_clz(x);
+#else
+  unsigned r = 31;
+  while (x >>= 1)
+    --r;
+  return r;
+#endif
+}
+
+// Node须为标准布局且以一个_index_type成员开头，空闲的节点借它串成链表
+template <class Node, class Alloc>
+class _index_slab {
+ public:
+  typedef _index_type index_type;
+  static const unsigned first_bits = 3;  // 第0块的节点数为2^first_bits
+  static const unsigned max_chunks = 32 - first_bits;
+
+ private:
+  typedef allocator<Node, Alloc> node_allocator;
+  // 下标i的节点位于base[clz(j)] + j * sizeof(Node)，j = i + 2^first_bits；
+  // 同一块中的j前导0个数相同，base即该块的地址减去块内第一个j的偏移，
+  // 换算只需一次clz与一次查表
+  uintptr_t base[max_chunks];
+  unsigned nchunks;
+  index_type used;       // 已分出过的下标数，其后的下标尚未使用
+  index_type free_head;  // 释放后待重用的下标，0表示没有
+
+  static size_t chunk_size(unsigned c) { return size_t(1) << (c + first_bits); }
+  static unsigned slot(unsigned c) { return max_chunks - 1 - c; }
+  Node* chunk(unsigned c) const {
+    return reinterpret_cast<Node*>(base[slot(c)] +
+                                   chunk_size(c) * sizeof(Node));
+  }
+
+  _index_slab(const _index_slab&);
+  _index_slab& operator=(const _index_slab&);
+
+ public:
+  _index_slab() : base(), nchunks(0), used(0), free_head(0) {}
+  ~_index_slab() { release(); }
+
+  Node& operator[](index_type i) const {
+    index_type j = i + (index_type(1) << first_bits);
+    return *reinterpret_cast<Node*>(base[_index_clz(j)] + j * sizeof(Node));
+  }
+
+  // 取一个未构造的节点；下标0总是最先分出，容器以它作header
+  index_type allocate(index_type limit) {
+    if (free_head != 0) {
+      index_type i = free_head;
+      free_head = *reinterpret_cast<index_type*>(&(*this)[i]);
+      return i;
+    }
+    THROW_LENGTH_ERROR_IF(used >= limit, "too many nodes");
+    if (used == chunk_size(nchunks) - chunk_size(0)) {  // 已有的块都已分完
+      Node* p = node_allocator::allocate(chunk_size(nchunks));
+      base[slot(nchunks)] =
+          reinterpret_cast<uintptr_t>(p) - chunk_size(nchunks) * sizeof(Node);
+      ++nchunks;
+    }
+    return used++;
+  }
+  void deallocate(index_type i) {
+    *reinterpret_cast<index_type*>(&(*this)[i]) = free_head;
+    free_head = i;
+  }
+
+  // 除下标0以外都作废，保留已配置的块
+  void reset() {
+    used = used == 0 ? 0 : 1;
+    free_head = 0;
+  }
+  void release() {
+    for (unsigned c = 0; c < nchunks; ++c)
+      node_allocator::deallocate(chunk(c), chunk_size(c));
+    nchunks = 0;
+    used = 0;
+    free_head = 0;
+  }
+  void swap(_index_slab& x) {
+    for (unsigned k = 0; k < max_chunks; ++k)
+      std::swap(base[k], x.base[k]);
+    std::swap(nchunks, x.nchunks);
+    std::swap(used, x.used);
+    std::swap(free_head, x.free_head);
+  }
+};
+
+_MINISTL_END
+
+#endif
\ No newline at end of file
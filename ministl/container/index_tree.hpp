@@ -0,0 +1,569 @@
+#ifndef MINISTL_INDEX_TREE_H
+#define MINISTL_INDEX_TREE_H
+
+#include "../algorithm/algobase.hpp"
+#include "../configurator/allocator.hpp"
+#include "../configurator/construct.hpp"
+#include "../iterator/iterator.hpp"
+#include "../utils/util.hpp"
+#include "index_slab.hpp"
+#include "rb_tree.hpp"
+
+_MINISTL_BEGIN
+
+// 以32位下标链接的红黑树，供compact_set / compact_map使用
+// 平衡与rb_tree共用_rb_tree_generic_*，节点只有三个下标：set<int>的节点为16字节，
+// rb_tree则为40字节（紧凑模式下32字节）
+// 下标0为header：其parent为根，left/right为最左/最右节点；
+// 子节点为0表示没有，父节点为0表示是根
+
+template <class Value>
+struct _index_tree_node {
+  _index_type left;  // 须为第一个成员，见_index_slab
+  _index_type right;
+  _index_type parent;  // 最高位为颜色，置位为黑
+  alignas(Value) unsigned char storage[sizeof(Value)];
+
+  Value& value() { return *reinterpret_cast<Value*>(storage); }
+};
+
+template <class Value, class Ref, class Ptr, class Tree>
+struct _index_tree_iterator {
+  typedef _index_tree_iterator<Value, Value&, Value*, Tree> iterator;
+  typedef _index_tree_iterator<Value, const Value&, const Value*, Tree>
+      const_iterator;
+  typedef _index_tree_iterator<Value, Ref, Ptr, Tree> self;
+
+  typedef bidirectional_iterator_tag iterator_category;
+  typedef Value value_type;
+  typedef Ref reference;
+  typedef Ptr pointer;
+  typedef ptrdiff_t difference_type;
+
+  const Tree* t;
+  _index_type node;  // 0为end()
+
+  _index_tree_iterator() : t(0), node(0) {}
+  _index_tree_iterator(const Tree* tp, _index_type x) : t(tp), node(x) {}
+  _index_tree_iterator(const iterator& it) : t(it.t), node(it.node) {}
+
+  reference operator*() const { return t->_value(node); }
+  pointer operator->() const { return &(operator*()); }
+
+  self& operator++() {
+    node = t->_next(node);
+    return *this;
+  }
+  self operator++(int) {
+    self tmp = *this;
+    ++*this;
+    return tmp;
+  }
+  self& operator--() {
+    node = t->_prev(node);
+    return *this;
+  }
+  self operator--(int) {
+    self tmp = *this;
+    --*this;
+    return tmp;
+  }
+
+  bool operator==(const self& x) const { return node == x.node; }
+  bool operator!=(const self& x) const { return node != x.node; }
+};
+
+template <class Key,
+          class Value,
+          class KeyOfValue,
+          class Compare,
+          class Alloc = alloc>
+class index_rb_tree {
+ public:
+  typedef Key key_type;
+  typedef Value value_type;
+  typedef value_type* pointer;
+  typedef const value_type* const_pointer;
+  typedef value_type& reference;
+  typedef const value_type& const_reference;
+  typedef size_t size_type;
+  typedef ptrdiff_t difference_type;
+  typedef _index_tree_iterator<Value, Value&, Value*, index_rb_tree> iterator;
+  typedef _index_tree_iterator<Value, const Value&, const Value*, index_rb_tree>
+      const_iterator;
+  typedef ministl::reverse_iterator<iterator> reverse_iterator;
+  typedef ministl::reverse_iterator<const_iterator> const_reverse_iterator;
+
+ private:
+  template <class, class, class, class>
+  friend struct _index_tree_iterator;
+
+  typedef _index_type index_type;
+  typedef _index_tree_node<Value> node;
+  static const index_type color_bit = index_type(1) << 31;
+  static const index_type max_nodes = color_bit - 1;  // 最高位留给颜色
+
+  _index_slab<node, Alloc> slab;
+  size_type node_count;
+  Compare key_compare;
+
+  node& N(index_type x) const { return slab[x]; }
+  index_type& left(index_type x) const { return N(x).left; }
+  index_type& right(index_type x) const { return N(x).right; }
+  index_type parent(index_type x) const { return N(x).parent & ~color_bit; }
+  void set_parent(index_type x, index_type p) const {
+    N(x).parent = (N(x).parent & color_bit) | p;
+  }
+  // 0视为黑色的空节点
+  bool is_red(index_type x) const {
+    return x != 0 && !(N(x).parent & color_bit);
+  }
+  void set_red(index_type x) const { N(x).parent &= ~color_bit; }
+  void set_black(index_type x) const { N(x).parent |= color_bit; }
+  index_type root() const { return N(0).parent; }  // header恒为红
+  void set_root(index_type x) const { N(0).parent = x; }
+  index_type leftmost() const { return N(0).left; }
+  index_type rightmost() const { return N(0).right; }
+  Value& _value(index_type x) const { return N(x).value(); }
+  const Key& key(index_type x) const { return KeyOfValue()(N(x).value()); }
+
+  index_type minimum(index_type x) const {
+    while (left(x) != 0)
+      x = left(x);
+    return x;
+  }
+  index_type maximum(index_type x) const {
+    while (right(x) != 0)
+      x = right(x);
+    return x;
+  }
+  // 中序的后继与前驱，0为end()
+  index_type _next(index_type x) const {
+    if (right(x) != 0)
+      return minimum(right(x));
+    index_type y = parent(x);
+    while (y != 0 && x == right(y)) {
+      x = y;
+      y = parent(y);
+    }
+    return y;
+  }
+  index_type _prev(index_type x) const {
+    if (x == 0)
+      return rightmost();
+    if (left(x) != 0)
+      return maximum(left(x));
+    index_type y = parent(x);
+    while (y != 0 && x == left(y)) {
+      x = y;
+      y = parent(y);
+    }
+    return y;
+  }
+
+  void init() {
+    index_type h = slab.allocate(max_nodes);  // 必为0
+    left(h) = 0;
+    right(h) = 0;
+    N(h).parent = 0;
+  }
+  template <class... Args>
+  index_type create_node(Args&&... args) {
+    index_type z = slab.allocate(max_nodes);
+    try {
+      construct(&N(z).value(), std::forward<Args>(args)...);
+    } catch (...) {
+      slab.deallocate(z);
+      throw;
+    }
+    return z;
+  }
+  index_type clone_node(const index_rb_tree& t, index_type x) {
+    index_type z = create_node(t._value(x));
+    left(z) = 0;
+    right(z) = 0;
+    N(z).parent = t.N(x).parent & color_bit;
+    return z;
+  }
+  void destroy_node(index_type x) {
+    destroy(&N(x).value());
+    slab.deallocate(x);
+  }
+
+  iterator _insert(index_type y, const value_type& v, bool to_left) {
+    return _link(y, create_node(v), to_left);
+  }
+  iterator _link(index_type y, index_type z, bool to_left);
+  // k不存在时返回(插入位置的父节点, true)，否则返回(键值为k的节点, false)
+  pair<index_type, bool> _unique_pos(const key_type& k) const;
+  index_type _copy(const index_rb_tree& t, index_type x, index_type p);
+  void _erase(index_type x);
+
+  // 以下标实现的链接操作，供rb_tree.hpp中的平衡算法使用
+  struct _links {
+    typedef index_type link;
+    const index_rb_tree* t;
+
+    explicit _links(const index_rb_tree* tp) : t(tp) {}
+    link root() const { return t->root(); }
+    void set_root(link x) const { t->set_root(x); }
+    link& left(link x) const { return t->left(x); }
+    link& right(link x) const { return t->right(x); }
+    link parent(link x) const { return t->parent(x); }
+    void set_parent(link x, link p) const { t->set_parent(x, p); }
+    bool is_red(link x) const { return t->is_red(x); }
+    void set_red(link x) const { t->set_red(x); }
+    void set_black(link x) const { t->set_black(x); }
+    void swap_color(link x, link y) const {
+      index_type& px = t->N(x).parent;
+      index_type& py = t->N(y).parent;
+      index_type c = px & color_bit;
+      px = (px & ~color_bit) | (py & color_bit);
+      py = (py & ~color_bit) | c;
+    }
+    void copy_color(link x, link y) const {
+      index_type& px = t->N(x).parent;
+      px = (px & ~color_bit) | (t->N(y).parent & color_bit);
+    }
+    link minimum(link x) const { return t->minimum(x); }
+    link maximum(link x) const { return t->maximum(x); }
+    static void update(link) {}
+    static void erasing(link) {}
+    static void erased(link) {}
+  };
+
+ public:
+  explicit index_rb_tree(const Compare& comp = Compare())
+      : node_count(0), key_compare(comp) {
+    init();
+  }
+  index_rb_tree(const index_rb_tree& x)
+      : node_count(0), key_compare(x.key_compare) {
+    init();
+    *this = x;
+  }
+  // 被移动的树仍持有一个空header
+  index_rb_tree(index_rb_tree&& x)
+      : node_count(0), key_compare(x.key_compare) {
+    init();
+    swap(x);
+  }
+  ~index_rb_tree() { clear(); }
+  index_rb_tree& operator=(const index_rb_tree& x);
+  index_rb_tree& operator=(index_rb_tree&& x) {
+    swap(x);
+    return *this;
+  }
+
+  Compare key_comp() const { return key_compare; }
+  iterator begin() { return iterator(this, leftmost()); }
+  const_iterator begin() const { return const_iterator(this, leftmost()); }
+  iterator end() { return iterator(this, 0); }
+  const_iterator end() const { return const_iterator(this, 0); }
+  reverse_iterator rbegin() { return reverse_iterator(end()); }
+  const_reverse_iterator rbegin() const {
+    return const_reverse_iterator(end());
+  }
+  reverse_iterator rend() { return reverse_iterator(begin()); }
+  const_reverse_iterator rend() const {
+    return const_reverse_iterator(begin());
+  }
+  bool empty() const { return node_count == 0; }
+  size_type size() const { return node_count; }
+  size_type max_size() const { return max_nodes - 1; }
+  // 迭代器记有所属的树，交换与移动后原有的迭代器失效
+  void swap(index_rb_tree& x) {
+    slab.swap(x.slab);
+    std::swap(node_count, x.node_count);
+    std::swap(key_compare, x.key_compare);
+  }
+
+  pair<iterator, bool> insert_unique(const value_type& v);
+  // 先以k查找，只在k不存在时才以args构造节点，k须等于所构造元素的键值
+  template <class... Args>
+  pair<iterator, bool> try_emplace_unique(const key_type& k, Args&&... args) {
+    pair<index_type, bool> p = _unique_pos(k);
+    if (!p.second)
+      return pair<iterator, bool>(iterator(this, p.first), false);
+    bool to_left = p.first == 0 || key_compare(k, key(p.first));
+    index_type z = create_node(std::forward<Args>(args)...);
+    return pair<iterator, bool>(_link(p.first, z, to_left), true);
+  }
+  iterator insert_equal(const value_type& v);
+  template <class InputIter>
+  void insert_unique(InputIter first, InputIter last) {
+    for (; first != last; ++first)
+      insert_unique(*first);
+  }
+  template <class InputIter>
+  void insert_equal(InputIter first, InputIter last) {
+    for (; first != last; ++first)
+      insert_equal(*first);
+  }
+
+  void erase(const_iterator pos) {
+    destroy_node(_rb_tree_generic_rebalance_for_erase(_links(this), pos.node,
+                                                      left(0), right(0)));
+    --node_count;
+  }
+  size_type erase(const key_type& k) {
+    pair<iterator, iterator> p = equal_range(k);
+    size_type n = 0;
+    while (p.first != p.second) {
+      erase(p.first++);
+      ++n;
+    }
+    return n;
+  }
+  void erase(const_iterator first, const_iterator last) {
+    if (first == begin() && last == end())
+      clear();
+    else
+      while (first != last)
+        erase(first++);
+  }
+  // 元素无需析构时不必遍历，O(1)；下标全部作废，块留待重用
+  void clear() {
+    if (node_count != 0 && !std::is_trivially_destructible<Value>::value)
+      _erase(root());
+    slab.reset();
+    left(0) = 0;
+    right(0) = 0;
+    N(0).parent = 0;
+    node_count = 0;
+  }
+
+  iterator find(const key_type& k) {
+    iterator j = lower_bound(k);
+    return (j == end() || key_compare(k, key(j.node))) ? end() : j;
+  }
+  const_iterator find(const key_type& k) const {
+    const_iterator j = lower_bound(k);
+    return (j == end() || key_compare(k, key(j.node))) ? end() : j;
+  }
+  size_type count(const key_type& k) const {
+    size_type n = 0;
+    for (const_iterator it = lower_bound(k), last = upper_bound(k);
+         it != last; ++it)
+      ++n;
+    return n;
+  }
+  iterator lower_bound(const key_type& k) {
+    return iterator(this, _lower_bound(k));
+  }
+  const_iterator lower_bound(const key_type& k) const {
+    return const_iterator(this, _lower_bound(k));
+  }
+  iterator upper_bound(const key_type& k) {
+    return iterator(this, _upper_bound(k));
+  }
+  const_iterator upper_bound(const key_type& k) const {
+    return const_iterator(this, _upper_bound(k));
+  }
+  pair<iterator, iterator> equal_range(const key_type& k) {
+    return pair<iterator, iterator>(lower_bound(k), upper_bound(k));
+  }
+  pair<const_iterator, const_iterator> equal_range(const key_type& k) const {
+    return pair<const_iterator, const_iterator>(lower_bound(k),
+                                                upper_bound(k));
+  }
+
+  friend bool operator==(const index_rb_tree& x, const index_rb_tree& y) {
+    return x.size() == y.size() && ministl::equal(x.begin(), x.end(), y.begin());
+  }
+  friend bool operator<(const index_rb_tree& x, const index_rb_tree& y) {
+    return ministl::lexicographical_compare(x.begin(), x.end(), y.begin(),
+                                            y.end());
+  }
+
+ private:
+  // 每层只换算一次节点地址
+  index_type _lower_bound(const key_type& k) const {
+    index_type y = 0, x = root();
+    while (x != 0) {
+      node& n = N(x);
+      if (!key_compare(KeyOfValue()(n.value()), k))
+        y = x, x = n.left;
+      else
+        x = n.right;
+    }
+    return y;
+  }
+  index_type _upper_bound(const key_type& k) const {
+    index_type y = 0, x = root();
+    while (x != 0) {
+      node& n = N(x);
+      if (key_compare(k, KeyOfValue()(n.value())))
+        y = x, x = n.left;
+      else
+        x = n.right;
+    }
+    return y;
+  }
+};
+
+template <class Key,
+          class Value,
+          class KeyOfValue,
+          class Compare,
+          class Alloc>
+index_rb_tree<Key, Value, KeyOfValue, Compare, Alloc>&
+index_rb_tree<Key, Value, KeyOfValue, Compare, Alloc>::operator=(
+    const index_rb_tree& x) {
+  if (this != &x) {
+    clear();  // 保留已配置的块，复制时不再配置
+    key_compare = x.key_compare;
+    if (x.root() != 0) {
+      set_root(_copy(x, x.root(), 0));
+      left(0) = minimum(root());
+      right(0) = maximum(root());
+      node_count = x.node_count;
+    }
+  }
+  return *this;
+}
+
+// 复制以x为根的子树，挂在p之下；右子树递归，左子树循环
+template <class Key,
+          class Value,
+          class KeyOfValue,
+          class Compare,
+          class Alloc>
+_index_type index_rb_tree<Key, Value, KeyOfValue, Compare, Alloc>::_copy(
+    const index_rb_tree& t,
+    index_type x,
+    index_type p) {
+  index_type top = clone_node(t, x);
+  set_parent(top, p);
+  try {
+    if (t.right(x) != 0)
+      right(top) = _copy(t, t.right(x), top);
+    p = top;
+    x = t.left(x);
+    while (x != 0) {
+      index_type y = clone_node(t, x);
+      left(p) = y;
+      set_parent(y, p);
+      if (t.right(x) != 0)
+        right(y) = _copy(t, t.right(x), y);
+      p = y;
+      x = t.left(x);
+    }
+  } catch (...) {
+    _erase(top);
+    throw;
+  }
+  return top;
+}
+
+// 销毁以x为根的子树，不做平衡
+template <class Key,
+          class Value,
+          class KeyOfValue,
+          class Compare,
+          class Alloc>
+void index_rb_tree<Key, Value, KeyOfValue, Compare, Alloc>::_erase(
+    index_type x) {
+  while (x != 0) {
+    _erase(right(x));
+    index_type y = left(x);
+    destroy_node(x);
+    x = y;
+  }
+}
+
+template <class Key,
+          class Value,
+          class KeyOfValue,
+          class Compare,
+          class Alloc>
+pair<typename index_rb_tree<Key, Value, KeyOfValue, Compare, Alloc>::iterator,
+     bool>
+index_rb_tree<Key, Value, KeyOfValue, Compare, Alloc>::insert_unique(
+    const value_type& v) {
+  pair<index_type, bool> p = _unique_pos(KeyOfValue()(v));
+  if (!p.second)
+    return pair<iterator, bool>(iterator(this, p.first), false);
+  bool to_left = p.first == 0 || key_compare(KeyOfValue()(v), key(p.first));
+  return pair<iterator, bool>(_insert(p.first, v, to_left), true);
+}
+
+template <class Key,
+          class Value,
+          class KeyOfValue,
+          class Compare,
+          class Alloc>
+pair<_index_type, bool>
+index_rb_tree<Key, Value, KeyOfValue, Compare, Alloc>::_unique_pos(
+    const key_type& k) const {
+  index_type y = 0, x = root();
+  bool comp = true;
+  while (x != 0) {
+    y = x;
+    comp = key_compare(k, key(x));
+    x = comp ? left(x) : right(x);
+  }
+  index_type j = y;  // j为k的前驱
+  if (comp) {
+    if (y == leftmost())
+      return pair<index_type, bool>(y, true);
+    j = _prev(y);
+  }
+  if (key_compare(key(j), k))
+    return pair<index_type, bool>(y, true);
+  return pair<index_type, bool>(j, false);
+}
+
+template <class Key,
+          class Value,
+          class KeyOfValue,
+          class Compare,
+          class Alloc>
+typename index_rb_tree<Key, Value, KeyOfValue, Compare, Alloc>::iterator
+index_rb_tree<Key, Value, KeyOfValue, Compare, Alloc>::insert_equal(
+    const value_type& v) {
+  index_type y = 0, x = root();
+  bool comp = true;
+  while (x != 0) {
+    y = x;
+    comp = key_compare(KeyOfValue()(v), key(x));
+    x = comp ? left(x) : right(x);
+  }
+  return _insert(y, v, comp);
+}
+
+// 新节点z作为y的左（to_left）或右子节点
+template <class Key,
+          class Value,
+          class KeyOfValue,
+          class Compare,
+          class Alloc>
+typename index_rb_tree<Key, Value, KeyOfValue, Compare, Alloc>::iterator
+index_rb_tree<Key, Value, KeyOfValue, Compare, Alloc>::_link(
+    index_type y,
+    index_type z,
+    bool to_left) {
+  if (y == 0 || to_left) {
+    left(y) = z;  // y为header时即令leftmost为z
+    if (y == 0) {
+      set_root(z);
+      right(0) = z;
+    } else if (y == leftmost()) {
+      left(0) = z;
+    }
+  } else {
+    right(y) = z;
+    if (y == rightmost())
+      right(0) = z;
+  }
+  left(z) = 0;
+  right(z) = 0;
+  N(z).parent = y;  // 新节点为红
+  _rb_tree_generic_rebalance(_links(this), z);
+  ++node_count;
+  return iterator(this, z);
+}
+
+_MINISTL_END
+
+#endif
\ No newline at end of file
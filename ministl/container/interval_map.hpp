@@ -0,0 +1,241 @@
+#ifndef MINISTL_INTERVAL_MAP_H
+#define MINISTL_INTERVAL_MAP_H
+
+#include "../configurator/allocator.hpp"
+#include "../functor/functor.hpp"
+#include "../iterator/iterator.hpp"
+#include "../utils/util.hpp"
+#include "rb_tree.hpp"
+
+_MINISTL_BEGIN
+
+// 闭区间[low, high]，由调用者保证low不大于high
+template <class T>
+struct interval {
+  T low;
+  T high;
+  interval() : low(), high() {}
+  interval(const T& l, const T& h) : low(l), high(h) {}
+};
+
+// 区间先按low再按high排序
+template <class T, class Compare>
+struct _interval_less {
+  Compare comp;
+  _interval_less() {}
+  explicit _interval_less(const Compare& c) : comp(c) {}
+  bool operator()(const interval<T>& a, const interval<T>& b) const {
+    return comp(a.low, b.low) || (!comp(b.low, a.low) && comp(a.high, b.high));
+  }
+};
+
+// 另记录子树中所有区间high的最大值
+template <class T>
+struct _rb_tree_max_node_base : public _rb_tree_node_base {
+  T max_high;
+};
+// 维护子树的最大右端点，供区间查询剪枝；Compare须可以默认构造
+template <class T, class Value, class Compare>
+struct _interval_augment {
+  typedef _rb_tree_max_node_base<T> node_base;
+  typedef _rb_tree_node_base* base_ptr;
+  typedef _rb_tree_node<Value, node_base>* link_type;
+
+  static T& max_high(base_ptr x) { return ((node_base*)x)->max_high; }
+  static const T& high(base_ptr x) {
+    return ((link_type)x)->value_field.first.high;
+  }
+  static void update(base_ptr x) {
+    const T* m = &high(x);
+    if (x->left && Compare()(*m, max_high(x->left)))
+      m = &max_high(x->left);
+    if (x->right && Compare()(*m, max_high(x->right)))
+      m = &max_high(x->right);
+    max_high(x) = *m;
+  }
+  // 新叶节点的右端点沿祖先上推，遇到不小于它的祖先即停
+  static void inserted(base_ptr z, base_ptr root) {
+    max_high(z) = high(z);
+    for (; z != root; z = z->parent) {
+      if (!Compare()(max_high(z->parent), max_high(z)))
+        break;
+      max_high(z->parent) = max_high(z);
+    }
+  }
+  static void erasing(base_ptr, base_ptr) {}
+  // 摘下节点后从p到根逐个重新计算，p为header时树中已没有受影响的节点
+  static void erased(base_ptr p, base_ptr root) {
+    if (root == 0)
+      return;
+    for (base_ptr header = root->parent; p != header; p = p->parent)
+      update(p);
+  }
+};
+
+// 以区间为键值的有序multimap，同一区间可以出现多次
+// 节点附加子树的最大右端点，插入、删除与旋转时随红黑树的调整一起维护
+// 查询与[lo, hi]相交的区间时，跳过最大右端点小于lo的子树，
+// 以及low大于hi的节点的右子树，耗时O(log n + k·log(n/k))，k为结果个数
+template <class T,
+          class Mapped,
+          class Compare = std::less<T>,
+          class Alloc = alloc>
+class interval_map {
+ public:
+  typedef interval<T> key_type;
+  typedef Mapped mapped_type;
+  typedef pair<key_type, Mapped> value_type;
+  typedef _interval_less<T, Compare> key_compare;
+
+ private:
+  typedef _interval_augment<T, value_type, Compare> augment;
+  typedef rb_tree<key_type,
+                  value_type,
+                  select1st<value_type>,
+                  key_compare,
+                  Alloc,
+                  augment>
+      rep_type;
+  typedef typename augment::base_ptr base_ptr;
+  typedef typename augment::link_type link_type;
+  rep_type t;
+  Compare comp;
+
+ public:
+  typedef typename rep_type::pointer pointer;
+  typedef typename rep_type::const_pointer const_pointer;
+  typedef typename rep_type::reference reference;
+  typedef typename rep_type::const_reference const_reference;
+  typedef typename rep_type::iterator iterator;
+  typedef typename rep_type::const_iterator const_iterator;
+  typedef typename rep_type::reverse_iterator reverse_iterator;
+  typedef typename rep_type::const_reverse_iterator const_reverse_iterator;
+  typedef typename rep_type::size_type size_type;
+  typedef typename rep_type::difference_type difference_type;
+
+  interval_map() : t(key_compare()) {}
+  template <class InputIter>
+  interval_map(InputIter first, InputIter last) : t(key_compare()) {
+    insert(first, last);
+  }
+  // 输入已按区间非递减排列时O(n)建树
+  template <class ForwardIter>
+  interval_map(sorted_equivalent_t, ForwardIter first, ForwardIter last)
+      : t(key_compare()) {
+    t.insert_equal(sorted_equivalent, first, last);
+  }
+  interval_map(const interval_map& x) : t(x.t) {}
+  interval_map(interval_map&& x) : t(std::move(x.t)) {}
+  interval_map& operator=(const interval_map& x) {
+    t = x.t;
+    return *this;
+  }
+  interval_map& operator=(interval_map&& x) {
+    t = std::move(x.t);
+    return *this;
+  }
+
+  key_compare key_comp() const { return t.key_comp(); }
+  iterator begin() { return t.begin(); }
+  const_iterator begin() const { return t.begin(); }
+  iterator end() { return t.end(); }
+  const_iterator end() const { return t.end(); }
+  reverse_iterator rbegin() { return t.rbegin(); }
+  const_reverse_iterator rbegin() const { return t.rbegin(); }
+  reverse_iterator rend() { return t.rend(); }
+  const_reverse_iterator rend() const { return t.rend(); }
+  bool empty() const { return t.empty(); }
+  size_type size() const { return t.size(); }
+  size_type max_size() const { return t.max_size(); }
+  void swap(interval_map& x) { t.swap(x.t); }
+
+  // 插入，区间已存在时也插入
+  iterator insert(const value_type& x) { return t.insert_equal(x); }
+  iterator insert(const T& low, const T& high, const Mapped& m) {
+    return t.insert_equal(value_type(key_type(low, high), m));
+  }
+  template <class InputIter>
+  void insert(InputIter first, InputIter last) {
+    for (; first != last; ++first)
+      t.insert_equal(*first);
+  }
+  template <class ForwardIter>
+  void insert(sorted_equivalent_t, ForwardIter first, ForwardIter last) {
+    t.insert_equal(sorted_equivalent, first, last);
+  }
+  void erase(iterator pos) { t.erase(pos); }
+  size_type erase(const key_type& k) { return t.erase(k); }
+  void clear() { t.clear(); }
+
+  // 与区间k完全相同的元素
+  iterator find(const key_type& k) { return t.find(k); }
+  const_iterator find(const key_type& k) const { return t.find(k); }
+  size_type count(const key_type& k) const { return t.count(k); }
+
+  // 对每个与[lo, hi]相交的元素按区间顺序调用f(value_type&)
+  template <class F>
+  void for_each_overlap(const T& lo, const T& hi, F f) {
+    _overlap(_root(), lo, hi, f);
+  }
+  template <class F>
+  void for_each_overlap(const T& lo, const T& hi, F f) const {
+    _overlap(_root(), lo, hi, f);
+  }
+  // 对每个包含点x的元素调用f
+  template <class F>
+  void for_each_containing(const T& x, F f) {
+    _overlap(_root(), x, x, f);
+  }
+  template <class F>
+  void for_each_containing(const T& x, F f) const {
+    _overlap(_root(), x, x, f);
+  }
+  // 任意一个与[lo, hi]相交的元素，没有时返回end()，O(log n)
+  iterator find_overlap(const T& lo, const T& hi) {
+    return iterator(_any_overlap(lo, hi));
+  }
+  const_iterator find_overlap(const T& lo, const T& hi) const {
+    return const_iterator(_any_overlap(lo, hi));
+  }
+  size_type count_overlaps(const T& lo, const T& hi) const {
+    size_type n = 0;
+    for_each_overlap(lo, hi, [&n](const value_type&) { ++n; });
+    return n;
+  }
+
+ private:
+  // header的parent即根
+  link_type _root() const { return (link_type)(base_ptr)t.end().node->parent; }
+  static const key_type& _key(link_type x) { return x->value_field.first; }
+  static const T& _max_high(base_ptr x) { return augment::max_high(x); }
+  bool _overlaps(link_type x, const T& lo, const T& hi) const {
+    return !comp(hi, _key(x).low) && !comp(_key(x).high, lo);
+  }
+  template <class F>
+  void _overlap(link_type x, const T& lo, const T& hi, F& f) const {
+    while (x != 0 && !comp(_max_high(x), lo)) {
+      _overlap((link_type)x->left, lo, hi, f);
+      if (comp(hi, _key(x).low))  // x与右子树的low都大于hi
+        return;
+      if (!comp(_key(x).high, lo))
+        f(x->value_field);
+      x = (link_type)x->right;
+    }
+  }
+  // 左子树的最大右端点不小于lo时，若左子树中没有相交的区间，
+  // 右子树中也不会有，因此每层只需走一边
+  link_type _any_overlap(const T& lo, const T& hi) const {
+    link_type x = _root();
+    while (x != 0 && !_overlaps(x, lo, hi)) {
+      if (x->left != 0 && !comp(_max_high(x->left), lo))
+        x = (link_type)x->left;
+      else
+        x = (link_type)x->right;
+    }
+    return x != 0 ? x : (link_type)t.end().node;
+  }
+};
+
+_MINISTL_END
+
+#endif
\ No newline at end of file
@@ -0,0 +1,314 @@
+#ifndef MINISTL_INTRUSIVE_LIST_H
+#define MINISTL_INTRUSIVE_LIST_H
+
+#include "../iterator/iterator.hpp"
+#include "../utils/util.hpp"
+
+_MINISTL_BEGIN
+
+// 嵌入在元素内部的链接钩子，元素由调用者持有，链表不配置任何空间
+struct intrusive_list_hook {
+  typedef intrusive_list_hook* hook_ptr;
+  hook_ptr prev;
+  hook_ptr next;
+
+  intrusive_list_hook() : prev(0), next(0) {}
+  // 钩子只属于所在的对象，复制对象时不复制链接关系
+  intrusive_list_hook(const intrusive_list_hook&) : prev(0), next(0) {}
+  intrusive_list_hook& operator=(const intrusive_list_hook&) { return *this; }
+  // 对象销毁时自动从链表中摘除
+  ~intrusive_list_hook() { unlink(); }
+
+  bool is_linked() const { return next != 0; }
+  // 从所在链表中摘除自己，O(1)，不需要知道链表本身
+  void unlink() {
+    if (next != 0) {
+      prev->next = next;
+      next->prev = prev;
+      prev = 0;
+      next = 0;
+    }
+  }
+};
+
+// 钩子与元素之间的转换
+template <class T, intrusive_list_hook T::*Hook>
+struct _intrusive_list_traits {
+  typedef intrusive_list_hook* hook_ptr;
+
+  // 钩子在T中的偏移只在第一次调用时计算一次，之后直接返回
+  static size_t hook_offset() {
+    static const size_t offset = _compute_offset();
+    return offset;
+  }
+  static hook_ptr to_hook(T& x) { return &(x.*Hook); }
+  static T* to_value(hook_ptr h) {
+    return reinterpret_cast<T*>(reinterpret_cast<char*>(h) - hook_offset());
+  }
+
+ private:
+  static size_t _compute_offset() {
+    // 以一块未构造的空间计算钩子在T中的偏移
+    alignas(T) static char buf[sizeof(T)];
+    T* p = reinterpret_cast<T*>(buf);
+    return size_t(reinterpret_cast<char*>(&(p->*Hook)) -
+                  reinterpret_cast<char*>(p));
+  }
+};
+
+// 迭代器
+template <class T, intrusive_list_hook T::*Hook, class Ref, class Ptr>
+struct _intrusive_list_iterator {
+  typedef _intrusive_list_iterator<T, Hook, T&, T*> iterator;
+  typedef _intrusive_list_iterator<T, Hook, const T&, const T*> const_iterator;
+  typedef _intrusive_list_iterator<T, Hook, Ref, Ptr> self;
+  typedef _intrusive_list_traits<T, Hook> traits;
+
+  typedef bidirectional_iterator_tag iterator_category;
+  typedef T value_type;
+  typedef Ptr pointer;
+  typedef Ref reference;
+  typedef size_t size_type;
+  typedef ptrdiff_t difference_type;
+  typedef intrusive_list_hook* hook_ptr;
+
+  hook_ptr node;
+
+  _intrusive_list_iterator(hook_ptr x) : node(x) {}
+  _intrusive_list_iterator() {}
+  _intrusive_list_iterator(const iterator& x) : node(x.node) {}
+
+  bool operator==(const self& x) const { return node == x.node; }
+  bool operator!=(const self& x) const { return node != x.node; }
+
+  reference operator*() const { return *traits::to_value(node); }
+  pointer operator->() const { return &(operator*()); }
+
+  self& operator++() {
+    node = node->next;
+    return *this;
+  }
+  self operator++(int) {
+    self tmp = *this;
+    ++*this;
+    return tmp;
+  }
+  self& operator--() {
+    node = node->prev;
+    return *this;
+  }
+  self operator--(int) {
+    self tmp = *this;
+    --*this;
+    return tmp;
+  }
+};
+
+// 侵入式双向链表
+// 元素通过自身的intrusive_list_hook成员链接，链表只持有一个哨兵节点
+// 由于元素可以绕过链表自行unlink，size()需要遍历，为O(n)
+template <class T, intrusive_list_hook T::*Hook>
+class intrusive_list {
+ protected:
+  typedef _intrusive_list_traits<T, Hook> traits;
+  typedef intrusive_list_hook* hook_ptr;
+
+ public:
+  typedef _intrusive_list_iterator<T, Hook, T&, T*> iterator;
+  typedef _intrusive_list_iterator<T, Hook, const T&, const T*>
+      const_iterator;
+  typedef ministl::reverse_iterator<iterator> reverse_iterator;
+  typedef ministl::reverse_iterator<const_iterator> const_reverse_iterator;
+
+  typedef T value_type;
+  typedef T& reference;
+  typedef const T& const_reference;
+  typedef T* pointer;
+  typedef const T* const_pointer;
+  typedef size_t size_type;
+  typedef ptrdiff_t difference_type;
+
+ protected:
+  intrusive_list_hook node;  // 哨兵节点
+
+  void empty_initialize() {
+    node.next = &node;
+    node.prev = &node;
+  }
+  // 将[first, last)内的所有元素移动到position之前，与list::transfer相同
+  void transfer(iterator position, iterator first, iterator last);
+
+ public:
+  intrusive_list() { empty_initialize(); }
+  ~intrusive_list() {
+    clear();
+    node.next = 0;  // 哨兵不在任何链表中，避免钩子析构时再次摘除
+  }
+
+  iterator begin() { return node.next; }
+  const_iterator begin() const { return node.next; }
+  iterator end() { return &node; }
+  const_iterator end() const { return const_cast<hook_ptr>(&node); }
+  reverse_iterator rbegin() { return reverse_iterator(end()); }
+  const_reverse_iterator rbegin() const {
+    return const_reverse_iterator(end());
+  }
+  reverse_iterator rend() { return reverse_iterator(begin()); }
+  const_reverse_iterator rend() const {
+    return const_reverse_iterator(begin());
+  }
+  const_iterator cbegin() const { return begin(); }
+  const_iterator cend() const { return end(); }
+
+  bool empty() const { return node.next == &node; }
+  size_type size() const {
+    size_type result = 0;
+    for (hook_ptr p = node.next; p != &node; p = p->next)
+      ++result;
+    return result;
+  }
+  size_type max_size() const { return size_type(-1); }
+
+  reference front() { return *begin(); }
+  const_reference front() const { return *begin(); }
+  reference back() { return *(--end()); }
+  const_reference back() const { return *(--end()); }
+
+  // 由元素取得指向它的迭代器，元素必须已链接在某个链表中
+  static iterator iterator_to(T& x) { return traits::to_hook(x); }
+  static const_iterator iterator_to(const T& x) {
+    return traits::to_hook(const_cast<T&>(x));
+  }
+
+  // 在position之前链接x，x不能已在其他链表中
+  iterator insert(iterator position, T& x) {
+    hook_ptr tmp = traits::to_hook(x);
+    tmp->next = position.node;
+    tmp->prev = position.node->prev;
+    position.node->prev->next = tmp;
+    position.node->prev = tmp;
+    return tmp;
+  }
+  void push_back(T& x) { insert(end(), x); }
+  void push_front(T& x) { insert(begin(), x); }
+
+  // 摘除position所指元素，元素本身不被销毁
+  iterator erase(iterator position) {
+    hook_ptr next_node = position.node->next;
+    position.node->unlink();
+    return next_node;
+  }
+  iterator erase(iterator first, iterator last) {
+    while (first != last)
+      first = erase(first);
+    return last;
+  }
+  void pop_front() { erase(begin()); }
+  void pop_back() {
+    iterator tmp = end();
+    erase(--tmp);
+  }
+  // 摘除所有元素
+  void clear() {
+    hook_ptr cur = node.next;
+    while (cur != &node) {
+      hook_ptr tmp = cur;
+      cur = cur->next;
+      tmp->prev = 0;
+      tmp->next = 0;
+    }
+    empty_initialize();
+  }
+
+  // 将x接合于position所指位置之前，x必须不同于*this
+  void splice(iterator position, intrusive_list& x) {
+    if (!x.empty())
+      transfer(position, x.begin(), x.end());
+  }
+  // 将i接合于position所指位置之前，position和i可指向同一个链表
+  void splice(iterator position, intrusive_list&, iterator i) {
+    iterator j = i;
+    ++j;
+    if (position == i || position == j)
+      return;
+    transfer(position, i, j);
+  }
+  // 将[first,last)内的所有元素接合于position之前
+  // position不能位于[first,last)之内
+  void splice(iterator position,
+              intrusive_list&,
+              iterator first,
+              iterator last) {
+    if (first != last)
+      transfer(position, first, last);
+  }
+  // 将有序的x合并到*this身上
+  void merge(intrusive_list& x) { merge(x, std::less<T>()); }
+  template <class Compare>
+  void merge(intrusive_list& x, Compare comp);
+  void reverse();
+  void swap(intrusive_list& x);
+
+ private:
+  // 链表与哨兵一体，不可复制
+  intrusive_list(const intrusive_list&);
+  void operator=(const intrusive_list&);
+};
+
+template <class T, intrusive_list_hook T::*Hook>
+void intrusive_list<T, Hook>::transfer(iterator position,
+                                       iterator first,
+                                       iterator last) {
+  if (position != last) {
+    hook_ptr tmp = position.node->prev;
+    last.node->prev->next = position.node;
+    first.node->prev->next = last.node;
+    position.node->prev->next = first.node;
+    position.node->prev = last.node->prev;
+    last.node->prev = first.node->prev;
+    first.node->prev = tmp;
+  }
+}
+
+template <class T, intrusive_list_hook T::*Hook>
+template <class Compare>
+void intrusive_list<T, Hook>::merge(intrusive_list& x, Compare comp) {
+  iterator first1 = begin();
+  iterator last1 = end();
+  iterator first2 = x.begin();
+  iterator last2 = x.end();
+  while (first1 != last1 && first2 != last2) {
+    if (comp(*first2, *first1)) {
+      iterator next = first2;
+      transfer(first1, first2, ++next);
+      first2 = next;
+    } else
+      ++first1;
+  }
+  if (first2 != last2)
+    transfer(last1, first2, last2);
+}
+
+template <class T, intrusive_list_hook T::*Hook>
+void intrusive_list<T, Hook>::reverse() {
+  hook_ptr cur = &node;
+  do {  // 交换每个节点（含哨兵）的前后指针
+    hook_ptr tmp = cur->next;
+    cur->next = cur->prev;
+    cur->prev = tmp;
+    cur = tmp;
+  } while (cur != &node);
+}
+
+// 哨兵位于对象内部，交换时需要重新挂接两端
+template <class T, intrusive_list_hook T::*Hook>
+void intrusive_list<T, Hook>::swap(intrusive_list& x) {
+  intrusive_list tmp;
+  tmp.splice(tmp.end(), x);
+  x.splice(x.end(), *this);
+  splice(end(), tmp);
+}
+
+_MINISTL_END
+
+#endif
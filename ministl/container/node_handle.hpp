@@ -0,0 +1,83 @@
+#ifndef MINISTL_NODE_HANDLE_H
+#define MINISTL_NODE_HANDLE_H
+
+#include "../configurator/allocator.hpp"
+#include "../utils/util.hpp"
+
+_MINISTL_BEGIN
+
+// 节点句柄：持有从容器中摘下的节点，可原样挂入另一个同型别的容器
+// 节点在容器间转移时既不释放也不重新配置，元素也不被复制
+// Field为节点中存放元素的成员，句柄析构时若仍持有节点则销毁之
+template <class Node, class Value, class Alloc, Value Node::*Field>
+class _node_handle {
+ public:
+  typedef Value value_type;
+
+ private:
+  typedef allocator<Node, Alloc> node_allocator;
+  Node* ptr;
+
+  _node_handle(const _node_handle&);
+  _node_handle& operator=(const _node_handle&);
+
+ public:
+  _node_handle() : ptr(0) {}
+  explicit _node_handle(Node* p) : ptr(p) {}
+  _node_handle(_node_handle&& x) : ptr(x.ptr) { x.ptr = 0; }
+  _node_handle& operator=(_node_handle&& x) {
+    if (this != &x) {
+      reset();
+      ptr = x.ptr;
+      x.ptr = 0;
+    }
+    return *this;
+  }
+  ~_node_handle() { reset(); }
+
+  bool empty() const { return ptr == 0; }
+  explicit operator bool() const { return ptr != 0; }
+  // set的元素，可以修改后再插回
+  value_type& value() const { return ptr->*Field; }
+  // map的键值与实值，只对pair型别的元素可用
+  template <class V = Value>
+  typename V::first_type& key() const {
+    return (ptr->*Field).first;
+  }
+  template <class V = Value>
+  typename V::second_type& mapped() const {
+    return (ptr->*Field).second;
+  }
+  void swap(_node_handle& x) {
+    Node* tmp = ptr;
+    ptr = x.ptr;
+    x.ptr = tmp;
+  }
+
+  // 以下供容器使用
+  Node* _node() const { return ptr; }
+  Node* _release() {
+    Node* p = ptr;
+    ptr = 0;
+    return p;
+  }
+  void reset() {
+    if (ptr) {
+      destroy(&(ptr->*Field));
+      node_allocator::deallocate(ptr);
+      ptr = 0;
+    }
+  }
+};
+
+// insert(node_type&&)的返回值，插入失败时节点留在node中
+template <class Iterator, class NodeType>
+struct _node_insert_return {
+  Iterator position;
+  bool inserted;
+  NodeType node;
+};
+
+_MINISTL_END
+
+#endif
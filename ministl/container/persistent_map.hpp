@@ -0,0 +1,127 @@
+#ifndef MINISTL_PERSISTENT_MAP_H
+#define MINISTL_PERSISTENT_MAP_H
+
+#include "../configurator/allocator.hpp"
+#include "../functor/functor.hpp"
+#include "../utils/exceptdef.hpp"
+#include "../utils/util.hpp"
+#include "persistent_tree.hpp"
+
+_MINISTL_BEGIN
+
+// 不可变的有序map，复制（取快照）为O(1)，各版本之间共享未修改的节点
+// 修改只作用于本对象：插入删除为O(log n)，新配置的节点只有根到目标的路径
+// 元素只能读不能改，要改实值须经insert_or_assign换上新元素
+template <class Key,
+          class T,
+          class Compare = std::less<Key>,
+          class Alloc = alloc>
+class persistent_map {
+ public:
+  typedef Key key_type;
+  typedef T data_type;
+  typedef T mapped_type;
+  typedef pair<Key, T> value_type;
+  typedef Compare key_compare;
+
+ private:
+  typedef persistent_tree<key_type,
+                          value_type,
+                          select1st<value_type>,
+                          key_compare,
+                          Alloc>
+      rep_type;
+  rep_type t;
+
+ public:
+  typedef typename rep_type::const_pointer pointer;
+  typedef typename rep_type::const_pointer const_pointer;
+  typedef typename rep_type::const_reference reference;
+  typedef typename rep_type::const_reference const_reference;
+  typedef typename rep_type::const_iterator iterator;
+  typedef typename rep_type::const_iterator const_iterator;
+  typedef typename rep_type::const_reverse_iterator reverse_iterator;
+  typedef typename rep_type::const_reverse_iterator const_reverse_iterator;
+  typedef typename rep_type::size_type size_type;
+  typedef typename rep_type::difference_type difference_type;
+
+  persistent_map() : t(Compare()) {}
+  explicit persistent_map(const Compare& comp) : t(comp) {}
+  template <class InputIter>
+  persistent_map(InputIter first, InputIter last) : t(Compare()) {
+    t.insert(first, last);
+  }
+  template <class InputIter>
+  persistent_map(InputIter first, InputIter last, const Compare& comp)
+      : t(comp) {
+    t.insert(first, last);
+  }
+  // 快照：与x共享全部节点
+  persistent_map(const persistent_map& x) : t(x.t) {}
+  persistent_map(persistent_map&& x) : t(std::move(x.t)) {}
+  persistent_map& operator=(const persistent_map& x) {
+    t = x.t;
+    return *this;
+  }
+  persistent_map& operator=(persistent_map&& x) {
+    t = std::move(x.t);
+    return *this;
+  }
+
+  key_compare key_comp() const { return t.key_comp(); }
+  const_iterator begin() const { return t.begin(); }
+  const_iterator end() const { return t.end(); }
+  const_reverse_iterator rbegin() const { return t.rbegin(); }
+  const_reverse_iterator rend() const { return t.rend(); }
+  const_iterator cbegin() const { return begin(); }
+  const_iterator cend() const { return end(); }
+  bool empty() const { return t.empty(); }
+  size_type size() const { return t.size(); }
+  size_type max_size() const { return t.max_size(); }
+  void swap(persistent_map& x) { t.swap(x.t); }
+
+  // 键值已存在时什么也不做
+  pair<iterator, bool> insert(const value_type& x) { return t.insert(x); }
+  template <class InputIter>
+  void insert(InputIter first, InputIter last) {
+    t.insert(first, last);
+  }
+  // k已存在时以(k, obj)取代旧元素
+  template <class M>
+  pair<iterator, bool> insert_or_assign(const key_type& k, M&& obj) {
+    return t.insert(value_type(k, std::forward<M>(obj)), true);
+  }
+  size_type erase(const key_type& k) { return t.erase(k); }
+  void clear() { t.clear(); }
+
+  const_iterator find(const key_type& k) const { return t.find(k); }
+  size_type count(const key_type& k) const { return t.count(k); }
+  bool contains(const key_type& k) const { return t.count(k) != 0; }
+  const mapped_type& at(const key_type& k) const {
+    const_iterator it = t.find(k);
+    THROW_OUT_OF_RANGE_IF(it == t.end(), "no such element");
+    return (*it).second;
+  }
+  const_iterator lower_bound(const key_type& k) const {
+    return t.lower_bound(k);
+  }
+  const_iterator upper_bound(const key_type& k) const {
+    return t.upper_bound(k);
+  }
+  pair<const_iterator, const_iterator> equal_range(const key_type& k) const {
+    return t.equal_range(k);
+  }
+  // 按键值递增顺序遍历，O(n)；迭代器每步要从根查找
+  template <class F>
+  void for_each(F f) const {
+    t.for_each(f);
+  }
+  // 是否仍与x共享同一个根，为真时两者内容相同
+  bool shares_root_with(const persistent_map& x) const {
+    return t.same_root(x.t);
+  }
+};
+
+_MINISTL_END
+
+#endif
\ No newline at end of file
@@ -0,0 +1,108 @@
+#ifndef MINISTL_PERSISTENT_SET_H
+#define MINISTL_PERSISTENT_SET_H
+
+#include "../configurator/allocator.hpp"
+#include "../functor/functor.hpp"
+#include "../utils/util.hpp"
+#include "persistent_tree.hpp"
+
+_MINISTL_BEGIN
+
+// 不可变的有序set，复制（取快照）为O(1)，各版本之间共享未修改的节点
+// 修改只作用于本对象：插入删除为O(log n)，新配置的节点只有根到目标的路径
+template <class Key, class Compare = std::less<Key>, class Alloc = alloc>
+class persistent_set {
+ public:
+  typedef Key key_type;
+  typedef Key value_type;
+  typedef Compare key_compare;
+  typedef Compare value_compare;
+
+ private:
+  typedef persistent_tree<key_type,
+                          value_type,
+                          identity<value_type>,
+                          key_compare,
+                          Alloc>
+      rep_type;
+  rep_type t;
+
+ public:
+  typedef typename rep_type::const_pointer pointer;
+  typedef typename rep_type::const_pointer const_pointer;
+  typedef typename rep_type::const_reference reference;
+  typedef typename rep_type::const_reference const_reference;
+  typedef typename rep_type::const_iterator iterator;
+  typedef typename rep_type::const_iterator const_iterator;
+  typedef typename rep_type::const_reverse_iterator reverse_iterator;
+  typedef typename rep_type::const_reverse_iterator const_reverse_iterator;
+  typedef typename rep_type::size_type size_type;
+  typedef typename rep_type::difference_type difference_type;
+
+  persistent_set() : t(Compare()) {}
+  explicit persistent_set(const Compare& comp) : t(comp) {}
+  template <class InputIter>
+  persistent_set(InputIter first, InputIter last) : t(Compare()) {
+    t.insert(first, last);
+  }
+  template <class InputIter>
+  persistent_set(InputIter first, InputIter last, const Compare& comp)
+      : t(comp) {
+    t.insert(first, last);
+  }
+  // 快照：与x共享全部节点
+  persistent_set(const persistent_set& x) : t(x.t) {}
+  persistent_set(persistent_set&& x) : t(std::move(x.t)) {}
+  persistent_set& operator=(const persistent_set& x) {
+    t = x.t;
+    return *this;
+  }
+  persistent_set& operator=(persistent_set&& x) {
+    t = std::move(x.t);
+    return *this;
+  }
+
+  key_compare key_comp() const { return t.key_comp(); }
+  value_compare value_comp() const { return t.key_comp(); }
+  iterator begin() const { return t.begin(); }
+  iterator end() const { return t.end(); }
+  reverse_iterator rbegin() const { return t.rbegin(); }
+  reverse_iterator rend() const { return t.rend(); }
+  const_iterator cbegin() const { return begin(); }
+  const_iterator cend() const { return end(); }
+  bool empty() const { return t.empty(); }
+  size_type size() const { return t.size(); }
+  size_type max_size() const { return t.max_size(); }
+  void swap(persistent_set& x) { t.swap(x.t); }
+
+  // 元素已存在时什么也不做
+  pair<iterator, bool> insert(const value_type& x) { return t.insert(x); }
+  template <class InputIter>
+  void insert(InputIter first, InputIter last) {
+    t.insert(first, last);
+  }
+  size_type erase(const key_type& x) { return t.erase(x); }
+  void clear() { t.clear(); }
+
+  iterator find(const key_type& x) const { return t.find(x); }
+  size_type count(const key_type& x) const { return t.count(x); }
+  bool contains(const key_type& x) const { return t.count(x) != 0; }
+  iterator lower_bound(const key_type& x) const { return t.lower_bound(x); }
+  iterator upper_bound(const key_type& x) const { return t.upper_bound(x); }
+  pair<iterator, iterator> equal_range(const key_type& x) const {
+    return t.equal_range(x);
+  }
+  // 按递增顺序遍历，O(n)；迭代器每步要从根查找
+  template <class F>
+  void for_each(F f) const {
+    t.for_each(f);
+  }
+  // 是否仍与x共享同一个根，为真时两者内容相同
+  bool shares_root_with(const persistent_set& x) const {
+    return t.same_root(x.t);
+  }
+};
+
+_MINISTL_END
+
+#endif
\ No newline at end of file
@@ -0,0 +1,470 @@
+#ifndef MINISTL_PERSISTENT_TREE_H
+#define MINISTL_PERSISTENT_TREE_H
+
+#include "../configurator/allocator.hpp"
+#include "../iterator/iterator.hpp"
+#include "../utils/util.hpp"
+
+_MINISTL_BEGIN
+
+// persistent_map / persistent_set 的公共部分：路径复制的AVL树
+// 节点一经构造便不再修改，以引用计数在多个版本之间共享
+// 复制整棵树只需增加根节点的计数，O(1)；插入删除只重建根到目标的路径，
+// 以及平衡时旋转到的O(1)个节点，其余子树原样共享
+// 没有父指针，迭代器前进一步要从根重新查找，O(log n)
+// 引用计数不是原子的，跨线程共享版本须由调用者同步
+
+template <class Value>
+struct _persistent_node {
+  typedef _persistent_node* link_type;
+  link_type left;
+  link_type right;
+  size_t refs;  // 引用此节点的父节点与树的个数
+  int height;   // 叶节点为1
+  Value value_field;
+};
+
+template <class Tree>
+struct _persistent_tree_iterator {
+  typedef bidirectional_iterator_tag iterator_category;
+  typedef typename Tree::value_type value_type;
+  typedef const value_type* pointer;
+  typedef const value_type& reference;
+  typedef ptrdiff_t difference_type;
+  typedef _persistent_tree_iterator self;
+  typedef typename Tree::link_type link_type;
+
+  const Tree* t;
+  link_type node;  // end()时为0
+
+  _persistent_tree_iterator() : t(0), node(0) {}
+  _persistent_tree_iterator(const Tree* tree, link_type x) : t(tree), node(x) {}
+
+  reference operator*() const { return node->value_field; }
+  pointer operator->() const { return &(operator*()); }
+  self& operator++() {
+    node = t->_successor(node);
+    return *this;
+  }
+  self operator++(int) {
+    self tmp = *this;
+    ++*this;
+    return tmp;
+  }
+  self& operator--() {
+    node = t->_predecessor(node);
+    return *this;
+  }
+  self operator--(int) {
+    self tmp = *this;
+    --*this;
+    return tmp;
+  }
+  bool operator==(const self& x) const { return node == x.node; }
+  bool operator!=(const self& x) const { return node != x.node; }
+};
+
+template <class Key,
+          class Value,
+          class KeyOfValue,
+          class Compare,
+          class Alloc = alloc>
+class persistent_tree {
+ public:
+  typedef Key key_type;
+  typedef Value value_type;
+  typedef const value_type* const_pointer;
+  typedef const value_type& const_reference;
+  typedef size_t size_type;
+  typedef ptrdiff_t difference_type;
+  typedef _persistent_node<Value> node;
+  typedef node* link_type;
+  typedef _persistent_tree_iterator<persistent_tree> const_iterator;
+  typedef ministl::reverse_iterator<const_iterator> const_reverse_iterator;
+
+ private:
+  friend struct _persistent_tree_iterator<persistent_tree>;
+  typedef allocator<node, Alloc> node_allocator;
+
+  link_type root;
+  size_type node_count;
+  Compare key_compare;
+
+  static const Key& key(link_type x) { return KeyOfValue()(x->value_field); }
+  static int height(link_type x) { return x ? x->height : 0; }
+  static link_type _ref(link_type x) {
+    if (x)
+      ++x->refs;
+    return x;
+  }
+  // 放弃一个引用，计数归零时连同不再被引用的子树一起释放
+  static void _release(link_type x) {
+    while (x && --x->refs == 0) {
+      _release(x->left);
+      link_type r = x->right;
+      destroy(&x->value_field);
+      node_allocator::deallocate(x);
+      x = r;
+    }
+  }
+  // 以v构造新节点，接管l与r的引用；失败时放弃l与r
+  static link_type _make(link_type l, const value_type& v, link_type r) {
+    link_type x = node_allocator::allocate();
+    try {
+      construct(&x->value_field, v);
+    } catch (...) {
+      node_allocator::deallocate(x);
+      _release(l);
+      _release(r);
+      throw;
+    }
+    x->left = l;
+    x->right = r;
+    x->refs = 1;
+    int hl = height(l), hr = height(r);
+    x->height = (hl > hr ? hl : hr) + 1;
+    return x;
+  }
+  // 同_make，但l与r的高度差可以为2，必要时旋转；旋转到的旧节点被复制
+  static link_type _balance(link_type l, const value_type& v, link_type r);
+  // 以下返回新子树的根（持有一个引用），x本身只被借用
+  // 没有变化时返回0，插入时对路径不做任何复制
+  link_type _insert(link_type x, const value_type& v, bool assign, bool& done);
+  link_type _erase(link_type x, const Key& k, bool& done);
+  static link_type _erase_min(link_type x);
+
+  link_type _successor(link_type x) const;
+  link_type _predecessor(link_type x) const;
+
+ public:
+  explicit persistent_tree(const Compare& comp = Compare())
+      : root(0), node_count(0), key_compare(comp) {}
+  // 与x共享全部节点，O(1)
+  persistent_tree(const persistent_tree& x)
+      : root(_ref(x.root)), node_count(x.node_count),
+        key_compare(x.key_compare) {}
+  persistent_tree(persistent_tree&& x)
+      : root(x.root), node_count(x.node_count), key_compare(x.key_compare) {
+    x.root = 0;
+    x.node_count = 0;
+  }
+  persistent_tree& operator=(const persistent_tree& x) {
+    link_type r = _ref(x.root);  // 先增加再放弃，自我赋值也安全
+    _release(root);
+    root = r;
+    node_count = x.node_count;
+    key_compare = x.key_compare;
+    return *this;
+  }
+  persistent_tree& operator=(persistent_tree&& x) {
+    swap(x);
+    return *this;
+  }
+  ~persistent_tree() { _release(root); }
+
+  Compare key_comp() const { return key_compare; }
+  const_iterator begin() const { return const_iterator(this, _minimum(root)); }
+  const_iterator end() const { return const_iterator(this, 0); }
+  const_reverse_iterator rbegin() const {
+    return const_reverse_iterator(end());
+  }
+  const_reverse_iterator rend() const {
+    return const_reverse_iterator(begin());
+  }
+  bool empty() const { return node_count == 0; }
+  size_type size() const { return node_count; }
+  size_type max_size() const { return size_type(-1); }
+  void swap(persistent_tree& x) {
+    std::swap(root, x.root);
+    std::swap(node_count, x.node_count);
+    std::swap(key_compare, x.key_compare);
+  }
+  // 两棵树是否共享同一个根，为真时内容必然相同
+  bool same_root(const persistent_tree& x) const { return root == x.root; }
+
+  // 插入与删除，只影响本树，与本树共享节点的其他版本不受影响
+  // 键值已存在时assign决定是否以v取代旧元素
+  // 返回指向该键值元素的迭代器与是否新增了元素；旋转会复制节点，
+  // 新节点的位置要在插入后重新查找一次，O(log n)
+  pair<const_iterator, bool> insert(const value_type& v, bool assign = false) {
+    bool done = false;
+    link_type r = _insert(root, v, assign, done);
+    if (r) {
+      _release(root);
+      root = r;
+    }
+    if (done)
+      ++node_count;
+    return pair<const_iterator, bool>(find(KeyOfValue()(v)), done);
+  }
+  template <class InputIter>
+  void insert(InputIter first, InputIter last) {
+    for (; first != last; ++first)
+      insert(*first);
+  }
+  size_type erase(const Key& k) {
+    bool done = false;
+    link_type r = _erase(root, k, done);
+    if (!done)
+      return 0;
+    _release(root);
+    root = r;
+    --node_count;
+    return 1;
+  }
+  void clear() {
+    _release(root);
+    root = 0;
+    node_count = 0;
+  }
+
+  // 查找
+  const_iterator find(const Key& k) const {
+    link_type x = root;
+    while (x) {
+      if (key_compare(k, key(x)))
+        x = x->left;
+      else if (key_compare(key(x), k))
+        x = x->right;
+      else
+        return const_iterator(this, x);
+    }
+    return end();
+  }
+  size_type count(const Key& k) const { return find(k) == end() ? 0 : 1; }
+  const_iterator lower_bound(const Key& k) const {
+    link_type y = 0, x = root;
+    while (x) {
+      if (!key_compare(key(x), k))
+        y = x, x = x->left;
+      else
+        x = x->right;
+    }
+    return const_iterator(this, y);
+  }
+  const_iterator upper_bound(const Key& k) const {
+    link_type y = 0, x = root;
+    while (x) {
+      if (key_compare(k, key(x)))
+        y = x, x = x->left;
+      else
+        x = x->right;
+    }
+    return const_iterator(this, y);
+  }
+  pair<const_iterator, const_iterator> equal_range(const Key& k) const {
+    return pair<const_iterator, const_iterator>(lower_bound(k),
+                                                upper_bound(k));
+  }
+  // 按键值递增顺序对每个元素调用f，O(n)，比迭代器遍历快
+  template <class F>
+  void for_each(F f) const {
+    _for_each(root, f);
+  }
+
+ private:
+  static link_type _minimum(link_type x) {
+    if (x)
+      while (x->left)
+        x = x->left;
+    return x;
+  }
+  static link_type _maximum(link_type x) {
+    if (x)
+      while (x->right)
+        x = x->right;
+    return x;
+  }
+  template <class F>
+  static void _for_each(link_type x, F& f) {
+    while (x) {
+      _for_each(x->left, f);
+      f(x->value_field);
+      x = x->right;
+    }
+  }
+};
+
+template <class Key,
+          class Value,
+          class KeyOfValue,
+          class Compare,
+          class Alloc>
+typename persistent_tree<Key, Value, KeyOfValue, Compare, Alloc>::link_type
+persistent_tree<Key, Value, KeyOfValue, Compare, Alloc>::_balance(
+    link_type l,
+    const value_type& v,
+    link_type r) {
+  int hl = height(l), hr = height(r);
+  if (hl > hr + 1) {
+    // l被拆开，其子树与值转给新节点，最后放弃l
+    try {
+      link_type res;
+      if (height(l->left) >= height(l->right)) {  // 右旋
+        link_type a = _make(_ref(l->right), v, r);
+        res = _make(_ref(l->left), l->value_field, a);
+      } else {  // 先左旋l再右旋
+        link_type lr = l->right;
+        link_type a = _make(_ref(lr->right), v, r), b;
+        try {
+          b = _make(_ref(l->left), l->value_field, _ref(lr->left));
+        } catch (...) {
+          _release(a);
+          throw;
+        }
+        res = _make(b, lr->value_field, a);
+      }
+      _release(l);
+      return res;
+    } catch (...) {
+      _release(l);
+      throw;
+    }
+  }
+  if (hr > hl + 1) {
+    try {
+      link_type res;
+      if (height(r->right) >= height(r->left)) {  // 左旋
+        link_type a = _make(l, v, _ref(r->left));
+        res = _make(a, r->value_field, _ref(r->right));
+      } else {  // 先右旋r再左旋
+        link_type rl = r->left;
+        link_type a = _make(l, v, _ref(rl->left)), b;
+        try {
+          b = _make(_ref(rl->right), r->value_field, _ref(r->right));
+        } catch (...) {
+          _release(a);
+          throw;
+        }
+        res = _make(a, rl->value_field, b);
+      }
+      _release(r);
+      return res;
+    } catch (...) {
+      _release(r);
+      throw;
+    }
+  }
+  return _make(l, v, r);
+}
+
+template <class Key,
+          class Value,
+          class KeyOfValue,
+          class Compare,
+          class Alloc>
+typename persistent_tree<Key, Value, KeyOfValue, Compare, Alloc>::link_type
+persistent_tree<Key, Value, KeyOfValue, Compare, Alloc>::_insert(
+    link_type x,
+    const value_type& v,
+    bool assign,
+    bool& done) {
+  if (x == 0) {
+    done = true;
+    return _make(0, v, 0);
+  }
+  const Key& k = KeyOfValue()(v);
+  if (key_compare(k, key(x))) {
+    link_type l = _insert(x->left, v, assign, done);
+    return l ? _balance(l, x->value_field, _ref(x->right)) : 0;
+  }
+  if (key_compare(key(x), k)) {
+    link_type r = _insert(x->right, v, assign, done);
+    return r ? _balance(_ref(x->left), x->value_field, r) : 0;
+  }
+  // 键值已存在，取代时只复制x，子树原样共享
+  return assign ? _make(_ref(x->left), v, _ref(x->right)) : 0;
+}
+
+template <class Key,
+          class Value,
+          class KeyOfValue,
+          class Compare,
+          class Alloc>
+typename persistent_tree<Key, Value, KeyOfValue, Compare, Alloc>::link_type
+persistent_tree<Key, Value, KeyOfValue, Compare, Alloc>::_erase(link_type x,
+                                                                const Key& k,
+                                                                bool& done) {
+  if (x == 0)
+    return 0;  // 没有找到，done仍为false
+  if (key_compare(k, key(x))) {
+    link_type l = _erase(x->left, k, done);
+    return done ? _balance(l, x->value_field, _ref(x->right)) : 0;
+  }
+  if (key_compare(key(x), k)) {
+    link_type r = _erase(x->right, k, done);
+    return done ? _balance(_ref(x->left), x->value_field, r) : 0;
+  }
+  done = true;
+  if (x->left == 0)
+    return _ref(x->right);
+  if (x->right == 0)
+    return _ref(x->left);
+  // 以右子树的最小元素取代x，该元素由x->right持有，在此期间不会被释放
+  const value_type& m = _minimum(x->right)->value_field;
+  link_type r = _erase_min(x->right);
+  return _balance(_ref(x->left), m, r);
+}
+
+template <class Key,
+          class Value,
+          class KeyOfValue,
+          class Compare,
+          class Alloc>
+typename persistent_tree<Key, Value, KeyOfValue, Compare, Alloc>::link_type
+persistent_tree<Key, Value, KeyOfValue, Compare, Alloc>::_erase_min(
+    link_type x) {
+  if (x->left == 0)
+    return _ref(x->right);
+  return _balance(_erase_min(x->left), x->value_field, _ref(x->right));
+}
+
+// 从根查找第一个键值大于x的节点；x为0（end）时没有后继
+template <class Key,
+          class Value,
+          class KeyOfValue,
+          class Compare,
+          class Alloc>
+typename persistent_tree<Key, Value, KeyOfValue, Compare, Alloc>::link_type
+persistent_tree<Key, Value, KeyOfValue, Compare, Alloc>::_successor(
+    link_type x) const {
+  if (x->right)
+    return _minimum(x->right);
+  link_type y = 0, p = root;
+  const Key& k = key(x);
+  while (p != x) {
+    if (key_compare(k, key(p)))
+      y = p, p = p->left;
+    else
+      p = p->right;
+  }
+  return y;
+}
+
+// end()的前驱为最大节点
+template <class Key,
+          class Value,
+          class KeyOfValue,
+          class Compare,
+          class Alloc>
+typename persistent_tree<Key, Value, KeyOfValue, Compare, Alloc>::link_type
+persistent_tree<Key, Value, KeyOfValue, Compare, Alloc>::_predecessor(
+    link_type x) const {
+  if (x == 0)
+    return _maximum(root);
+  if (x->left)
+    return _maximum(x->left);
+  link_type y = 0, p = root;
+  const Key& k = key(x);
+  while (p != x) {
+    if (key_compare(key(p), k))
+      y = p, p = p->right;
+    else
+      p = p->left;
+  }
+  return y;
+}
+
+_MINISTL_END
+
+#endif
\ No newline at end of file
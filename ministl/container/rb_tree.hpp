@@ -4,6 +4,11 @@
 #include "../configurator/allocator.hpp"
 #include "../iterator/iterator.hpp"
 #include "../utils/util.hpp"
+#include "node_handle.hpp"
+#ifndef MINISTL_NO_THREADS
+#include <system_error>
+#include <thread>
+#endif
 
 _MINISTL_BEGIN
 
@@ -11,15 +16,51 @@ typedef bool _rb_tree_color_type;
 const _rb_tree_color_type _rb_tree_red = false;
 const _rb_tree_color_type _rb_tree_black = true;
 
+struct _rb_tree_node_base;
+// 以最低位存放颜色的父节点指针，节点至少按2字节对齐，最低位总是空闲的
+// 读取与赋值都与普通指针相同，赋值只改指针部分，不影响颜色
+struct _rb_tree_packed_parent {
+  _rb_tree_node_base* bits;
+
+  operator _rb_tree_node_base*() const {
+    return (_rb_tree_node_base*)((uintptr_t)bits & ~uintptr_t(1));
+  }
+  _rb_tree_node_base* operator->() const { return *this; }
+  _rb_tree_packed_parent& operator=(_rb_tree_node_base* p) {
+    bits = (_rb_tree_node_base*)((uintptr_t)p | ((uintptr_t)bits & 1));
+    return *this;
+  }
+  _rb_tree_packed_parent& operator=(const _rb_tree_packed_parent& p) {
+    return *this = (_rb_tree_node_base*)p;
+  }
+};
+
 // 节点属性
+// 定义MINISTL_RB_TREE_COMPACT时颜色放进parent的最低位，每个节点省下一个字
+// 红色为0，header总是红色，因此header->parent可以直接当作根指针读写
 struct _rb_tree_node_base {
   typedef _rb_tree_color_type color_type;
   typedef _rb_tree_node_base* base_ptr;
 
-  color_type color;  // 节点颜色
-  base_ptr parent;   // 父节点
-  base_ptr left;     // 左节点
-  base_ptr right;    // 右节点
+#ifdef MINISTL_RB_TREE_COMPACT
+  _rb_tree_packed_parent parent;  // 父节点，最低位为颜色
+#else
+  color_type color_field;  // 节点颜色
+  base_ptr parent;         // 父节点
+#endif
+  base_ptr left;   // 左节点
+  base_ptr right;  // 右节点
+
+#ifdef MINISTL_RB_TREE_COMPACT
+  color_type color() const { return color_type((uintptr_t)parent.bits & 1); }
+  void set_color(color_type c) {
+    parent.bits =
+        (base_ptr)(((uintptr_t)parent.bits & ~uintptr_t(1)) | uintptr_t(c));
+  }
+#else
+  color_type color() const { return color_field; }
+  void set_color(color_type c) { color_field = c; }
+#endif
 
   static base_ptr minimum(base_ptr x) {
     while (x->left != 0)
@@ -32,13 +73,133 @@ struct _rb_tree_node_base {
     return x;
   }
 };
-// 二叉树节点
-template <class Value>
-struct _rb_tree_node : public _rb_tree_node_base {
-  typedef _rb_tree_node<Value>* link_type;
+// 另记录以该节点为根的子树的节点数，用于顺序统计
+struct _rb_tree_size_node_base : public _rb_tree_node_base {
+  size_t size;
+};
+// 二叉树节点，Base为以上两者之一
+template <class Value, class Base = _rb_tree_node_base>
+struct _rb_tree_node : public Base {
+  typedef _rb_tree_node<Value, Base>* link_type;
   Value value_field;  // 节点值
 };
-template <class Value, class Ref, class Ptr>
+
+// 节点附加信息的维护策略，树形改变时由插入、删除与旋转调用
+// 不附加任何信息，各操作都是空的
+struct _rb_tree_no_augment {
+  typedef _rb_tree_node_base node_base;
+  typedef _rb_tree_node_base* base_ptr;
+  // 由x的子节点重新计算x
+  static void update(base_ptr) {}
+  // z刚被链接为叶节点
+  static void inserted(base_ptr, base_ptr) {}
+  // y的位置即将从树中移走
+  static void erasing(base_ptr, base_ptr) {}
+  // 节点已摘下、尚未调整颜色，p为顶替节点的父节点，p到根的子树内容都变了
+  static void erased(base_ptr, base_ptr) {}
+};
+// 维护子树大小，支持O(log n)的rank与select
+struct _rb_tree_size_augment {
+  typedef _rb_tree_size_node_base node_base;
+  typedef _rb_tree_node_base* base_ptr;
+  static size_t& size(base_ptr x) { return ((node_base*)x)->size; }
+  static size_t size_of(base_ptr x) { return x ? size(x) : 0; }
+  static void update(base_ptr x) {
+    size(x) = size_of(x->left) + size_of(x->right) + 1;
+  }
+  static void inserted(base_ptr z, base_ptr root) {
+    size(z) = 1;
+    for (; z != root; z = z->parent)
+      ++size(z->parent);
+  }
+  static void erasing(base_ptr y, base_ptr root) {
+    for (; y != root; y = y->parent)
+      --size(y->parent);
+  }
+  static void erased(base_ptr, base_ptr) {}
+};
+
+template <class Augment>
+inline void _rb_tree_rebalance(_rb_tree_node_base* x,
+                               _rb_tree_node_base*& root);
+template <class Augment>
+inline _rb_tree_node_base* _rb_tree_rebalance_for_erase(
+    _rb_tree_node_base* z,
+    _rb_tree_node_base*& root,
+    _rb_tree_node_base*& leftmost,
+    _rb_tree_node_base*& rightmost);
+
+// 集合运算中被丢弃的子树，以根节点的parent串成链表，运算结束后统一销毁
+// 并行的各分支各用一个，销毁留到单线程时进行，不在多个线程中调用配置器
+struct _rb_tree_discard {
+  _rb_tree_node_base* head;
+  _rb_tree_node_base* tail;
+
+  _rb_tree_discard() : head(0), tail(0) {}
+  void push(_rb_tree_node_base* x) {
+    if (x == 0)
+      return;
+    x->parent = head;
+    head = x;
+    if (tail == 0)
+      tail = x;
+  }
+  void splice(_rb_tree_discard& d) {
+    if (d.head == 0)
+      return;
+    d.tail->parent = head;
+    head = d.head;
+    if (tail == 0)
+      tail = d.tail;
+    d.head = d.tail = 0;
+  }
+};
+
+// 区间删除超过此数目的元素时，改以split/join整段摘下
+const size_t _rb_tree_split_cutoff = 64;
+
+// 批量插入的元素个数不少于树中元素的1/_rb_tree_batch_ratio时才先排序再并入
+const size_t _rb_tree_batch_ratio = 256;
+
+// 两个集合的节点数之和达到此值时，集合运算才在前几层递归中并行
+const size_t _rb_tree_parallel_cutoff = size_t(1) << 16;
+
+// 并行递归的层数，约为log2(硬件线程数)，定义MINISTL_NO_THREADS时为0
+inline int _rb_tree_parallel_depth(size_t n) {
+  int depth = 0;
+#ifndef MINISTL_NO_THREADS
+  if (n >= _rb_tree_parallel_cutoff)
+    for (unsigned t = std::thread::hardware_concurrency(); (1u << depth) < t;)
+      ++depth;
+#else
+  (void)n;
+#endif
+  return depth;
+}
+
+// parallel为真时f2在新线程中与f1同时执行，线程无法创建时依次执行
+template <class F1, class F2>
+inline void _rb_tree_par_do(bool parallel, F1 f1, F2 f2) {
+#ifndef MINISTL_NO_THREADS
+  if (parallel) {
+    std::thread t;
+    try {
+      t = std::thread(f2);
+    } catch (const std::system_error&) {
+      f1();
+      f2();
+      return;
+    }
+    f1();
+    t.join();
+    return;
+  }
+#endif
+  f1();
+  f2();
+}
+
+template <class Value, class Ref, class Ptr, class Node>
 struct _rb_tree_const_iterator;
 // 基层迭代器
 struct _rb_tree_base_iterator {
@@ -67,7 +228,7 @@ struct _rb_tree_base_iterator {
   }
   // operator--
   void decrement() {
-    if (node->color == _rb_tree_red &&
+    if (node->color() == _rb_tree_red &&
         node->parent->parent == node)  // 如果是红节点且父节点的父节点等于自己
       node = node->right;         // 状况1，右节点即为结果
     else if (node->left != 0) {   // 如果有左节点，状况2
@@ -87,15 +248,15 @@ struct _rb_tree_base_iterator {
 
 };
 // RB-tree 的正向迭代器
-template <class Value, class Ref, class Ptr>
+template <class Value, class Ref, class Ptr, class Node = _rb_tree_node<Value> >
 struct _rb_tree_iterator : public _rb_tree_base_iterator {
   typedef Value value_type;
   typedef Ref reference;
   typedef Ptr pointer;
-  typedef _rb_tree_iterator<Value, Value&, Value*> iterator;
-  typedef _rb_tree_const_iterator<Value, Value&, Value*> const_iterator;
-  typedef _rb_tree_iterator<Value, Ref, Ptr> self;
-  typedef _rb_tree_node<Value>* link_type;
+  typedef _rb_tree_iterator<Value, Value&, Value*, Node> iterator;
+  typedef _rb_tree_const_iterator<Value, Value&, Value*, Node> const_iterator;
+  typedef _rb_tree_iterator<Value, Ref, Ptr, Node> self;
+  typedef Node* link_type;
 
   _rb_tree_iterator() {}
   _rb_tree_iterator(link_type x) { node = x; }
@@ -124,23 +285,23 @@ struct _rb_tree_iterator : public _rb_tree_base_iterator {
     return tmp;
   }
 
-  bool operator!=(const iterator& s){
+  bool operator!=(const iterator& s) const {
     return this->node != s.node;
   }
-  bool operator==(const iterator& s){
+  bool operator==(const iterator& s) const {
     return this->node == s.node;
   }
 };
 // rb-tree 的const迭代器
-template <class Value, class Ref, class Ptr>
+template <class Value, class Ref, class Ptr, class Node = _rb_tree_node<Value> >
 struct _rb_tree_const_iterator : public _rb_tree_base_iterator {
   typedef Value value_type;
   typedef const Ref reference;
   typedef const Ptr pointer;
-  typedef _rb_tree_iterator<Value, Value&, Value*> iterator;
-  typedef _rb_tree_const_iterator<Value, Value&, Value*> const_iterator;
+  typedef _rb_tree_iterator<Value, Value&, Value*, Node> iterator;
+  typedef _rb_tree_const_iterator<Value, Value&, Value*, Node> const_iterator;
   typedef const_iterator self;
-  typedef _rb_tree_node<Value>* link_type;
+  typedef Node* link_type;
 
   _rb_tree_const_iterator() {}
   _rb_tree_const_iterator(link_type x) { node = x; }
@@ -169,19 +330,27 @@ struct _rb_tree_const_iterator : public _rb_tree_base_iterator {
     decrement();
     return tmp;
   }
+
+  bool operator!=(const const_iterator& s) const {
+    return this->node != s.node;
+  }
+  bool operator==(const const_iterator& s) const {
+    return this->node == s.node;
+  }
 };
 
-// rb_tree
+// rb_tree，Augment为节点附加信息的维护策略
 template <class Key,
           class Value,
           class KeyOfValue,
           class Compare,
-          class Alloc = alloc>
+          class Alloc = alloc,
+          class Augment = _rb_tree_no_augment>
 class rb_tree {
  protected:
   typedef void* void_pointer;
   typedef _rb_tree_node_base* base_ptr;
-  typedef _rb_tree_node<Value> rb_tree_node;
+  typedef _rb_tree_node<Value, typename Augment::node_base> rb_tree_node;
   typedef allocator<rb_tree_node, Alloc> rb_tree_node_allocator;
   typedef _rb_tree_color_type color_type;
 
@@ -200,19 +369,24 @@ class rb_tree {
   link_type get_node() { return rb_tree_node_allocator::allocate(); }
   void put_node(link_type p) { rb_tree_node_allocator::deallocate(p); }
 
-  link_type create_node(const value_type& x) {
+  template <class... Args>
+  link_type create_node(Args&&... args) {
     link_type tmp = get_node();  // 配置空间
     try {
-      construct(&tmp->value_field, x);  // 构造空间
+      construct(&tmp->value_field, std::forward<Args>(args)...);  // 构造空间
     } catch (...) {
       put_node(tmp);
+      throw;
     }
     return tmp;
   }
 
-  link_type clone_node(link_type x) {  // 复制一个节点的值和颜色
-    link_type tmp = create_node(x->value_field);
-    tmp->color = x->color;
+  // 复制一个节点的值、颜色与附加信息，节点由gen提供
+  template <class NodeGen>
+  link_type clone_node(link_type x, NodeGen& gen) {
+    link_type tmp = gen(x->value_field);
+    static_cast<typename Augment::node_base&>(*tmp) = *x;
+    tmp->set_color(x->color());
     tmp->left = 0;
     tmp->right = 0;
     return tmp;
@@ -223,6 +397,70 @@ class rb_tree {
     put_node(p);
   }
 
+  // _copy的节点来源：每次配置一个新节点
+  struct _alloc_node {
+    rb_tree& t;
+    explicit _alloc_node(rb_tree& tree) : t(tree) {}
+    link_type operator()(const value_type& v) { return t.create_node(v); }
+  };
+  // _copy的节点来源：优先取用从原树拆下的节点，用完后才配置新节点，
+  // 析构时释放没有用到的节点
+  struct _reuse_node {
+    rb_tree& t;
+    link_type nodes;  // 拆下的节点经right串成单链
+
+    // 逐次右旋把以x为根的子树拉直，不递归也不配置空间
+    _reuse_node(rb_tree& tree, link_type x) : t(tree), nodes(0) {
+      while (x != 0) {
+        if (x->left != 0) {
+          link_type y = left(x);
+          x->left = y->right;
+          y->right = x;
+          x = y;
+        } else {
+          link_type next = right(x);
+          x->right = nodes;
+          nodes = x;
+          x = next;
+        }
+      }
+    }
+    ~_reuse_node() {
+      while (nodes != 0) {
+        link_type next = right(nodes);
+        t.destroy_node(nodes);
+        nodes = next;
+      }
+    }
+    link_type operator()(const value_type& v) {
+      if (nodes == 0)
+        return t.create_node(v);
+      link_type x = nodes;
+      nodes = right(x);
+      try {
+        _assign(x, v, _is_assignable_value<value_type>());
+      } catch (...) {
+        t.put_node(x);
+        throw;
+      }
+      return x;
+    }
+    // 可赋值的元素直接覆盖，元素自己的空间（如字符串）也得以重用
+    static void _assign(link_type x, const value_type& v, std::true_type) {
+      try {
+        x->value_field = v;
+      } catch (...) {
+        destroy(&x->value_field);
+        throw;
+      }
+    }
+    // map的元素含const键值，只能析构后重新构造
+    static void _assign(link_type x, const value_type& v, std::false_type) {
+      destroy(&x->value_field);
+      construct(&x->value_field, v);
+    }
+  };
+
  protected:
   // RB-tree 只能以三笔数据表现
   size_type node_count;  // 追踪记录数的大小
@@ -235,21 +473,17 @@ class rb_tree {
   // 取得x的成员
   static link_type& left(link_type x) { return (link_type&)(x->left); }
   static link_type& right(link_type x) { return (link_type&)(x->right); }
-  static link_type& parent(link_type x) { return (link_type&)(x->parent); }
   static reference value(link_type x) { return x->value_field; }
   static const Key& key(link_type x) { return KeyOfValue()(value(x)); }
-  static color_type& color(link_type x) { return (color_type&)(x->color); }
   //==============================
   static link_type& left(base_ptr x) { return (link_type&)(x->left); }
   static link_type& right(base_ptr x) { return (link_type&)(x->right); }
-  static link_type& parent(base_ptr x) { return (link_type&)(x->parent); }
   static reference value(base_ptr x) { return ((link_type)x)->value_field; }
   static const Key& key(base_ptr x) {
     return KeyOfValue()(value(link_type(x)));
   }
-  static color_type& color(base_ptr x) { return (color_type&)(x->color); }
   // 求极大值和极小值
-  static link_type minimun(link_type x) {
+  static link_type minimum(link_type x) {
     return (link_type)_rb_tree_node_base::minimum(x);
   }
   static link_type maximum(link_type x) {
@@ -257,27 +491,172 @@ class rb_tree {
   }
 
  public:
-  typedef _rb_tree_iterator<value_type, reference, pointer> iterator;  // 迭代器
-  typedef _rb_tree_const_iterator<value_type, reference, pointer>
+  typedef _rb_tree_iterator<value_type, reference, pointer, rb_tree_node>
+      iterator;  // 迭代器
+  typedef _rb_tree_const_iterator<value_type, reference, pointer, rb_tree_node>
       const_iterator;                                            // 迭代器
   typedef ministl::reverse_iterator<iterator> reverse_iterator;  // 反向迭代器
   typedef ministl::reverse_iterator<const_iterator>
       const_reverse_iterator;  // 反向迭代器
+  // 节点句柄
+  typedef _node_handle<rb_tree_node,
+                       value_type,
+                       Alloc,
+                       &rb_tree_node::value_field>
+      node_type;
+
  private:
   iterator _insert(base_ptr x, base_ptr y, const value_type& v);
-  void _erase(link_type x);
-  link_type _copy(link_type x, link_type p);
-  void _clear(link_type x) {
+  // 将已构造好的节点z链接为y的子节点，insert_left决定左右
+  iterator _link(bool insert_left, link_type y, link_type z);
+  // 找出键值k的插入位置：可插入时返回(父节点, true)，否则返回(相等的节点, false)
+  pair<link_type, bool> _unique_pos(const Key& k);
+  // 将z从树中摘下并重新平衡，不销毁z，其余节点的位置不受影响
+  link_type _unlink(link_type z) {
+    --node_count;
+    return (link_type)_rb_tree_rebalance_for_erase<Augment>(
+        z, (base_ptr&)root(), header->left, header->right);
+  }
+  // 复制以x为根的子树，挂在p之下，节点由gen提供
+  template <class NodeGen>
+  link_type _copy(link_type x, link_type p, NodeGen& gen);
+  link_type _copy(link_type x, link_type p) {
+    _alloc_node gen(*this);
+    return _copy(x, p, gen);
+  }
+  // 销毁以x为根的子树，不做任何平衡调整，返回销毁的节点数
+  size_type _clear(link_type x) {
+    size_type n = 0;
     while (x != 0) {
-      _erase(right(x));
+      MINISTL_PREFETCH(x->left);  // 处理右子树期间取左子节点
+      n += _clear(right(x)) + 1;
       link_type y = left(x);
       destroy_node(x);
       x = y;
     }
+    return n;
+  }
+
+  // 以下split/join操作不带header的独立子树，子树的根的parent没有意义
+  // 以x为根的子树中每条路径上的黑节点数
+  static size_type _black_height(base_ptr x) {
+    size_type h = 0;
+    for (; x != 0; x = x->left)
+      if (x->color() == _rb_tree_black)
+        ++h;
+    return h;
+  }
+  // 根染黑之后的黑高，以下各操作的高度都按此计算，空树为0
+  static size_type _root_height(base_ptr x) {
+    return _black_height(x) + (x != 0 && x->color() == _rb_tree_red);
+  }
+  static bool _is_red(base_ptr x) {
+    return x != 0 && x->color() == _rb_tree_red;
+  }
+  // 子树t的高度为ht时其子节点x的高度：x为黑时少一，为红时染黑后与t相同
+  static size_type _child_height(size_type ht, base_ptr x) {
+    return ht - 1 + (x != 0 && x->color() == _rb_tree_red);
+  }
+  // l中的键值都小于k，r中的都大于k，以k连接两者，返回新的根
+  // 由调用者给出l与r的高度，结果的高度经h返回，只需O(|hl - hr| + 1)，
+  // 递归中的各次join因此不必沿左脊重算高度
+  static base_ptr _join(base_ptr l,
+                        size_type hl,
+                        base_ptr k,
+                        base_ptr r,
+                        size_type hr,
+                        size_type& h);
+  // 连接l与r，l中的键值都小于r
+  static base_ptr _join2(base_ptr l,
+                         size_type hl,
+                         base_ptr r,
+                         size_type hr,
+                         size_type& h);
+  // 摘下t中的最大节点放到last，返回其余节点组成的树
+  static base_ptr _split_last(base_ptr t,
+                              size_type ht,
+                              base_ptr& last,
+                              size_type& h);
+  // 将t分为小于k的l与大于k的r，返回等于k的节点，没有时返回0
+  // ht为t的高度，hl与hr返回l与r的，共O(log n)
+  base_ptr _split(base_ptr t,
+                  size_type ht,
+                  const Key& k,
+                  base_ptr& l,
+                  size_type& hl,
+                  base_ptr& r,
+                  size_type& hr) const;
+  // 按位置分割：摘下t中的x，中序在其前后的节点分别组成l与r，键值可以重复
+  // ht为t的高度，hl与hr返回l与r的，共O(log n)
+  static void _split_at(base_ptr t,
+                        size_type ht,
+                        base_ptr x,
+                        base_ptr& l,
+                        size_type& hl,
+                        base_ptr& r,
+                        size_type& hr);
+  // path[d - 1], ..., path[0]为t之下通往x的各节点
+  static void _split_path(base_ptr t,
+                          size_type ht,
+                          base_ptr* path,
+                          size_type d,
+                          base_ptr& l,
+                          size_type& hl,
+                          base_ptr& r,
+                          size_type& hr);
+  // 集合运算，相同的键值保留a中的节点，不要的节点放入d，depth > 0时并行
+  // _union取用b的节点，_intersect与_difference只读b；ha、hb为a、b的高度，
+  // 结果的高度经h返回
+  base_ptr _union(base_ptr a,
+                  size_type ha,
+                  base_ptr b,
+                  size_type hb,
+                  _rb_tree_discard& d,
+                  int depth,
+                  size_type& h) const;
+  base_ptr _intersect(base_ptr a,
+                      size_type ha,
+                      base_ptr b,
+                      _rb_tree_discard& d,
+                      int depth,
+                      size_type& h) const;
+  base_ptr _difference(base_ptr a,
+                       size_type ha,
+                       base_ptr b,
+                       _rb_tree_discard& d,
+                       int depth,
+                       size_type& h) const;
+  // 销毁d中的节点，以集合运算的结果r作为本树，n为未销毁前两树的节点总数
+  void _assign_root(base_ptr r, size_type n, _rb_tree_discard& d);
+  // 以有序区间自底向上建树，见insert_unique(first, last)
+  template <class Iter>
+  link_type _build(Iter& first,
+                   size_type n,
+                   size_type depth,
+                   size_type red_depth,
+                   link_type p);
+  template <class ForwardIter>
+  void _assign_sorted(ForwardIter first, size_type n);
+  // 将以right串起的前n个节点按键值稳定排序，返回排好的链表，list前进到其后
+  link_type _sort_chain(link_type& list, size_type n);
+  // 从f起找出不小于k的第一个节点，f的键值须小于k；先向上找到能包含k的子树再向下
+  link_type _lower_bound_from(link_type f, const Key& k) const;
+  // 将z链接到j之前，j为header时链接到最后
+  void _link_before(link_type j, link_type z);
+  template <class ForwardIter>
+  void _insert_unique_range(ForwardIter first,
+                            ForwardIter last,
+                            forward_iterator_tag);
+  template <class InputIter>
+  void _insert_unique_range(InputIter first,
+                            InputIter last,
+                            input_iterator_tag) {
+    for (; first != last; ++first)
+      insert_unique(end(), *first);  // 以end()为提示，递增的部分只需一次比较
   }
   void init() {
     header = get_node();
-    color(header) = _rb_tree_red;  // 令header为红色，用来区分header
+    header->set_color(_rb_tree_red);  // 令header为红色，用来区分header
     root() = 0;
     leftmost() = header;
     rightmost() = header;
@@ -289,7 +668,7 @@ class rb_tree {
   }
   rb_tree(const rb_tree& x) : node_count(0), key_compare(x.key_compare) {
     header = get_node();  // 產生一個節點空間，令 header 指向它
-    color(header) = _rb_tree_red;  // 令 header 為紅色
+    header->set_color(_rb_tree_red);  // 令 header 為紅色
     if (x.root() == 0) {           //  如果 x 是個空白樹
       root() = 0;
       leftmost() = header;   // 令 header 的左子節點為自己。
@@ -299,31 +678,36 @@ class rb_tree {
         root() = _copy(x.root(), header);  // 调用copy函数
       } catch (...) {
         put_node(header);
+        throw;
       }
       leftmost() = minimum(root());  // 令 header 的左子節點為最小節點
       rightmost() = maximum(root());  // 令 header 的右子節點為最大節點
     }
     node_count = x.node_count;
   }
+  // 直接取走x的header，x换上一个新的空header，O(1)
+  rb_tree(rb_tree&& x)
+      : node_count(x.node_count), header(x.header), key_compare(x.key_compare) {
+    x.init();
+    x.node_count = 0;
+  }
   ~rb_tree() {
     clear();
     put_node(header);
   }
-  rb_tree<Key, Value, KeyOfValue, Compare, Alloc>& operator=(
-      const rb_tree<Key, Value, KeyOfValue, Compare, Alloc>& x) {
-    iterator first = x.begin();
-    iterator last = x.end();
-    while (first != last) {
-      insert_equal(*first);
-      first++;
-    }
+  // 按x的形状复制，重用本树已有的节点，只配置或释放两者节点数之差
+  rb_tree& operator=(const rb_tree& x);
+  // 与x交换全部节点，x的原有节点随后在x析构时释放
+  rb_tree& operator=(rb_tree&& x) {
+    swap(x);
+    return *this;
   }
 
  public:
   Compare key_comp() const { return key_compare; }
   // 迭代器
   iterator begin() { return leftmost(); }  // RB树的起点是最左节点处
-  const_iterator begin() const { return begin(); }
+  const_iterator begin() const { return leftmost(); }
   const_iterator cbegin() const { return begin(); }
   reverse_iterator rbegin() { return reverse_iterator(end()); }  // 反向
   const_reverse_iterator rbegin() const {
@@ -332,8 +716,13 @@ class rb_tree {
   const_reverse_iterator crbegin() const { return rbegin(); }
 
   iterator end() { return header; }  // 终点为header处
-  const_iterator end() const { return end(); }
+  const_iterator end() const { return header; }
   const_iterator cend() const { return end(); }
+  // 指向同一节点的iterator，供建在rb_tree之上、经const_iterator定位后
+  // 仍要修改元素（如计数）的容器使用，须由调用者保证不改动键值
+  iterator mutable_iterator(const_iterator it) {
+    return iterator((link_type)it.node);
+  }
   reverse_iterator rend() { return reverse_iterator(begin()); }  // 反向
   const_reverse_iterator rend() const {
     return const_reverse_iterator(begin());
@@ -343,27 +732,53 @@ class rb_tree {
   bool empty() const { return node_count == 0; }
   size_type size() const { return node_count; }
   size_type max_size() const { return size_type(-1); }
+  // 只交换header、节点数与比较器，O(1)，迭代器随节点转到另一棵树
   void swap(rb_tree& x) {
-    rb_tree tmp = x;
-    x = *this;
-    *this = tmp;
+    std::swap(header, x.header);
+    std::swap(node_count, x.node_count);
+    std::swap(key_compare, x.key_compare);
   }
 
  public:
   // 将x插入rb-tree中（节点独一无二)
   pair<iterator, bool> insert_unique(const value_type& x);
-  iterator insert_unique(iterator pos, const value_type& x) {
-    return _insert(pos.node, pos.node->parent, x);
-  }
+  // 以pos为提示插入x：x恰好应位于pos之前时只需常数次比较，否则退回完整查找
+  iterator insert_unique(iterator pos, const value_type& x);
+  // 空树且输入已严格递增时O(n)建树，否则逐个插入
   template <class Iter>
   void insert_unique(Iter first, Iter last) {
-    while (first < last) {
-      insert_unique(*first);
-      first++;
-    }
+    _insert_unique_range(first, last, iterator_category(first));
   }
+  // 由调用者保证[first,last)严格递增，空树时不再检查直接建树
+  template <class ForwardIter>
+  void insert_unique(sorted_unique_t, ForwardIter first, ForwardIter last) {
+    if (node_count == 0)
+      _assign_sorted(first, size_type(ministl::distance(first, last)));
+    else
+      insert_unique(first, last);
+  }
+  // 批量插入：先为整批构造节点并按键值排序，再按顺序并入树中，
+  // 每次从上一个插入点起查找（finger search），只需O(log d)步，d为两次插入点间的元素数
+  // 键值重复时与逐个插入相同，保留最先的一个；每次链接后的调整均摊O(1)，不必推迟
+  template <class InputIter>
+  void insert_unique_batch(InputIter first, InputIter last);
+  // 以args原地构造节点后插入，键值已存在时销毁该节点
+  template <class... Args>
+  pair<iterator, bool> emplace_unique(Args&&... args);
+  // 先以k查找，只在k不存在时才以args构造节点，k须等于所构造元素的键值
+  template <class... Args>
+  pair<iterator, bool> try_emplace_unique(const Key& k, Args&&... args);
   // 将x插入rb-tree中（允许节点重复）
   iterator insert_equal(const value_type& x);
+  // 由调用者保证[first,last)非递减，空树时直接建树，否则逐个插入
+  template <class ForwardIter>
+  void insert_equal(sorted_equivalent_t, ForwardIter first, ForwardIter last) {
+    if (node_count == 0)
+      _assign_sorted(first, size_type(ministl::distance(first, last)));
+    else
+      for (; first != last; ++first)
+        insert_equal(*first);
+  }
   // clear
   void clear() {
     if (node_count != 0) {
@@ -375,53 +790,188 @@ class rb_tree {
     }
   }
   // erase
-  size_type erase(const link_type& x) {
-    _erase(x);
-    return node_count;
-  }
-  void erase(iterator pos) { _erase(*pos); }
-  void erase(iterator first, iterator last) {
-    if ((last - first) == node_count)
-      clear();
-    else {
-      while (first != last) {
-        erase(*first);
-        first++;
-      }
+  size_type erase(const Key& k);
+  void erase(iterator pos) { destroy_node(_unlink((link_type)pos.node)); }
+  // 短的区间逐个删除，否则以两次split与一次join摘下整段，O(log n + k)
+  void erase(iterator first, iterator last);
+  // 删除pred(元素)为真的所有元素，中序一遍，返回删除的个数
+  // 每次删除的重新平衡均摊为O(1)，走过的节点仍在缓存中，比整棵重建快
+  template <class Predicate>
+  size_type erase_if(Predicate pred) {
+    size_type n = node_count;
+    for (iterator it = begin(); it != end();) {
+      if (pred(*it))
+        erase(it++);
+      else
+        ++it;
     }
+    return n - node_count;
+  }
+
+  // 摘下节点交给句柄，不释放节点
+  node_type extract(const_iterator pos) {
+    return node_type(_unlink((link_type)pos.node));
+  }
+  node_type extract(const Key& k) {
+    link_type x = _find(k);
+    return x == header ? node_type() : node_type(_unlink(x));
+  }
+  // 挂入句柄持有的节点，键值已存在时节点仍留在nh中
+  pair<iterator, bool> insert_unique(node_type&& nh);
+  // 将x中键值在本树中不存在的节点逐个转移过来，其余节点留在x中
+  void merge_unique(rb_tree& x);
+
+ private:
+  // 查找的实现，K为Key，或是透明比较器能与Key比较的任意型别
+  template <class K>
+  link_type _lower_bound(const K& k) const;
+  template <class K>
+  link_type _upper_bound(const K& k) const;
+  template <class K>
+  link_type _find(const K& k) const {
+    link_type j = _lower_bound(k);
+    return (j == header || key_compare(k, key(j))) ? header : j;
+  }
+  template <class K>
+  size_type _count(const K& k) const {
+    link_type last = _upper_bound(k);
+    size_type n = 0;
+    for (const_iterator first = _lower_bound(k); first.node != last; ++first)
+      ++n;
+    return n;
   }
+
+ public:
   // find
-  iterator find(const Key& k);
+  iterator find(const Key& k) { return _find(k); }
+  const_iterator find(const Key& k) const { return _find(k); }
   // 计算键值为x的节点的个数
-  size_type count(const Key& x);
+  size_type count(const Key& x) const { return _count(x); }
   // 提供了查询与某个键值相等的节点迭代器范围
-  pair<iterator, iterator> equal_range(const Key& x);
+  pair<iterator, iterator> equal_range(const Key& x) {
+    return pair<iterator, iterator>(_lower_bound(x), _upper_bound(x));
+  }
+  pair<const_iterator, const_iterator> equal_range(const Key& x) const {
+    return pair<const_iterator, const_iterator>(_lower_bound(x),
+                                                _upper_bound(x));
+  }
   // 返回不小于k的第一个节点迭代器
-  iterator lower_bound(const Key& x);
+  iterator lower_bound(const Key& x) { return _lower_bound(x); }
+  const_iterator lower_bound(const Key& x) const { return _lower_bound(x); }
   // 返回大于k的第一个节点迭代器
-  iterator upper_bound(const Key& x);
+  iterator upper_bound(const Key& x) { return _upper_bound(x); }
+  const_iterator upper_bound(const Key& x) const { return _upper_bound(x); }
+
+  // 比较器定义了is_transparent时，可直接以能与Key比较的其他型别查找，
+  // 例如以const char*查找string键，不必构造临时的Key
+  template <class K, class C = Compare, class = typename C::is_transparent>
+  iterator find(const K& k) {
+    return _find(k);
+  }
+  template <class K, class C = Compare, class = typename C::is_transparent>
+  const_iterator find(const K& k) const {
+    return _find(k);
+  }
+  template <class K, class C = Compare, class = typename C::is_transparent>
+  size_type count(const K& k) const {
+    return _count(k);
+  }
+  template <class K, class C = Compare, class = typename C::is_transparent>
+  pair<iterator, iterator> equal_range(const K& k) {
+    return pair<iterator, iterator>(_lower_bound(k), _upper_bound(k));
+  }
+  template <class K, class C = Compare, class = typename C::is_transparent>
+  pair<const_iterator, const_iterator> equal_range(const K& k) const {
+    return pair<const_iterator, const_iterator>(_lower_bound(k),
+                                                _upper_bound(k));
+  }
+  template <class K, class C = Compare, class = typename C::is_transparent>
+  iterator lower_bound(const K& k) {
+    return _lower_bound(k);
+  }
+  template <class K, class C = Compare, class = typename C::is_transparent>
+  const_iterator lower_bound(const K& k) const {
+    return _lower_bound(k);
+  }
+  template <class K, class C = Compare, class = typename C::is_transparent>
+  iterator upper_bound(const K& k) {
+    return _upper_bound(k);
+  }
+  template <class K, class C = Compare, class = typename C::is_transparent>
+  const_iterator upper_bound(const K& k) const {
+    return _upper_bound(k);
+  }
+
+  // 基于split/join的集合运算，两树大小为m <= n时为O(m log(n/m + 1))，
+  // 大的输入在前几层递归中并行；键值相同时保留本树的元素；比较器不得抛出异常
+  // 并集：x的节点被并入本树或被销毁，x成为空树
+  void union_with(rb_tree& x) {
+    if (&x == this)
+      return;
+    _rb_tree_discard d;
+    size_type n = node_count + x.node_count;
+    size_type h;
+    base_ptr r = _union(root(), _root_height(root()), x.root(),
+                        _root_height(x.root()), d, _rb_tree_parallel_depth(n),
+                        h);
+    x.root() = 0;
+    x.leftmost() = x.header;
+    x.rightmost() = x.header;
+    x.node_count = 0;
+    _assign_root(r, n, d);
+  }
+  // 交集与差集：只读x，本树中不要的节点被销毁
+  void intersect_with(const rb_tree& x) {
+    if (&x == this)
+      return;
+    _rb_tree_discard d;
+    int depth = _rb_tree_parallel_depth(node_count + x.node_count);
+    size_type h;
+    _assign_root(
+        _intersect(root(), _root_height(root()), x.root(), d, depth, h),
+        node_count, d);
+  }
+  void difference_with(const rb_tree& x) {
+    if (&x == this) {
+      clear();
+      return;
+    }
+    _rb_tree_discard d;
+    int depth = _rb_tree_parallel_depth(node_count + x.node_count);
+    size_type h;
+    _assign_root(
+        _difference(root(), _root_height(root()), x.root(), d, depth, h),
+        node_count, d);
+  }
+
+  // 顺序统计，只在Augment为_rb_tree_size_augment时可用，均为O(log n)
+  // 键值小于k的元素个数，即lower_bound(k)的位置
+  size_type rank(const Key& k) const;
+  // 第n个元素（从0起），n >= size()时返回end()
+  iterator select(size_type n) { return _select(n); }
+  const_iterator select(size_type n) const { return _select(n); }
+  // it之前的元素个数，end()为size()
+  size_type index_of(const_iterator it) const;
+  // 与distance(first, last)相同，但不必逐个走过
+  difference_type distance(const_iterator first, const_iterator last) const {
+    return difference_type(index_of(last)) - difference_type(index_of(first));
+  }
+
+ private:
+  link_type _select(size_type n) const;
 };
 
-// 计算RBTree的节点值为k的节点个数
-template <class Key, class Value, class KeyOfValue, class Compare, class Alloc>
-typename rb_tree<Key, Value, KeyOfValue, Compare, Alloc>::size_type
-rb_tree<Key, Value, KeyOfValue, Compare, Alloc>::count(const Key& k) {
-  pair<const_iterator, const_iterator> p = equal_range(k);
-  size_type n = 0;
-  distance(p.first, p.second, n);
-  return n;
-}
-// 查询与键值k相等的节点迭代器范围
-template <class Key, class Value, class KeyOfValue, class Compare, class Alloc>
-inline pair<typename rb_tree<Key, Value, KeyOfValue, Compare, Alloc>::iterator,
-            typename rb_tree<Key, Value, KeyOfValue, Compare, Alloc>::iterator>
-rb_tree<Key, Value, KeyOfValue, Compare, Alloc>::equal_range(const Key& k) {
-  return pair<iterator, iterator>(lower_bound(k), upper_bound(k));
-}
-// 返回不小于k的第一个节点迭代器
-template <class Key, class Value, class KeyOfValue, class Compare, class Alloc>
-typename rb_tree<Key, Value, KeyOfValue, Compare, Alloc>::iterator
-rb_tree<Key, Value, KeyOfValue, Compare, Alloc>::lower_bound(const Key& k) {
+// 返回不小于k的第一个节点
+template <class Key,
+          class Value,
+          class KeyOfValue,
+          class Compare,
+          class Alloc,
+          class Augment>
+template <class K>
+typename rb_tree<Key, Value, KeyOfValue, Compare, Alloc, Augment>::link_type
+rb_tree<Key, Value, KeyOfValue, Compare, Alloc, Augment>::_lower_bound(
+    const K& k) const {
   link_type y = header; /* Last node which is not less than k. */
   link_type x = root(); /* Current node. */
 
@@ -431,12 +981,19 @@ rb_tree<Key, Value, KeyOfValue, Compare, Alloc>::lower_bound(const Key& k) {
     else
       x = right(x);
 
-  return iterator(y);
+  return y;
 }
-// 返回大于k的第一个节点迭代器
-template <class Key, class Value, class KeyOfValue, class Compare, class Alloc>
-typename rb_tree<Key, Value, KeyOfValue, Compare, Alloc>::iterator
-rb_tree<Key, Value, KeyOfValue, Compare, Alloc>::upper_bound(const Key& k) {
+// 返回大于k的第一个节点
+template <class Key,
+          class Value,
+          class KeyOfValue,
+          class Compare,
+          class Alloc,
+          class Augment>
+template <class K>
+typename rb_tree<Key, Value, KeyOfValue, Compare, Alloc, Augment>::link_type
+rb_tree<Key, Value, KeyOfValue, Compare, Alloc, Augment>::_upper_bound(
+    const K& k) const {
   link_type y = header; /* Last node which is greater than k. */
   link_type x = root(); /* Current node. */
 
@@ -446,12 +1003,80 @@ rb_tree<Key, Value, KeyOfValue, Compare, Alloc>::upper_bound(const Key& k) {
     else
       x = right(x);
 
-  return iterator(y);
+  return y;
+}
+
+template <class Key,
+          class Value,
+          class KeyOfValue,
+          class Compare,
+          class Alloc,
+          class Augment>
+typename rb_tree<Key, Value, KeyOfValue, Compare, Alloc, Augment>::size_type
+rb_tree<Key, Value, KeyOfValue, Compare, Alloc, Augment>::rank(
+    const Key& k) const {
+  size_type r = 0;
+  link_type x = root();
+  while (x != 0)
+    if (key_compare(key(x), k)) {  // x及其左子树都小于k
+      r += Augment::size_of(x->left) + 1;
+      x = right(x);
+    } else
+      x = left(x);
+  return r;
+}
+
+template <class Key,
+          class Value,
+          class KeyOfValue,
+          class Compare,
+          class Alloc,
+          class Augment>
+typename rb_tree<Key, Value, KeyOfValue, Compare, Alloc, Augment>::link_type
+rb_tree<Key, Value, KeyOfValue, Compare, Alloc, Augment>::_select(
+    size_type n) const {
+  link_type x = root();
+  while (x != 0) {
+    size_type l = Augment::size_of(x->left);
+    if (n < l)
+      x = left(x);
+    else if (n == l)
+      return x;
+    else {
+      n -= l + 1;
+      x = right(x);
+    }
+  }
+  return header;
+}
+
+template <class Key,
+          class Value,
+          class KeyOfValue,
+          class Compare,
+          class Alloc,
+          class Augment>
+typename rb_tree<Key, Value, KeyOfValue, Compare, Alloc, Augment>::size_type
+rb_tree<Key, Value, KeyOfValue, Compare, Alloc, Augment>::index_of(
+    const_iterator it) const {
+  base_ptr x = it.node;
+  if (x == header)
+    return node_count;
+  size_type r = Augment::size_of(x->left);
+  for (; x != root(); x = x->parent)
+    if (x == x->parent->right)  // 父节点及其左子树都在x之前
+      r += Augment::size_of(x->parent->left) + 1;
+  return r;
 }
 
-template <class Key, class Value, class KeyOfValue, class Compare, class Alloc>
-typename rb_tree<Key, Value, KeyOfValue, Compare, Alloc>::iterator
-rb_tree<Key, Value, KeyOfValue, Compare, Alloc>::insert_equal(
+template <class Key,
+          class Value,
+          class KeyOfValue,
+          class Compare,
+          class Alloc,
+          class Augment>
+typename rb_tree<Key, Value, KeyOfValue, Compare, Alloc, Augment>::iterator
+rb_tree<Key, Value, KeyOfValue, Compare, Alloc, Augment>::insert_equal(
     const value_type& v) {
   link_type y = header;
   link_type x = root();  // 从根节点开始
@@ -464,46 +1089,168 @@ rb_tree<Key, Value, KeyOfValue, Compare, Alloc>::insert_equal(
   // x为新值插入点，y为插入点父节点，v为新值
 }
 
-template <class Key, class Value, class KeyOfValue, class Compare, class Alloc>
-pair<typename rb_tree<Key, Value, KeyOfValue, Compare, Alloc>::iterator, bool>
-rb_tree<Key, Value, KeyOfValue, Compare, Alloc>::insert_unique(
-    const value_type& v) {
+template <class Key,
+          class Value,
+          class KeyOfValue,
+          class Compare,
+          class Alloc,
+          class Augment>
+pair<typename rb_tree<Key, Value, KeyOfValue, Compare, Alloc, Augment>::
+         link_type,
+     bool>
+rb_tree<Key, Value, KeyOfValue, Compare, Alloc, Augment>::_unique_pos(
+    const Key& k) {
   link_type y = header;
   link_type x = root();
   bool comp = true;
   while (x != 0) {
     y = x;
-    comp = key_compare(KeyOfValue()(v), key(x));  // v小于目前节点
+    comp = key_compare(k, key(x));  // k小于目前节点
     x = comp ? left(x) : right(x);  // 大于的则往左走，小于等于往右走
   }
   // 离开之后，y所指就是插入点的父节点
   iterator j = iterator(y);
   if (comp)  // 如果离开while时comp为真（表示遇到大的，插入左侧）
     if (j == begin())  // 如果插入节点的父节点为最左节点
-      return pair<iterator, bool>(_insert(x, y, v), true);
-    // x为新值插入点，y为插入点父节点，v为新值
+      return pair<link_type, bool>(y, true);
     else    // 否则
       --j;  // 调整j
-  if (key_compare(key(j.node), KeyOfValue()(v)))
-    // 小于新值，插入右侧
-    return pair<iterator, bool>(_insert(x, y, v), true);
-  // x为新值插入点，y为插入点父节点，v为新值
+  if (key_compare(key(j.node), k))  // 小于新值，插入右侧
+    return pair<link_type, bool>(y, true);
   // 到此，新值一定与树种键值重复，那么就不插入
-  return pair<iterator, bool>(j, false);
+  return pair<link_type, bool>((link_type)j.node, false);
+}
+
+template <class Key,
+          class Value,
+          class KeyOfValue,
+          class Compare,
+          class Alloc,
+          class Augment>
+pair<typename rb_tree<Key, Value, KeyOfValue, Compare, Alloc, Augment>::
+         iterator,
+     bool>
+rb_tree<Key, Value, KeyOfValue, Compare, Alloc, Augment>::insert_unique(
+    const value_type& v) {
+  pair<link_type, bool> p = _unique_pos(KeyOfValue()(v));
+  if (!p.second)
+    return pair<iterator, bool>(iterator(p.first), false);
+  return pair<iterator, bool>(_insert(0, p.first, v), true);
+}
+
+template <class Key,
+          class Value,
+          class KeyOfValue,
+          class Compare,
+          class Alloc,
+          class Augment>
+template <class... Args>
+pair<typename rb_tree<Key, Value, KeyOfValue, Compare, Alloc, Augment>::
+         iterator,
+     bool>
+rb_tree<Key, Value, KeyOfValue, Compare, Alloc, Augment>::emplace_unique(
+    Args&&... args) {
+  link_type z = create_node(std::forward<Args>(args)...);
+  pair<link_type, bool> p;
+  try {
+    p = _unique_pos(key(z));
+  } catch (...) {
+    destroy_node(z);
+    throw;
+  }
+  if (!p.second) {
+    destroy_node(z);
+    return pair<iterator, bool>(iterator(p.first), false);
+  }
+  bool insert_left = p.first == header || key_compare(key(z), key(p.first));
+  return pair<iterator, bool>(_link(insert_left, p.first, z), true);
+}
+
+template <class Key,
+          class Value,
+          class KeyOfValue,
+          class Compare,
+          class Alloc,
+          class Augment>
+template <class... Args>
+pair<typename rb_tree<Key, Value, KeyOfValue, Compare, Alloc, Augment>::
+         iterator,
+     bool>
+rb_tree<Key, Value, KeyOfValue, Compare, Alloc, Augment>::try_emplace_unique(
+    const Key& k,
+    Args&&... args) {
+  pair<link_type, bool> p = _unique_pos(k);
+  if (!p.second)
+    return pair<iterator, bool>(iterator(p.first), false);
+  bool insert_left = p.first == header || key_compare(k, key(p.first));
+  link_type z = create_node(std::forward<Args>(args)...);
+  return pair<iterator, bool>(_link(insert_left, p.first, z), true);
+}
+
+template <class Key,
+          class Value,
+          class KeyOfValue,
+          class Compare,
+          class Alloc,
+          class Augment>
+typename rb_tree<Key, Value, KeyOfValue, Compare, Alloc, Augment>::iterator
+rb_tree<Key, Value, KeyOfValue, Compare, Alloc, Augment>::insert_unique(
+    iterator pos,
+    const value_type& v) {
+  if (pos.node == header->left) {  // begin()
+    if (node_count > 0 && key_compare(KeyOfValue()(v), key(pos.node)))
+      return _insert(pos.node, pos.node, v);  // x非空，插入pos左侧
+    return insert_unique(v).first;
+  }
+  if (pos.node == header) {  // end()，递增插入走这里
+    if (key_compare(key(rightmost()), KeyOfValue()(v)))
+      return _insert(0, rightmost(), v);
+    return insert_unique(v).first;
+  }
+  iterator before = pos;
+  --before;
+  if (key_compare(key(before.node), KeyOfValue()(v)) &&
+      key_compare(KeyOfValue()(v), key(pos.node))) {
+    // 新节点位于before与pos之间：挂在before的右侧或pos的左侧，二者必有其一为空
+    if (before.node->right == 0)
+      return _insert(0, before.node, v);
+    return _insert(pos.node, pos.node, v);
+  }
+  return insert_unique(v).first;  // 提示无效
 }
 
 // 真正插入
-template <class Key, class Value, class KeyOfValue, class Compare, class Alloc>
-typename rb_tree<Key, Value, KeyOfValue, Compare, Alloc>::iterator
-rb_tree<Key, Value, KeyOfValue, Compare, Alloc>::_insert(base_ptr x_,
-                                                         base_ptr y_,
-                                                         const value_type& v) {
+template <class Key,
+          class Value,
+          class KeyOfValue,
+          class Compare,
+          class Alloc,
+          class Augment>
+typename rb_tree<Key, Value, KeyOfValue, Compare, Alloc, Augment>::iterator
+rb_tree<Key, Value, KeyOfValue, Compare, Alloc, Augment>::_insert(
+    base_ptr x_,
+    base_ptr y_,
+    const value_type& v) {
   link_type x = (link_type)x_;
   link_type y = (link_type)y_;
-  link_type z;
   // key_compare是键值大小比较
-  if (y == header || x != 0 || key_compare(KeyOfValue()(v), key(y))) {
-    z = create_node(v);
+  bool insert_left =
+      y == header || x != 0 || key_compare(KeyOfValue()(v), key(y));
+  return _link(insert_left, y, create_node(v));
+}
+
+template <class Key,
+          class Value,
+          class KeyOfValue,
+          class Compare,
+          class Alloc,
+          class Augment>
+typename rb_tree<Key, Value, KeyOfValue, Compare, Alloc, Augment>::iterator
+rb_tree<Key, Value, KeyOfValue, Compare, Alloc, Augment>::_link(
+    bool insert_left,
+    link_type y,
+    link_type z) {
+  if (insert_left) {
     left(y) = z;  // 这使得当y为header时，leftmost = z
     if (y == header) {
       root() = z;
@@ -511,281 +1258,1060 @@ rb_tree<Key, Value, KeyOfValue, Compare, Alloc>::_insert(base_ptr x_,
     } else if (y == leftmost())  // 如果y为最左节点
       leftmost() = z;            // 维护leftmost，使它永远指向最左
   } else {
-    z = create_node(v);
     right(y) = z;  // 令新节点成为插入节点父节点的右子节点
     if (y == rightmost())
       rightmost() = z;  // 维护rightmost，使它永远指向最右
   }
-  parent(z) = y;  // 设定新节点的父节点
+  z->parent = y;  // 设定新节点的父节点
   left(z) = 0;
   right(z) = 0;
+  Augment::inserted(z, header->parent);
   // 颜色调整
-  _rb_tree_rebalance(z, header->parent);  // 参数一为新增节点，参数2为root
+  _rb_tree_rebalance<Augment>(z, (base_ptr&)root());  // 参数2为root
   ++node_count;
   return iterator(z);
 }
 
-template <class Key, class Value, class KeyOfValue, class Compare, class Alloc>
-typename rb_tree<Key, Value, KeyOfValue, Compare, Alloc>::iterator
-rb_tree<Key, Value, KeyOfValue, Compare, Alloc>::find(const Key& k) {
-  link_type y = header;
-  link_type x = root();
+template <class Key,
+          class Value,
+          class KeyOfValue,
+          class Compare,
+          class Alloc,
+          class Augment>
+typename rb_tree<Key, Value, KeyOfValue, Compare, Alloc, Augment>::size_type
+rb_tree<Key, Value, KeyOfValue, Compare, Alloc, Augment>::erase(const Key& k) {
+  size_type n = node_count;
+  erase(iterator(_lower_bound(k)), iterator(_upper_bound(k)));
+  return n - node_count;
+}
 
-  while (x != 0) {
-    if (!key_compare(key(x), k))
-      y = x, x = left(x);
-    else
-      x = right(x);
+template <class Key,
+          class Value,
+          class KeyOfValue,
+          class Compare,
+          class Alloc,
+          class Augment>
+void rb_tree<Key, Value, KeyOfValue, Compare, Alloc, Augment>::erase(
+    iterator first,
+    iterator last) {
+  if (first == begin() && last == end()) {
+    clear();
+    return;
   }
-  iterator j = iterator(y);
-  return (j == end() || key_compare(k, key(j.node))) ? end() : j;
-}
-
-template <class Key, class Value, class KeyOfValue, class Compare, class Alloc>
-void rb_tree<Key, Value, KeyOfValue, Compare, Alloc>::_erase(link_type x) {
-  if (x->left == 0 && x->right == 0) {
-    if (x->color == _rb_tree_red) {  // 组合1，删除红色叶节点，直接删除
-      if (leftmost() == x)
-        leftmost() = (link_type)x->parent;
-      else if (rightmost() == x)
-        rightmost() = (link_type)x->parent;
-    } else {              // 组合2，最麻烦的情况
-      if (root() == x) {  // 删除根节点
-        root() = 0;
-        leftmost() = header;
-        rightmost() = header;
-      } else {  // 否则调用处理函数，此时x一定有兄弟节点
-        _erase_rebalance(x, header->parent);
-
-        if (leftmost() == x)
-          leftmost() = (link_type)x->parent;
-        if (rightmost() == x)
-          rightmost() = (link_type)x->parent;
-      }
-    }
-    if (x->parent->left == x)
-      x->parent->left = 0;
-    else
-      x->parent->right = 0;
-    destroy_node(x);
-    --node_count;
-  } else if (
-      x->left ==
-      0) {  // 组合4，x是黑节点，它的右孩子是红节点（因为组合3不可能存在）
-    link_type son = (link_type)x->right;
-    son->parent = x->parent;
-    son->color = _rb_tree_black;
-
-    if (x->parent->left == x)
-      x->parent->left = son;
-    else
-      x->parent->right = son;
+  // 逐个删除每个节点只需均摊O(1)的调整，区间短时比分割合并省事
+  iterator it = first;
+  for (size_type k = 0; it != last && k < _rb_tree_split_cutoff; ++k)
+    ++it;
+  if (it == last) {
+    while (first != last)
+      erase(first++);
+    return;
+  }
+  // 摘下first得到l与m，再从m中摘下last得到要删除的部分与r，最后以last连接l与r
+  base_ptr x = first.node;
+  base_ptr y = last.node;
+  base_ptr l, m, r;
+  size_type hl, hm, hr, h;
+  _split_at(root(), _root_height(root()), x, l, hl, m, hm);
+  _rb_tree_discard d;
+  d.push(x);
+  if (y == header) {
+    d.push(m);
+    _assign_root(l, node_count, d);
+    return;
+  }
+  base_ptr dead;
+  size_type hd;
+  _split_at(m, hm, y, dead, hd, r, hr);
+  d.push(dead);
+  _assign_root(_join(l, hl, y, r, hr, h), node_count, d);
+}
 
-    if (root() == x) {  // 如果删除的是根节点，要调整
-      root() = son;
-    }
-    if (leftmost() == x)
-      leftmost() = son;
-    destroy_node(x);
-    --node_count;
-  } else if (
-      x->right ==
-      0) {  // 一定是组合4：x是黑节点，它的左孩子是红节点（因为组合3不可能存在）
-    link_type son = (link_type)x->left;
-    son->parent = x->parent;
-    son->color = _rb_tree_black;
-
-    if (x->parent->left == x)
-      x->parent->left = son;
-    else
-      x->parent->right = son;
+template <class Key,
+          class Value,
+          class KeyOfValue,
+          class Compare,
+          class Alloc,
+          class Augment>
+pair<typename rb_tree<Key, Value, KeyOfValue, Compare, Alloc, Augment>::
+         iterator,
+     bool>
+rb_tree<Key, Value, KeyOfValue, Compare, Alloc, Augment>::insert_unique(
+    node_type&& nh) {
+  if (nh.empty())
+    return pair<iterator, bool>(end(), false);
+  link_type z = nh._node();
+  pair<link_type, bool> p = _unique_pos(key(z));
+  if (!p.second)
+    return pair<iterator, bool>(iterator(p.first), false);
+  bool insert_left = p.first == header || key_compare(key(z), key(p.first));
+  return pair<iterator, bool>(_link(insert_left, p.first, nh._release()),
+                              true);
+}
 
-    if (root() == x) {
-      root() = son;
-    }
-    destroy_node(x);
-    --node_count;
-  } else {
-    iterator it = iterator(x);
+template <class Key,
+          class Value,
+          class KeyOfValue,
+          class Compare,
+          class Alloc,
+          class Augment>
+void rb_tree<Key, Value, KeyOfValue, Compare, Alloc, Augment>::merge_unique(
+    rb_tree& x) {
+  if (&x == this)
+    return;
+  for (iterator it = x.begin(); it != x.end();) {
+    link_type z = (link_type)it.node;
     ++it;
-    x->value_field = *it;
-
-    _erase((link_type)it.node);
+    pair<link_type, bool> p = _unique_pos(key(z));
+    if (p.second) {
+      bool insert_left =
+          p.first == header || key_compare(key(z), key(p.first));
+      _link(insert_left, p.first, x._unlink(z));
+    }
   }
 }
 
-template <class K, class V, class KeyOfValue, class Compare, class Alloc>
-typename rb_tree<K, V, KeyOfValue, Compare, Alloc>::link_type
-rb_tree<K, V, KeyOfValue, Compare, Alloc>::_copy(link_type x, link_type p) {
-  link_type top = clone_node(x);  // 克隆root节点
-  top->parent = p;                // 将root节点父节点指向p
-                                  // 以下为非递归的二叉树复制过程
+template <class K,
+          class V,
+          class KeyOfValue,
+          class Compare,
+          class Alloc,
+          class Augment>
+template <class NodeGen>
+typename rb_tree<K, V, KeyOfValue, Compare, Alloc, Augment>::link_type
+rb_tree<K, V, KeyOfValue, Compare, Alloc, Augment>::_copy(link_type x,
+                                                          link_type p,
+                                                          NodeGen& gen) {
+  MINISTL_PREFETCH(x->left);           // 复制右子树期间取左子节点
+  link_type top = clone_node(x, gen);  // 克隆root节点
+  top->parent = p;                     // 将root节点父节点指向p
+                                       // 以下为非递归的二叉树复制过程
   try {
     if (x->right)
-      top->right = __copy(right(x), top);  // 一直copy右子节点
+      top->right = _copy(right(x), top, gen);  // 一直copy右子节点
     p = top;
     x = left(x);  // 取左节点
 
-    while (x != 0) {                // 左子节点不为空
-      link_type y = clone_node(x);  // 克隆左子节点
-      p->left = y;                  // p的左子节点设为y
-      y->parent = p;                // y的父节点设为p
+    while (x != 0) {                     // 左子节点不为空
+      MINISTL_PREFETCH(x->left);
+      link_type y = clone_node(x, gen);  // 克隆左子节点
+      p->left = y;                       // p的左子节点设为y
+      y->parent = p;                     // y的父节点设为p
       if (x->right)  // 如果左子节点还有右子节点，继续复制
-        y->right = __copy(right(x), y);
+        y->right = _copy(right(x), y, gen);
       p = y;  // 直到没有左子节点
       x = left(x);
     }
   } catch (...) {
-    _erase(top);
+    _clear(top);
+    throw;
   };
 
   return top;
 }
 
-// 全局函数，用于树平衡
+template <class K,
+          class V,
+          class KeyOfValue,
+          class Compare,
+          class Alloc,
+          class Augment>
+rb_tree<K, V, KeyOfValue, Compare, Alloc, Augment>&
+rb_tree<K, V, KeyOfValue, Compare, Alloc, Augment>::operator=(
+    const rb_tree& x) {
+  if (this != &x) {
+    // 先把原有节点全部拆下，复制途中出错时本树保持为空树
+    _reuse_node gen(*this, root());
+    root() = 0;
+    leftmost() = header;
+    rightmost() = header;
+    node_count = 0;
+    key_compare = x.key_compare;
+    if (x.root() != 0) {
+      root() = _copy(x.root(), header, gen);
+      leftmost() = minimum(root());
+      rightmost() = maximum(root());
+      node_count = x.node_count;
+    }
+  }  // 离开作用域时gen释放用剩的节点
+  return *this;
+}
 
-inline void _rb_tree_rotate_left(_rb_tree_node_base* x,
-                                 _rb_tree_node_base*& root);
-inline void _rb_tree_rotate_right(_rb_tree_node_base* x,
-                                  _rb_tree_node_base*& root);
-//===============================
-inline void _erase_rebalance(_rb_tree_node_base* x, _rb_tree_node_base*& root) {
-  _rb_tree_node_base* brother;
-  if (x == x->parent->left)
-    brother = x->parent->right;
-  else
-    brother = x->parent->left;
-  if (brother->color == _rb_tree_black) {
-    if ((brother->left && brother->left->color == _rb_tree_red) ||
-        (brother->right && brother->right->color == _rb_tree_red)) {
-      if (brother == x->parent->right) {
-        if (brother->right != 0) {
-          _rb_tree_rotate_left(x->parent, root);
-          brother->right->color = _rb_tree_black;
-          brother->color = x->parent->color;
-          x->parent->color = _rb_tree_black;
-        } else {
-          _rb_tree_rotate_right(brother, root);
-          brother->color = _rb_tree_red;
-          brother->parent->color = _rb_tree_black;
+template <class Key,
+          class Value,
+          class KeyOfValue,
+          class Compare,
+          class Alloc,
+          class Augment>
+typename rb_tree<Key, Value, KeyOfValue, Compare, Alloc, Augment>::base_ptr
+rb_tree<Key, Value, KeyOfValue, Compare, Alloc, Augment>::_join(
+    base_ptr l,
+    size_type hl,
+    base_ptr k,
+    base_ptr r,
+    size_type hr,
+    size_type& h) {
+  if (l != 0) {
+    l->parent = 0;
+    l->set_color(_rb_tree_black);  // 根染黑仍是合法的红黑树
+  }
+  if (r != 0) {
+    r->parent = 0;
+    r->set_color(_rb_tree_black);
+  }
+  if (hl == hr) {  // 等高，k直接作为根
+    k->parent = 0;
+    k->left = l;
+    k->right = r;
+    if (l != 0)
+      l->parent = k;
+    if (r != 0)
+      r->parent = k;
+    k->set_color(_rb_tree_black);
+    Augment::update(k);
+    h = hl + 1;
+    return k;
+  }
+  // 沿较高者的右（左）脊下行，找到黑高与另一棵相同的黑节点c，
+  // 以红节点k取代c，c与另一棵树分别成为k的两个子节点，再按插入的方式调整
+  base_ptr root = hl > hr ? l : r;
+  const size_type top = hl > hr ? hl : hr;
+  base_ptr p = 0;
+  base_ptr c = root;
+  h = hl > hr ? hl : hr;
+  size_type target = hl > hr ? hr : hl;
+  while (!(h == target && (c == 0 || c->color() == _rb_tree_black))) {
+    if (c->color() == _rb_tree_black)
+      --h;
+    p = c;
+    c = hl > hr ? c->right : c->left;
+  }
+  if (hl > hr) {
+    k->left = c;
+    k->right = r;
+    if (r != 0)
+      r->parent = k;
+    p->right = k;
+  } else {
+    k->left = l;
+    k->right = c;
+    if (l != 0)
+      l->parent = k;
+    p->left = k;
+  }
+  if (c != 0)
+    c->parent = k;
+  k->parent = p;
+  for (base_ptr x = k; x != 0; x = x->parent)  // 先更新路径上的附加信息
+    Augment::update(x);
+  // 只有红红冲突上溯到根、根的两个红子节点被染黑时黑高才加一；
+  // 旋转到根时根会换掉，黑高不变。据此O(1)得出结果的黑高，不必自根重算
+  const base_ptr old_root = root;
+  const bool red_children = _is_red(root->left) && _is_red(root->right);
+  _rb_tree_rebalance<Augment>(k, root);
+  h = top + (root == old_root && red_children && !_is_red(root->left) &&
+             !_is_red(root->right));
+  return root;
+}
 
-          _erase_rebalance(x, root);
-        }
-      } else {
-        if (brother->left != 0) {
-          _rb_tree_rotate_right(x->parent, root);
-          brother->left->color = _rb_tree_black;
-          brother->color = x->parent->color;
-          x->parent->color = _rb_tree_black;
-        } else {
-          _rb_tree_rotate_left(brother, root);
-          brother->color = _rb_tree_red;
-          brother->parent->color = _rb_tree_black;
+template <class Key,
+          class Value,
+          class KeyOfValue,
+          class Compare,
+          class Alloc,
+          class Augment>
+typename rb_tree<Key, Value, KeyOfValue, Compare, Alloc, Augment>::base_ptr
+rb_tree<Key, Value, KeyOfValue, Compare, Alloc, Augment>::_join2(
+    base_ptr l,
+    size_type hl,
+    base_ptr r,
+    size_type hr,
+    size_type& h) {
+  if (l == 0) {
+    h = hr;
+    return r;
+  }
+  if (r == 0) {
+    h = hl;
+    return l;
+  }
+  base_ptr last;
+  l = _split_last(l, hl, last, hl);
+  return _join(l, hl, last, r, hr, h);
+}
 
-          _erase_rebalance(x, root);
-        }
-      }
+template <class Key,
+          class Value,
+          class KeyOfValue,
+          class Compare,
+          class Alloc,
+          class Augment>
+typename rb_tree<Key, Value, KeyOfValue, Compare, Alloc, Augment>::base_ptr
+rb_tree<Key, Value, KeyOfValue, Compare, Alloc, Augment>::_split_last(
+    base_ptr t,
+    size_type ht,
+    base_ptr& last,
+    size_type& h) {
+  base_ptr l = t->left;
+  base_ptr r = t->right;
+  size_type hl = _child_height(ht, l);
+  if (r == 0) {
+    last = t;
+    t->left = 0;
+    h = hl;
+    return l;
+  }
+  size_type hr;
+  r = _split_last(r, _child_height(ht, r), last, hr);
+  return _join(l, hl, t, r, hr, h);
+}
+
+template <class Key,
+          class Value,
+          class KeyOfValue,
+          class Compare,
+          class Alloc,
+          class Augment>
+typename rb_tree<Key, Value, KeyOfValue, Compare, Alloc, Augment>::base_ptr
+rb_tree<Key, Value, KeyOfValue, Compare, Alloc, Augment>::_split(
+    base_ptr t,
+    size_type ht,
+    const Key& k,
+    base_ptr& l,
+    size_type& hl,
+    base_ptr& r,
+    size_type& hr) const {
+  if (t == 0) {
+    l = r = 0;
+    hl = hr = 0;
+    return 0;
+  }
+  base_ptr tl = t->left;
+  base_ptr tr = t->right;
+  size_type htl = _child_height(ht, tl);
+  size_type htr = _child_height(ht, tr);
+  if (key_compare(k, key(t))) {  // t与其右子树都在r中
+    base_ptr m;
+    size_type hm;
+    base_ptr eq = _split(tl, htl, k, l, hl, m, hm);
+    r = _join(m, hm, t, tr, htr, hr);
+    return eq;
+  }
+  if (key_compare(key(t), k)) {  // t与其左子树都在l中
+    base_ptr m;
+    size_type hm;
+    base_ptr eq = _split(tr, htr, k, m, hm, r, hr);
+    l = _join(tl, htl, t, m, hm, hl);
+    return eq;
+  }
+  l = tl;
+  hl = htl;
+  r = tr;
+  hr = htr;
+  t->left = t->right = 0;
+  return t;
+}
+
+template <class Key,
+          class Value,
+          class KeyOfValue,
+          class Compare,
+          class Alloc,
+          class Augment>
+void rb_tree<Key, Value, KeyOfValue, Compare, Alloc, Augment>::_split_at(
+    base_ptr t,
+    size_type ht,
+    base_ptr x,
+    base_ptr& l,
+    size_type& hl,
+    base_ptr& r,
+    size_type& hr) {
+  // 树高不超过2log(n + 1)，先沿parent记下x到t的路径
+  base_ptr path[2 * sizeof(size_type) * 8];
+  size_type d = 0;
+  for (base_ptr y = x; y != t; y = y->parent)
+    path[d++] = y;
+  _split_path(t, ht, path, d, l, hl, r, hr);
+  x->left = x->right = 0;
+}
+
+template <class Key,
+          class Value,
+          class KeyOfValue,
+          class Compare,
+          class Alloc,
+          class Augment>
+void rb_tree<Key, Value, KeyOfValue, Compare, Alloc, Augment>::_split_path(
+    base_ptr t,
+    size_type ht,
+    base_ptr* path,
+    size_type d,
+    base_ptr& l,
+    size_type& hl,
+    base_ptr& r,
+    size_type& hr) {
+  base_ptr tl = t->left;
+  base_ptr tr = t->right;
+  size_type htl = _child_height(ht, tl);
+  size_type htr = _child_height(ht, tr);
+  if (d == 0) {  // t即x
+    l = tl;
+    hl = htl;
+    r = tr;
+    hr = htr;
+    return;
+  }
+  base_ptr m;
+  size_type hm;
+  if (path[d - 1] == tl) {
+    _split_path(tl, htl, path, d - 1, l, hl, m, hm);
+    r = _join(m, hm, t, tr, htr, hr);
+  } else {
+    _split_path(tr, htr, path, d - 1, m, hm, r, hr);
+    l = _join(tl, htl, t, m, hm, hl);
+  }
+}
+
+template <class Key,
+          class Value,
+          class KeyOfValue,
+          class Compare,
+          class Alloc,
+          class Augment>
+typename rb_tree<Key, Value, KeyOfValue, Compare, Alloc, Augment>::base_ptr
+rb_tree<Key, Value, KeyOfValue, Compare, Alloc, Augment>::_union(
+    base_ptr a,
+    size_type ha,
+    base_ptr b,
+    size_type hb,
+    _rb_tree_discard& d,
+    int depth,
+    size_type& h) const {
+  if (a == 0) {
+    h = hb;
+    return b;
+  }
+  if (b == 0) {
+    h = ha;
+    return a;
+  }
+  base_ptr bl, br;
+  size_type hbl, hbr;
+  d.push(_split(b, hb, key(a), bl, hbl, br, hbr));  // b中与a的根相等的节点不要
+  base_ptr al = a->left;
+  base_ptr ar = a->right;
+  size_type hal = _child_height(ha, al);
+  size_type har = _child_height(ha, ar);
+  base_ptr l, r;
+  size_type hl, hr;
+  _rb_tree_discard dr;
+  _rb_tree_par_do(
+      depth > 0, [&] { l = _union(al, hal, bl, hbl, d, depth - 1, hl); },
+      [&] { r = _union(ar, har, br, hbr, dr, depth - 1, hr); });
+  d.splice(dr);
+  return _join(l, hl, a, r, hr, h);
+}
+
+template <class Key,
+          class Value,
+          class KeyOfValue,
+          class Compare,
+          class Alloc,
+          class Augment>
+typename rb_tree<Key, Value, KeyOfValue, Compare, Alloc, Augment>::base_ptr
+rb_tree<Key, Value, KeyOfValue, Compare, Alloc, Augment>::_intersect(
+    base_ptr a,
+    size_type ha,
+    base_ptr b,
+    _rb_tree_discard& d,
+    int depth,
+    size_type& h) const {
+  h = 0;
+  if (a == 0)
+    return 0;
+  if (b == 0) {
+    d.push(a);
+    return 0;
+  }
+  base_ptr al, ar;
+  size_type hal, har;
+  base_ptr eq = _split(a, ha, key(b), al, hal, ar, har);
+  base_ptr l, r;
+  size_type hl, hr;
+  _rb_tree_discard dr;
+  _rb_tree_par_do(
+      depth > 0, [&] { l = _intersect(al, hal, b->left, d, depth - 1, hl); },
+      [&] { r = _intersect(ar, har, b->right, dr, depth - 1, hr); });
+  d.splice(dr);
+  if (eq != 0)  // a中与b的根相等的节点保留
+    return _join(l, hl, eq, r, hr, h);
+  return _join2(l, hl, r, hr, h);
+}
+
+template <class Key,
+          class Value,
+          class KeyOfValue,
+          class Compare,
+          class Alloc,
+          class Augment>
+typename rb_tree<Key, Value, KeyOfValue, Compare, Alloc, Augment>::base_ptr
+rb_tree<Key, Value, KeyOfValue, Compare, Alloc, Augment>::_difference(
+    base_ptr a,
+    size_type ha,
+    base_ptr b,
+    _rb_tree_discard& d,
+    int depth,
+    size_type& h) const {
+  if (a == 0 || b == 0) {
+    h = ha;
+    return a;
+  }
+  base_ptr al, ar;
+  size_type hal, har;
+  d.push(_split(a, ha, key(b), al, hal, ar, har));  // a中与b的根相等的节点不要
+  base_ptr l, r;
+  size_type hl, hr;
+  _rb_tree_discard dr;
+  _rb_tree_par_do(
+      depth > 0, [&] { l = _difference(al, hal, b->left, d, depth - 1, hl); },
+      [&] { r = _difference(ar, har, b->right, dr, depth - 1, hr); });
+  d.splice(dr);
+  return _join2(l, hl, r, hr, h);
+}
+
+template <class Key,
+          class Value,
+          class KeyOfValue,
+          class Compare,
+          class Alloc,
+          class Augment>
+void rb_tree<Key, Value, KeyOfValue, Compare, Alloc, Augment>::_assign_root(
+    base_ptr r,
+    size_type n,
+    _rb_tree_discard& d) {
+  for (base_ptr t = d.head; t != 0;) {
+    base_ptr next = t->parent;
+    n -= _clear((link_type)t);
+    t = next;
+  }
+  header->parent = r;
+  if (r != 0) {
+    r->parent = header;
+    r->set_color(_rb_tree_black);
+    leftmost() = minimum((link_type)r);
+    rightmost() = maximum((link_type)r);
+  } else {
+    leftmost() = header;
+    rightmost() = header;
+  }
+  node_count = n;
+}
+
+template <class K,
+          class V,
+          class KeyOfValue,
+          class Compare,
+          class Alloc,
+          class Augment>
+template <class ForwardIter>
+void rb_tree<K, V, KeyOfValue, Compare, Alloc, Augment>::_insert_unique_range(
+    ForwardIter first,
+    ForwardIter last,
+    forward_iterator_tag) {
+  if (first == last)
+    return;
+  if (node_count == 0) {
+    // 扫描一遍，检查是否严格递增并计数
+    size_type n = 1;
+    ForwardIter prev = first;
+    ForwardIter cur = first;
+    for (++cur; cur != last; ++cur, ++prev, ++n)
+      if (!key_compare(KeyOfValue()(*prev), KeyOfValue()(*cur)))
+        break;
+    if (cur == last) {
+      _assign_sorted(first, n);
+      return;
+    }
+  }
+  for (; first != last; ++first)
+    insert_unique(end(), *first);  // 以end()为提示，递增的部分只需一次比较
+}
+template <class K,
+          class V,
+          class KeyOfValue,
+          class Compare,
+          class Alloc,
+          class Augment>
+template <class InputIter>
+void rb_tree<K, V, KeyOfValue, Compare, Alloc, Augment>::insert_unique_batch(
+    InputIter first,
+    InputIter last) {
+  link_type list = 0;  // 新节点经right串起，次序与输入相同
+  link_type* tail = &list;
+  size_type n = 0;
+  try {
+    for (; first != last; ++first, ++n) {
+      link_type z = create_node(*first);
+      right(z) = 0;
+      *tail = z;
+      tail = &right(z);
+    }
+  } catch (...) {
+    while (list != 0) {
+      link_type next = right(list);
+      destroy_node(list);
+      list = next;
+    }
+    throw;
+  }
+  if (n == 0)
+    return;
+  // 一批相对于树太小时，相邻两个键值在树中相隔太远，finger search与完整查找
+  // 经过的层数相当，不如省下排序，按输入次序逐个查找
+  bool sorted = n * _rb_tree_batch_ratio >= node_count;
+  link_type z = sorted ? _sort_chain(list, n) : list;
+  link_type f = 0;  // 上一个插入点，排过序时其键值小于下一个要插入的键值
+  while (z != 0) {
+    link_type next = right(z);
+    const K& k = key(z);
+    if (sorted && f != 0 && !key_compare(key(f), k)) {  // 与前一个键值相同
+      destroy_node(z);
     } else {
-      if (x == root)
-        return;
-      if (x->parent->color == _rb_tree_red) {
-        x->parent->color = _rb_tree_black;
-        brother->color = _rb_tree_red;
+      link_type j =
+          sorted && f != 0 ? _lower_bound_from(f, k) : _lower_bound(k);
+      if (j != header && !key_compare(k, key(j))) {  // 树中已有此键值
+        destroy_node(z);
+        f = j;
       } else {
-        brother->color = _rb_tree_red;
-        _erase_rebalance(x->parent, root);
+        _link_before(j, z);
+        f = z;
       }
     }
-  } else {
-    if (brother == x->parent->right) {
-      _rb_tree_rotate_left(x->parent, root);
+    z = next;
+  }
+}
+
+template <class K,
+          class V,
+          class KeyOfValue,
+          class Compare,
+          class Alloc,
+          class Augment>
+typename rb_tree<K, V, KeyOfValue, Compare, Alloc, Augment>::link_type
+rb_tree<K, V, KeyOfValue, Compare, Alloc, Augment>::_sort_chain(link_type& list,
+                                                       size_type n) {
+  if (n == 1) {
+    link_type x = list;
+    list = right(x);
+    right(x) = 0;
+    return x;
+  }
+  link_type a = _sort_chain(list, n / 2);
+  link_type b = _sort_chain(list, n - n / 2);
+  link_type head;
+  link_type* tail = &head;
+  while (a != 0 && b != 0) {
+    if (key_compare(key(b), key(a))) {  // 相等时先取a，保持稳定
+      *tail = b;
+      tail = &right(b);
+      b = right(b);
     } else {
-      _rb_tree_rotate_right(x->parent, root);
+      *tail = a;
+      tail = &right(a);
+      a = right(a);
     }
-    brother->color = _rb_tree_black;
-    x->parent->color = _rb_tree_red;
+  }
+  *tail = a != 0 ? a : b;
+  return head;
+}
 
-    _erase_rebalance(x, root);
+template <class K,
+          class V,
+          class KeyOfValue,
+          class Compare,
+          class Alloc,
+          class Augment>
+typename rb_tree<K, V, KeyOfValue, Compare, Alloc, Augment>::link_type
+rb_tree<K, V, KeyOfValue, Compare, Alloc, Augment>::_lower_bound_from(
+    link_type f,
+    const K& k) const {
+  if (key_compare(key(rightmost()), k))  // 递增地追加时不必上溯
+    return header;
+  // x是左子节点且父节点不小于k时，答案在x的子树中或就是父节点
+  base_ptr x = f;
+  link_type y = header;
+  while (x != root()) {
+    base_ptr p = x->parent;
+    if (x == p->left && !key_compare(key(p), k)) {
+      y = (link_type)p;
+      break;
+    }
+    x = p;
   }
+  while (x != 0) {
+    if (!key_compare(key(x), k)) {
+      y = (link_type)x;
+      x = x->left;
+    } else
+      x = x->right;
+  }
+  return y;
 }
-// ==============================
 
-inline void _rb_tree_rebalance(_rb_tree_node_base* x,
-                               _rb_tree_node_base*& root) {
-  x->color = _rb_tree_red;                                 // 新节点必为红
-  while (x != root && x->parent->color == _rb_tree_red) {  // 父节点为红
-    if (x->parent == x->parent->parent->left) {  // 父节点为祖父节点左子节点
-      _rb_tree_node_base* y = x->parent->parent->right;  // 令y为伯父节点
-      if (y && y->color == _rb_tree_red) {  // 伯父节点存在，且为红
-        x->parent->color = _rb_tree_black;  // 更改父节点为黑
-        y->color = _rb_tree_black;          // 更改伯父节点为黑
-        x->parent->parent->color = _rb_tree_red;  // 祖父节点为红
-        x = x->parent->parent;
-      } else {                        // 伯父节点不存在，或为黑
-        if (x == x->parent->right) {  // 如果新节点为父节点的右节点
-          x = x->parent;
-          _rb_tree_rotate_left(x, root);  // 第一参数为左旋点
+template <class K,
+          class V,
+          class KeyOfValue,
+          class Compare,
+          class Alloc,
+          class Augment>
+void rb_tree<K, V, KeyOfValue, Compare, Alloc, Augment>::_link_before(
+    link_type j,
+    link_type z) {
+  if (j == header) {
+    if (root() == 0)
+      _link(true, header, z);
+    else
+      _link(false, rightmost(), z);
+  } else if (j->left == 0)
+    _link(true, j, z);
+  else
+    _link(false, maximum(left(j)), z);
+}
+
+// 以有序的n个元素构建完全平衡的树，节点按中序依次配置
+// 除最底层外各层都是满的，最底层不满时将其染红，其余为黑，满足红黑性质
+template <class K,
+          class V,
+          class KeyOfValue,
+          class Compare,
+          class Alloc,
+          class Augment>
+template <class ForwardIter>
+void rb_tree<K, V, KeyOfValue, Compare, Alloc, Augment>::_assign_sorted(
+    ForwardIter first,
+    size_type n) {
+  clear();
+  if (n == 0)
+    return;
+  size_type full = 0;  // 满层的层数 floor(log2(n + 1))
+  for (size_type m = n + 1; m > 1; m >>= 1)
+    ++full;
+  // 深度为full的节点即最底层不满的那一层；n + 1为2的幂时不存在
+  root() = _build(first, n, 0, full, header);
+  leftmost() = minimum(root());
+  rightmost() = maximum(root());
+  node_count = n;
+}
+// 中序消费first，返回以n个元素建成的子树
+template <class K,
+          class V,
+          class KeyOfValue,
+          class Compare,
+          class Alloc,
+          class Augment>
+template <class Iter>
+typename rb_tree<K, V, KeyOfValue, Compare, Alloc, Augment>::link_type
+rb_tree<K, V, KeyOfValue, Compare, Alloc, Augment>::_build(Iter& first,
+                                                  size_type n,
+                                                  size_type depth,
+                                                  size_type red_depth,
+                                                  link_type p) {
+  if (n == 0)
+    return 0;
+  size_type left_n = n / 2;
+  link_type l = _build(first, left_n, depth + 1, red_depth, 0);
+  link_type x;
+  try {
+    x = create_node(*first);
+  } catch (...) {
+    if (l)
+      _clear(l);
+    throw;
+  }
+  ++first;
+  x->set_color(depth == red_depth ? _rb_tree_red : _rb_tree_black);
+  x->parent = p;
+  x->left = l;
+  if (l)
+    l->parent = x;
+  try {
+    x->right = _build(first, n - left_n - 1, depth + 1, red_depth, x);
+  } catch (...) {
+    x->right = 0;
+    _clear(x);
+    throw;
+  }
+  Augment::update(x);
+  return x;
+}
+
+// 全局函数，用于树平衡
+// 平衡算法只经由Links操作节点，与链接的表示无关：rb_tree以指针链接，
+// index_rb_tree以32位下标链接，两者共用同一份算法
+// Links::link为节点的句柄，0表示空；Links须提供：
+//   root/set_root、left/right（返回可赋值的引用）、parent/set_parent、
+//   is_red（空节点为黑）/set_red/set_black/swap_color/copy_color、
+//   minimum/maximum，以及Augment的钩子update/erasing/erased
+// 根的父节点即header的句柄，header不经由Links改变颜色
+
+// 以指针链接的rb_tree所用的Links
+template <class Augment>
+struct _rb_tree_ptr_links {
+  typedef _rb_tree_node_base* link;
+  link& root_;
+
+  explicit _rb_tree_ptr_links(link& root) : root_(root) {}
+  link root() const { return root_; }
+  void set_root(link x) const { root_ = x; }
+  static link& left(link x) { return x->left; }
+  static link& right(link x) { return x->right; }
+  static link parent(link x) { return x->parent; }
+  static void set_parent(link x, link p) { x->parent = p; }
+  static bool is_red(link x) { return x != 0 && x->color() == _rb_tree_red; }
+  static void set_red(link x) { x->set_color(_rb_tree_red); }
+  static void set_black(link x) { x->set_color(_rb_tree_black); }
+  static void swap_color(link x, link y) {
+    _rb_tree_color_type c = x->color();
+    x->set_color(y->color());
+    y->set_color(c);
+  }
+  static void copy_color(link x, link y) { x->set_color(y->color()); }
+  static link minimum(link x) { return _rb_tree_node_base::minimum(x); }
+  static link maximum(link x) { return _rb_tree_node_base::maximum(x); }
+  static void update(link x) { Augment::update(x); }
+  void erasing(link y) const { Augment::erasing(y, root_); }
+  void erased(link x_parent) const { Augment::erased(x_parent, root_); }
+};
+
+template <class Links>
+inline void _rb_tree_generic_rotate_left(const Links& t,
+                                         typename Links::link x) {
+  typename Links::link y = t.right(x);  // y为旋转点的右节点
+  t.right(x) = t.left(y);
+  if (t.left(y) != 0)
+    t.set_parent(t.left(y), x);
+  t.set_parent(y, t.parent(x));
+
+  // 令y完全替代x的位置
+  if (x == t.root())  // x为根节点
+    t.set_root(y);
+  else if (x == t.left(t.parent(x)))  // x为其父节点的左子节点
+    t.left(t.parent(x)) = y;
+  else  // x为其父节点的右子节点
+    t.right(t.parent(x)) = y;
+  t.left(y) = x;
+  t.set_parent(x, y);
+  t.update(x);  // x成为y的子节点，先x后y
+  t.update(y);
+}
+
+template <class Links>
+inline void _rb_tree_generic_rotate_right(const Links& t,
+                                          typename Links::link x) {
+  typename Links::link y = t.left(x);  // y为旋转点的左子节点
+  t.left(x) = t.right(y);
+  if (t.right(y) != 0)
+    t.set_parent(t.right(y), x);
+  t.set_parent(y, t.parent(x));
+
+  if (x == t.root())
+    t.set_root(y);
+  else if (x == t.right(t.parent(x)))
+    t.right(t.parent(x)) = y;
+  else
+    t.left(t.parent(x)) = y;
+  t.right(y) = x;
+  t.set_parent(x, y);
+  t.update(x);
+  t.update(y);
+}
+
+// 新插入的红节点x可能与父节点同为红，自下而上调整
+template <class Links>
+inline void _rb_tree_generic_rebalance(const Links& t, typename Links::link x) {
+  typedef typename Links::link link;
+  while (x != t.root() && t.is_red(t.parent(x))) {  // 父节点为红
+    link xp = t.parent(x);
+    link xpp = t.parent(xp);
+    if (xp == t.left(xpp)) {  // 父节点为祖父节点左子节点
+      link y = t.right(xpp);  // 令y为伯父节点
+      if (t.is_red(y)) {      // 伯父节点存在，且为红
+        t.set_black(xp);      // 更改父节点为黑
+        t.set_black(y);       // 更改伯父节点为黑
+        t.set_red(xpp);       // 祖父节点为红
+        x = xpp;              // 准备继续往上检查
+      } else {                // 伯父节点不存在，或为黑
+        if (x == t.right(xp)) {  // 如果新节点为父节点的右节点
+          x = xp;
+          _rb_tree_generic_rotate_left(t, x);  // 第一参数为左旋点
         }
-        x->parent->color = _rb_tree_black;
-        x->parent->parent->color = _rb_tree_red;
-        _rb_tree_rotate_right(x->parent->parent, root);  // 第一参数为右旋点
+        t.set_black(t.parent(x));
+        t.set_red(t.parent(t.parent(x)));
+        _rb_tree_generic_rotate_right(t, t.parent(t.parent(x)));  // 右旋点
       }
-    } else {  // 父节点为祖父节点右节点
-      _rb_tree_node_base* y = x->parent->parent->left;  // 令y为伯父节点
-      if (y && y->color == _rb_tree_red) {  // 伯父节点存在，且为红
-        x->parent->color = _rb_tree_red;    // 更改父节点为黑
-        y->color = _rb_tree_red;            // 更改伯父节点为黑
-        x->parent->parent->color = _rb_tree_red;  // 祖父节点为红
-        x = x->parent->parent;                    // 准备继续往上检查
-      } else {                       // 伯父节点不存在，或为黑
-        if (x == x->parent->left) {  // 如果新节点为父节点的左节点
-          x = x->parent;
-          _rb_tree_rotate_right(x, root);  // 第一参数为右旋点
+    } else {  // 父节点为祖父节点右节点，与上面左右对称
+      link y = t.left(xpp);
+      if (t.is_red(y)) {
+        t.set_black(xp);
+        t.set_black(y);
+        t.set_red(xpp);
+        x = xpp;
+      } else {
+        if (x == t.left(xp)) {
+          x = xp;
+          _rb_tree_generic_rotate_right(t, x);
         }
-        x->parent->color = _rb_tree_black;
-        x->parent->parent->color = _rb_tree_red;
-        _rb_tree_rotate_left(x->parent->parent, root);  // 第一参数为左旋点
+        t.set_black(t.parent(x));
+        t.set_red(t.parent(t.parent(x)));
+        _rb_tree_generic_rotate_left(t, t.parent(t.parent(x)));
       }
     }
-  }                              // while end
-  root->color = _rb_tree_black;  // 根节点永远为黑
+  }
+  t.set_black(t.root());  // 根节点永远为黑
 }
 
-inline void _rb_tree_rotate_left(_rb_tree_node_base* x,
-                                 _rb_tree_node_base*& root) {
-  _rb_tree_node_base* y = x->right;  // y为旋转点的右节点
-  x->right = y->left;
-  if (y->left != 0)
-    y->left->parent = x;
-  y->parent = x->parent;
+// 将z从树中摘下并重新平衡，返回摘下的节点
+template <class Links>
+inline typename Links::link _rb_tree_generic_rebalance_for_erase(
+    const Links& t,
+    typename Links::link z,
+    typename Links::link& leftmost,
+    typename Links::link& rightmost) {
+  typedef typename Links::link link;
+  link y = z;  // y为实际从树中移走的位置
+  link x = 0;  // x为顶替y的节点，可能为空
+  link x_parent = 0;
+  if (t.left(y) == 0)  // z至多一个子节点
+    x = t.right(y);
+  else if (t.right(y) == 0)
+    x = t.left(y);
+  else {  // z有两个子节点，y取z的后继
+    y = t.minimum(t.right(y));
+    x = t.right(y);
+  }
+  t.erasing(y);  // y的祖先都少了一个节点
+  if (y != z) {  // 以节点y顶替z的位置，而不是复制y的值，z以外的节点都不受影响
+    t.set_parent(t.left(z), y);
+    t.left(y) = t.left(z);
+    if (y != t.right(z)) {
+      x_parent = t.parent(y);
+      if (x != 0)
+        t.set_parent(x, t.parent(y));
+      t.left(t.parent(y)) = x;  // y一定是左子节点
+      t.right(y) = t.right(z);
+      t.set_parent(t.right(z), y);
+    } else
+      x_parent = y;
+    if (t.root() == z)
+      t.set_root(y);
+    else if (t.left(t.parent(z)) == z)
+      t.left(t.parent(z)) = y;
+    else
+      t.right(t.parent(z)) = y;
+    t.set_parent(y, t.parent(z));
+    t.update(y);
+    t.swap_color(y, z);  // y接手z的颜色，z带走y原来的颜色
+    y = z;               // 此后y指向被摘下的节点
+  } else {               // y == z
+    x_parent = t.parent(y);
+    if (x != 0)
+      t.set_parent(x, t.parent(y));
+    if (t.root() == z)
+      t.set_root(x);
+    else if (t.left(t.parent(z)) == z)
+      t.left(t.parent(z)) = x;
+    else
+      t.right(t.parent(z)) = x;
+    if (leftmost == z) {
+      if (t.right(z) == 0)  // 此时z的左子也为空，z为根时leftmost成为header
+        leftmost = t.parent(z);
+      else
+        leftmost = t.minimum(x);
+    }
+    if (rightmost == z) {
+      if (t.left(z) == 0)
+        rightmost = t.parent(z);
+      else
+        rightmost = t.maximum(x);
+    }
+  }
+  t.erased(x_parent);
+  if (!t.is_red(y)) {  // 移走黑节点，x所在路径少了一个黑节点
+    while (x != t.root() && !t.is_red(x))
+      if (x == t.left(x_parent)) {
+        link w = t.right(x_parent);  // 兄弟节点
+        if (t.is_red(w)) {           // 兄弟为红，转为兄弟为黑
+          t.set_black(w);
+          t.set_red(x_parent);
+          _rb_tree_generic_rotate_left(t, x_parent);
+          w = t.right(x_parent);
+        }
+        if (!t.is_red(t.left(w)) && !t.is_red(t.right(w))) {
+          t.set_red(w);  // 兄弟的子节点都为黑，问题上移
+          x = x_parent;
+          x_parent = t.parent(x_parent);
+        } else {
+          if (!t.is_red(t.right(w))) {  // 此时左子必为红
+            t.set_black(t.left(w));
+            t.set_red(w);
+            _rb_tree_generic_rotate_right(t, w);
+            w = t.right(x_parent);
+          }
+          t.copy_color(w, x_parent);
+          t.set_black(x_parent);
+          if (t.right(w) != 0)
+            t.set_black(t.right(w));
+          _rb_tree_generic_rotate_left(t, x_parent);
+          break;
+        }
+      } else {  // 与上面左右对称
+        link w = t.left(x_parent);
+        if (t.is_red(w)) {
+          t.set_black(w);
+          t.set_red(x_parent);
+          _rb_tree_generic_rotate_right(t, x_parent);
+          w = t.left(x_parent);
+        }
+        if (!t.is_red(t.right(w)) && !t.is_red(t.left(w))) {
+          t.set_red(w);
+          x = x_parent;
+          x_parent = t.parent(x_parent);
+        } else {
+          if (!t.is_red(t.left(w))) {
+            t.set_black(t.right(w));
+            t.set_red(w);
+            _rb_tree_generic_rotate_left(t, w);
+            w = t.left(x_parent);
+          }
+          t.copy_color(w, x_parent);
+          t.set_black(x_parent);
+          if (t.left(w) != 0)
+            t.set_black(t.left(w));
+          _rb_tree_generic_rotate_right(t, x_parent);
+          break;
+        }
+      }
+    if (x != 0)
+      t.set_black(x);
+  }
+  return y;
+}
 
-  // 令y完全替代x的位置
-  if (x == root)  // x为根节点
-    root = y;
-  else if (x == x->parent->left)  // x为其父节点的左子节点
-    x->parent->left = y;
-  else  // x为其父节点的右子节点
-    x->parent->right = y;
-  y->left = x;
-  x->parent = y;
-}
-
-inline void _rb_tree_rotate_right(_rb_tree_node_base* x,
-                                  _rb_tree_node_base*& root) {
-  _rb_tree_node_base* y = x->left;  // y为旋转点的左子节点
-  x->left = y->right;
-  if (y->right != 0)
-    y->right->parent = x;
-  y->parent = x->parent;
-
-  if (x == root)
-    root = y;
-  else if (x == x->parent->right)
-    x->parent->right = y;
-  else
-    x->parent->left = y;
-  y->right = x;
-  x->parent = y;
+template <class Augment>
+inline _rb_tree_node_base* _rb_tree_rebalance_for_erase(
+    _rb_tree_node_base* z,
+    _rb_tree_node_base*& root,
+    _rb_tree_node_base*& leftmost,
+    _rb_tree_node_base*& rightmost) {
+  return _rb_tree_generic_rebalance_for_erase(
+      _rb_tree_ptr_links<Augment>(root), z, leftmost, rightmost);
+}
+
+template <class Augment>
+inline void _rb_tree_rebalance(_rb_tree_node_base* x,
+                               _rb_tree_node_base*& root) {
+  x->set_color(_rb_tree_red);  // 新节点必为红
+  _rb_tree_generic_rebalance(_rb_tree_ptr_links<Augment>(root), x);
 }
 
 _MINISTL_END
@@ -0,0 +1,278 @@
+#ifndef MINISTL_STATIC_MAP_H
+#define MINISTL_STATIC_MAP_H
+
+#include "../configurator/allocator.hpp"
+#include "../functor/functor.hpp"
+#include "../iterator/iterator.hpp"
+#include "../utils/exceptdef.hpp"
+#include "../utils/util.hpp"
+#include "static_tree.hpp"
+#include "stl_map.hpp"
+#include "stl_vector.hpp"
+
+_MINISTL_BEGIN
+
+// static_map 迭代器，同时指向键数组和值数组中的同一位置
+// V 为 T 或 const T
+template <class Key, class V>
+struct _static_map_iterator {
+  typedef _static_map_iterator<Key, typename std::remove_const<V>::type>
+      iterator;
+  typedef _static_map_iterator<Key, const V> const_iterator;
+  typedef _static_map_iterator<Key, V> self;
+
+  typedef bidirectional_iterator_tag iterator_category;
+  typedef pair<Key, typename std::remove_const<V>::type> value_type;
+  typedef pair<const Key&, V&> reference;
+  typedef _flat_map_arrow<reference> pointer;
+  typedef ptrdiff_t difference_type;
+
+  const Key* kb;  // kb[k]为位置k的键
+  V* vb;          // vb[k-1]为位置k的值
+  size_t k;  // 位置，从1起，0为end()
+  size_t n;
+
+  _static_map_iterator() : kb(0), vb(0), k(0), n(0) {}
+  _static_map_iterator(const Key* kp, V* vp, size_t i, size_t np)
+      : kb(kp), vb(vp), k(i), n(np) {}
+  _static_map_iterator(const iterator& x)
+      : kb(x.kb), vb(x.vb), k(x.k), n(x.n) {}
+
+  reference operator*() const { return reference(kb[k], vb[k - 1]); }
+  pointer operator->() const { return pointer(operator*()); }
+
+  self& operator++() {
+    k = _eytzinger_next(k, n);
+    return *this;
+  }
+  self operator++(int) {
+    self tmp = *this;
+    ++*this;
+    return tmp;
+  }
+  self& operator--() {
+    k = _eytzinger_prev(k, n);
+    return *this;
+  }
+  self operator--(int) {
+    self tmp = *this;
+    --*this;
+    return tmp;
+  }
+
+  bool operator==(const self& x) const { return k == x.k; }
+  bool operator!=(const self& x) const { return k != x.k; }
+};
+
+// static_map：键集合建好后不再变化的有序map
+// 键与值分别按Eytzinger顺序存于两段连续内存，查找只读键数组，
+// 不追指针、不含分支，并预取下几层；实值仍可经迭代器或at()修改
+// 不支持插入删除；可由任意区间构造，或以freeze()从map得到
+template <class Key,
+          class T,
+          class Compare = std::less<Key>,
+          class Alloc = alloc>
+class static_map {
+ public:
+  typedef Key key_type;
+  typedef T data_type;
+  typedef T mapped_type;
+  typedef pair<Key, T> value_type;
+  typedef Compare key_compare;
+
+  class value_compare : public binary_function<value_type, value_type, bool> {
+    friend class static_map<Key, T, Compare, Alloc>;
+
+   protected:
+    Compare comp;
+    value_compare(Compare c) : comp(c) {}
+
+   public:
+    bool operator()(const value_type& x, const value_type& y) const {
+      return comp(x.first, y.first);
+    }
+  };
+
+  typedef _static_map_iterator<Key, T> iterator;
+  typedef _static_map_iterator<Key, const T> const_iterator;
+  typedef ministl::reverse_iterator<iterator> reverse_iterator;
+  typedef ministl::reverse_iterator<const_iterator> const_reverse_iterator;
+  typedef typename iterator::reference reference;
+  typedef typename const_iterator::reference const_reference;
+  typedef typename iterator::pointer pointer;
+  typedef typename const_iterator::pointer const_pointer;
+  typedef size_t size_type;
+  typedef ptrdiff_t difference_type;
+
+ private:
+  _eytzinger_array<Key, Alloc> keys;  // Eytzinger顺序，不重复
+  vector<T, Alloc> vals;  // vals[k-1]为位置k的值
+  Compare comp;
+
+  iterator make_iter(size_type k) {
+    return iterator(keys.data(), vals.begin(), k, size());
+  }
+  const_iterator make_iter(size_type k) const {
+    return const_iterator(keys.data(), vals.begin(), k, size());
+  }
+  size_type lower_pos(const key_type& x) const {
+    return _eytzinger_lower_bound(keys.data(), size(), x, comp);
+  }
+  size_type upper_pos(const key_type& x) const {
+    return _eytzinger_upper_bound(keys.data(), size(), x, comp);
+  }
+  // x所在的位置，没有时为0
+  size_type find_pos(const key_type& x) const {
+    size_type k = lower_pos(x);
+    return (k == 0 || comp(x, keys[k])) ? 0 : k;
+  }
+  template <class InputIter>
+  void build(InputIter first, InputIter last, bool sorted);
+
+ public:
+  static_map() : comp(Compare()) {}
+  explicit static_map(const Compare& c) : comp(c) {}
+
+  // 重复的键只保留先出现的一个
+  template <class InputIter>
+  static_map(InputIter first, InputIter last) : comp(Compare()) {
+    build(first, last, false);
+  }
+  template <class InputIter>
+  static_map(InputIter first, InputIter last, const Compare& c) : comp(c) {
+    build(first, last, false);
+  }
+  // 输入已严格递增时不再排序，O(n)
+  template <class InputIter>
+  static_map(sorted_unique_t, InputIter first, InputIter last)
+      : comp(Compare()) {
+    build(first, last, true);
+  }
+  template <class InputIter>
+  static_map(sorted_unique_t,
+             InputIter first,
+             InputIter last,
+             const Compare& c)
+      : comp(c) {
+    build(first, last, true);
+  }
+
+  static_map(const static_map& x)
+      : keys(x.keys), vals(x.vals), comp(x.comp) {}
+  static_map& operator=(const static_map& x) {
+    keys = x.keys;
+    vals = x.vals;
+    comp = x.comp;
+    return *this;
+  }
+
+  key_compare key_comp() const { return comp; }
+  value_compare value_comp() const { return value_compare(comp); }
+  // 迭代器
+  iterator begin() { return make_iter(_eytzinger_first(size())); }
+  const_iterator begin() const { return make_iter(_eytzinger_first(size())); }
+  iterator end() { return make_iter(0); }
+  const_iterator end() const { return make_iter(0); }
+  reverse_iterator rbegin() { return reverse_iterator(end()); }
+  reverse_iterator rend() { return reverse_iterator(begin()); }
+  const_reverse_iterator rbegin() const {
+    return const_reverse_iterator(end());
+  }
+  const_reverse_iterator rend() const {
+    return const_reverse_iterator(begin());
+  }
+  const_iterator cbegin() const { return begin(); }
+  const_iterator cend() const { return end(); }
+
+  bool empty() const { return keys.empty(); }
+  size_type size() const { return keys.size(); }
+  size_type max_size() const { return keys.max_size(); }
+  void swap(static_map& x) {
+    keys.swap(x.keys);
+    vals.swap(x.vals);
+    Compare tmp = comp;
+    comp = x.comp;
+    x.comp = tmp;
+  }
+  void clear() {
+    keys.clear();
+    vals.clear();
+  }
+
+  // 键不存在时抛出out_of_range
+  T& at(const key_type& x) {
+    size_type k = find_pos(x);
+    THROW_OUT_OF_RANGE_IF(k == 0, "no such element");
+    return vals[k - 1];
+  }
+  const T& at(const key_type& x) const {
+    size_type k = find_pos(x);
+    THROW_OUT_OF_RANGE_IF(k == 0, "no such element");
+    return vals[k - 1];
+  }
+  // 操作
+  iterator find(const key_type& x) { return make_iter(find_pos(x)); }
+  const_iterator find(const key_type& x) const {
+    return make_iter(find_pos(x));
+  }
+  size_type count(const key_type& x) const { return find_pos(x) ? 1 : 0; }
+  bool contains(const key_type& x) const { return find_pos(x) != 0; }
+  iterator lower_bound(const key_type& x) { return make_iter(lower_pos(x)); }
+  const_iterator lower_bound(const key_type& x) const {
+    return make_iter(lower_pos(x));
+  }
+  iterator upper_bound(const key_type& x) { return make_iter(upper_pos(x)); }
+  const_iterator upper_bound(const key_type& x) const {
+    return make_iter(upper_pos(x));
+  }
+  pair<iterator, iterator> equal_range(const key_type& x) {
+    return pair<iterator, iterator>(lower_bound(x), upper_bound(x));
+  }
+  pair<const_iterator, const_iterator> equal_range(const key_type& x) const {
+    return pair<const_iterator, const_iterator>(lower_bound(x),
+                                                upper_bound(x));
+  }
+
+  friend bool operator==(const static_map& x, const static_map& y) {
+    return x.keys == y.keys && x.vals == y.vals;
+  }
+  friend bool operator!=(const static_map& x, const static_map& y) {
+    return !(x == y);
+  }
+};
+
+template <class Key, class T, class Compare, class Alloc>
+template <class InputIter>
+void static_map<Key, T, Compare, Alloc>::build(InputIter first,
+                                               InputIter last,
+                                               bool sorted) {
+  vector<Key, Alloc> bk;
+  vector<T, Alloc> bv;
+  for (; first != last; ++first) {
+    bk.push_back((*first).first);
+    bv.push_back((*first).second);
+  }
+  vector<size_t, Alloc> idx;
+  idx.reserve(bk.size());
+  for (size_t i = 0; i < bk.size(); ++i)
+    idx.push_back(i);
+  _eytzinger_arrange(idx, bk.begin(), comp, sorted);
+  vector<T, Alloc> nv;
+  nv.reserve(idx.size());
+  for (size_t i = 0; i < idx.size(); ++i)
+    nv.push_back(bv[idx[i]]);
+  keys.assign(bk.begin(), idx.begin(), idx.size());
+  vals.swap(nv);
+}
+
+// 以m的当前内容建立static_map，O(n)
+template <class Key, class T, class Compare, class Alloc, class Augment>
+inline static_map<Key, T, Compare, Alloc> freeze(
+    const map<Key, T, Compare, Alloc, Augment>& m) {
+  return static_map<Key, T, Compare, Alloc>(sorted_unique, m.begin(),
+                                            m.end(), m.key_comp());
+}
+
+_MINISTL_END
+
+#endif
\ No newline at end of file
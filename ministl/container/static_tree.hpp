@@ -0,0 +1,216 @@
+#ifndef MINISTL_STATIC_TREE_H
+#define MINISTL_STATIC_TREE_H
+
+#include "../configurator/allocator.hpp"
+#include "../configurator/construct.hpp"
+#include "../utils/util.hpp"
+#include "flat_tree.hpp"
+#include "stl_vector.hpp"
+
+_MINISTL_BEGIN
+
+// static_set / static_map 的公共部分：Eytzinger布局
+// 把n个有序元素看作一棵完全二叉搜索树，按层序存入连续数组，
+// 位置k（从1起）的左右子节点为2k与2k+1
+// 查找自根向下，每层一次比较直接算出下一个位置，不含难以预测的分支；
+// 位置k往下第d层的子孙在数组中连续，提前预取几层以掩盖访存延迟
+
+// 一条缓存行能放下的元素个数，取不超过16的2的幂
+// 位置k往下log2(value)层的子孙为b[value*k, value*k+value)，
+// 数组按缓存行对齐且元素从b[1]起存放，sizeof(Key)为2的幂时这一段
+// 正好落在一条缓存行内（one_line），否则可能跨两条
+template <class Key>
+struct _eytzinger_stride {
+  static const size_t per_line = sizeof(Key) < 64 ? 64 / sizeof(Key) : 1;
+  static const size_t value = per_line >= 16  ? 16
+                              : per_line >= 8 ? 8
+                              : per_line >= 4 ? 4
+                              : per_line >= 2 ? 2
+                                              : 1;
+  static const bool one_line = 64 % (sizeof(Key) * value) == 0;
+};
+
+// 预取位置k往下log2(stride)层的子孙，跨两条缓存行时两条都取
+template <class Key>
+inline void _eytzinger_prefetch(const Key* b, size_t k) {
+  const Key* p = b + _eytzinger_stride<Key>::value * k;
+  MINISTL_PREFETCH(p);
+  if (!_eytzinger_stride<Key>::one_line)
+    MINISTL_PREFETCH((const char*)(p + _eytzinger_stride<Key>::value) - 1);
+}
+
+// Eytzinger数组的存储：位置k的元素存于b[k]，b[0]不用，
+// b按缓存行对齐，使预取的子孙段从一条缓存行的开头起
+template <class Key, class Alloc>
+class _eytzinger_array {
+  typedef allocator<char, Alloc> data_allocator;
+
+  char* raw;  // 配置所得的内存，多配一条缓存行用于对齐
+  Key* b;
+  size_t n;
+
+  static size_t bytes(size_t m) { return (m + 1) * sizeof(Key) + 64; }
+
+ public:
+  _eytzinger_array() : raw(0), b(0), n(0) {}
+  _eytzinger_array(const _eytzinger_array& x) : raw(0), b(0), n(0) {
+    assign(x.b, 0, x.n);
+  }
+  _eytzinger_array& operator=(const _eytzinger_array& x) {
+    if (this != &x)
+      assign(x.b, 0, x.n);
+    return *this;
+  }
+  ~_eytzinger_array() { clear(); }
+
+  // 依次以src[idx[i]]（idx为空时为src[i+1]）构造位置1..m的元素
+  // 构造途中抛出异常时原有内容不变
+  void assign(const Key* src, const size_t* idx, size_t m) {
+    char* r = m == 0 ? 0 : data_allocator::allocate(bytes(m));
+    Key* p = r == 0 ? 0 : (Key*)(((size_t)r + 63) & ~(size_t)63);
+    size_t i = 0;
+    try {
+      for (; i < m; ++i)
+        construct(p + i + 1, idx ? src[idx[i]] : src[i + 1]);
+    } catch (...) {
+      destroy(p + 1, p + i + 1);
+      data_allocator::deallocate(r, bytes(m));
+      throw;
+    }
+    clear();
+    raw = r;
+    b = p;
+    n = m;
+  }
+  void clear() {
+    if (raw) {
+      destroy(b + 1, b + n + 1);
+      data_allocator::deallocate(raw, bytes(n));
+    }
+    raw = 0;
+    b = 0;
+    n = 0;
+  }
+  void swap(_eytzinger_array& x) {
+    std::swap(raw, x.raw);
+    std::swap(b, x.b);
+    std::swap(n, x.n);
+  }
+
+  const Key* data() const { return b; }
+  const Key& operator[](size_t k) const { return b[k]; }
+  bool empty() const { return n == 0; }
+  size_t size() const { return n; }
+  size_t max_size() const { return size_t(-1) / sizeof(Key) - 1; }
+
+  friend bool operator==(const _eytzinger_array& x,
+                         const _eytzinger_array& y) {
+    if (x.n != y.n)
+      return false;
+    for (size_t k = 1; k <= x.n; ++k)
+      if (!(x.b[k] == y.b[k]))
+        return false;
+    return true;
+  }
+};
+
+// 自根走到叶子之外后，末尾的1是进入右子树后的路径，
+// 去掉它们以及其上的一个0即回到最后一次向左走的节点；0表示没有
+inline size_t _eytzinger_resolve(size_t k) {
+#if defined(__GNUC__) || defined(__clang__)
+  return k >> __builtin_ffsll(~(unsigned long long)k);
+#else
+  while (k & 1)
+    k >>= 1;
+  return k >> 1;
+#endif
+}
+
+// 第一个不小于x的位置，b为_eytzinger_array::data()
+template <class Key, class K, class Compare>
+inline size_t _eytzinger_lower_bound(const Key* b,
+                                     size_t n,
+                                     const K& x,
+                                     Compare comp) {
+  size_t k = 1;
+  while (k <= n) {
+    _eytzinger_prefetch(b, k);
+    k = 2 * k + (size_t)comp(b[k], x);
+  }
+  return _eytzinger_resolve(k);
+}
+// 第一个大于x的位置
+template <class Key, class K, class Compare>
+inline size_t _eytzinger_upper_bound(const Key* b,
+                                     size_t n,
+                                     const K& x,
+                                     Compare comp) {
+  size_t k = 1;
+  while (k <= n) {
+    _eytzinger_prefetch(b, k);
+    k = 2 * k + (size_t)!comp(x, b[k]);
+  }
+  return _eytzinger_resolve(k);
+}
+
+// 中序遍历，0表示end()
+inline size_t _eytzinger_first(size_t n) {
+  if (n == 0)
+    return 0;
+  size_t k = 1;
+  while (2 * k <= n)
+    k *= 2;
+  return k;
+}
+inline size_t _eytzinger_next(size_t k, size_t n) {
+  if (2 * k + 1 <= n) {
+    k = 2 * k + 1;
+    while (2 * k <= n)
+      k *= 2;
+    return k;
+  }
+  while (k & 1)  // 从右子树回溯
+    k >>= 1;
+  return k >> 1;
+}
+inline size_t _eytzinger_prev(size_t k, size_t n) {
+  if (k == 0) {  // end()的前一个为最右节点
+    k = n == 0 ? 0 : 1;
+    while (k != 0 && 2 * k + 1 <= n)
+      k = 2 * k + 1;
+    return k;
+  }
+  if (2 * k <= n) {
+    k = 2 * k;
+    while (2 * k + 1 <= n)
+      k = 2 * k + 1;
+    return k;
+  }
+  while (k != 0 && !(k & 1))  // 从左子树回溯
+    k >>= 1;
+  return k >> 1;
+}
+
+// idx为bk的下标，按键值排序（sorted时跳过）并去掉重复的键，
+// 重复时保留先出现的一个；再重排为Eytzinger顺序
+template <class Key, class Compare, class Alloc>
+void _eytzinger_arrange(vector<size_t, Alloc>& idx,
+                        const Key* bk,
+                        Compare comp,
+                        bool sorted) {
+  if (!sorted)
+    _flat_sort_index(idx, bk, comp);
+  size_t n = 0;
+  for (size_t i = 0; i < idx.size(); ++i)
+    if (n == 0 || comp(bk[idx[n - 1]], bk[idx[i]]))
+      idx[n++] = idx[i];
+  vector<size_t, Alloc> order(n, 0);
+  size_t k = _eytzinger_first(n);
+  for (size_t i = 0; i < n; ++i, k = _eytzinger_next(k, n))
+    order[k - 1] = idx[i];
+  idx.swap(order);
+}
+
+_MINISTL_END
+
+#endif
\ No newline at end of file
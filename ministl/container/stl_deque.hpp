@@ -110,7 +110,7 @@ struct _deque_iterator {  // 未继承iterator
   bool operator==(const self& x) const { return cur == x.cur; }
   bool operator!=(const self& x) const { return cur != x.cur; }
   bool operator<(const self& x) const {
-    return (node = x.node) ? (cur < x.cur) : (node < x.node);
+    return node == x.node ? (cur < x.cur) : (node < x.node);
   }
 };
 // const 迭代器
@@ -214,7 +214,7 @@ struct _deque_const_iterator {  // 未继承iterator
   bool operator==(const self& x) const { return cur == x.cur; }
   bool operator!=(const self& x) const { return cur != x.cur; }
   bool operator<(const self& x) const {
-    return (node = x.node) ? (cur < x.cur) : (node < x.node);
+    return node == x.node ? (cur < x.cur) : (node < x.node);
   }
 };
 
@@ -301,6 +301,12 @@ class deque {
   void fill_initialize(size_type n, const value_type& value);
   // 负责安排deque的结构
   void create_map_and_nodes(size_type num_elements);
+  // 释放所有缓冲区与map，元素须已析构
+  void destroy_map_and_nodes() {
+    for (map_pointer cur = start.node; cur <= finish.node; ++cur)
+      data_allocator::deallocate(*cur, iterator::buffer_size());
+    map_allocator::deallocate(map, map_size);
+  }
   // 只有当最后缓冲区已无（或还有一个）元素备用空间时才会调用
   void push_back_aux(const value_type& t);
   // 只有当第一缓冲区已无元素备用空间时才会调用
@@ -319,11 +325,47 @@ class deque {
 
  public:
   // 构造器
-  deque() : deque(0, 0) {}
+  deque() : deque(0, value_type()) {}
   deque(int n, const value_type& value)
       : start(), finish(), map(0), map_size(0) {
     fill_initialize(n, value);
   }
+  deque(const deque& x) : start(), finish(), map(0), map_size(0) {
+    create_map_and_nodes(x.size());
+    try {
+      uninitialized_copy(x.start, x.finish, start);
+    } catch (...) {
+      destroy_map_and_nodes();
+      throw;
+    }
+  }
+  // 直接取走x的map与缓冲区，x换上一个只有一个缓冲区的空map，O(1)
+  deque(deque&& x) : start(), finish(), map(0), map_size(0) {
+    create_map_and_nodes(0);
+    swap(x);
+  }
+  deque& operator=(const deque& x) {
+    if (this != &x) {
+      deque tmp(x);
+      swap(tmp);
+    }
+    return *this;
+  }
+  deque& operator=(deque&& x) {
+    swap(x);
+    return *this;
+  }
+  ~deque() {
+    clear();
+    destroy_map_and_nodes();
+  }
+  // 只交换迭代器与map，O(1)
+  void swap(deque& x) {
+    std::swap(start, x.start);
+    std::swap(finish, x.finish);
+    std::swap(map, x.map);
+    std::swap(map_size, x.map_size);
+  }
   // push_back
   void push_back(const value_type& t) {
     // 最后缓冲区有1个以上的备用空间
@@ -623,6 +665,28 @@ deque<T, Alloc, BufSize>::insert_aux(iterator pos, const value_type& x) {
   return pos;
 }
 
+// 删除pred为真的所有元素：留下的元素一遍依次前移，最后一次截去尾端
+template <class T, class Alloc, size_t BufSize, class Predicate>
+typename deque<T, Alloc, BufSize>::size_type erase_if(
+    deque<T, Alloc, BufSize>& c,
+    Predicate pred) {
+  typename deque<T, Alloc, BufSize>::iterator first = c.begin();
+  typename deque<T, Alloc, BufSize>::iterator last = c.end();
+  while (first != last && !pred(*first))
+    ++first;
+  typename deque<T, Alloc, BufSize>::iterator result = first;
+  if (first != last) {
+    for (++first; first != last; ++first)
+      if (!pred(*first)) {
+        *result = std::move(*first);
+        ++result;
+      }
+  }
+  typename deque<T, Alloc, BufSize>::size_type n = last - result;
+  c.erase(result, last);
+  return n;
+}
+
 _MINISTL_END
 
 #endif
\ No newline at end of file
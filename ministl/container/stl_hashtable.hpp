@@ -3,7 +3,9 @@
 #include "../configurator/allocator.hpp"
 #include "../functor/hash_func.hpp"
 #include "../iterator/iterator.hpp"
+#include "../iterator/prefetch_iterator.hpp"
 #include "../utils/util.hpp"
+#include "node_handle.hpp"
 #include "stl_vector.hpp"
 
 _MINISTL_BEGIN
@@ -35,7 +37,8 @@ template <class Value,
           class EqualKey,
           class Alloc>
 struct _hashtable_const_iterator {
-  typedef hashtable<Value, Key, HashFcn, ExtractKey, EqualKey, Alloc> hashtable;
+  typedef hashtable<Value, Key, HashFcn, ExtractKey, EqualKey, Alloc>
+      hashtable_type;
   typedef _hashtable_const_iterator<Value,
                                     Key,
                                     HashFcn,
@@ -53,14 +56,18 @@ struct _hashtable_const_iterator {
   typedef const Value& reference;
   typedef const Value* pointer;
   typedef Key key_type;
-  node* cur;
-  hashtable* ht;
-  _hashtable_const_iterator(node* n, hashtable* tab) : cur(n), ht(tab) {}
+  const node* cur;
+  const hashtable_type* ht;
+  _hashtable_const_iterator(const node* n, const hashtable_type* tab)
+      : cur(n), ht(tab) {}
   _hashtable_const_iterator() {}
+  _hashtable_const_iterator(const iterator& it) : cur(it.cur), ht(it.ht) {}
   reference operator*() const { return cur->val; }
   pointer operator->() const { return &(operator*()); }
-  iterator& operator++();
-  iterator operator++(int);
+  const_iterator& operator++();
+  const_iterator operator++(int);
+  bool operator==(const const_iterator& it) const { return cur == it.cur; }
+  bool operator!=(const const_iterator& it) const { return cur != it.cur; }
 };
 
 template <class Value,
@@ -74,7 +81,7 @@ typename _hashtable_const_iterator<Value,
                                    HashFcn,
                                    ExtractKey,
                                    EqualKey,
-                                   Alloc>::iterator&
+                                   Alloc>::const_iterator&
 _hashtable_const_iterator<Value, Key, HashFcn, ExtractKey, EqualKey, Alloc>::
 operator++() {
   const node* old = cur;
@@ -98,10 +105,10 @@ typename _hashtable_const_iterator<Value,
                                    HashFcn,
                                    ExtractKey,
                                    EqualKey,
-                                   Alloc>::iterator
+                                   Alloc>::const_iterator
 _hashtable_const_iterator<Value, Key, HashFcn, ExtractKey, EqualKey, Alloc>::
 operator++(int) {
-  iterator tmp = *this;
+  const_iterator tmp = *this;
   ++*this;
   return tmp;
 }
@@ -114,7 +121,8 @@ template <class Value,
           class EqualKey,
           class Alloc>
 struct _hashtable_iterator {
-  typedef hashtable<Value, Key, HashFcn, ExtractKey, EqualKey, Alloc> hashtable;
+  typedef hashtable<Value, Key, HashFcn, ExtractKey, EqualKey, Alloc>
+      hashtable_type;
   typedef _hashtable_iterator<Value, Key, HashFcn, ExtractKey, EqualKey, Alloc>
       iterator;
   typedef _hashtable_const_iterator<Value,
@@ -134,8 +142,8 @@ struct _hashtable_iterator {
   typedef Key key_type;
 
   node* cur;
-  hashtable* ht;
-  _hashtable_iterator(node* n, hashtable* tab) : cur(n), ht(tab) {}
+  hashtable_type* ht;
+  _hashtable_iterator(node* n, hashtable_type* tab) : cur(n), ht(tab) {}
   _hashtable_iterator() {}
   reference operator*() const { return cur->val; }
   pointer operator->() const { return &(operator*()); }
@@ -212,6 +220,19 @@ class hashtable {
   typedef typename iterator::key_type key_type;
 
  private:
+  friend struct _hashtable_iterator<Value,
+                                    Key,
+                                    HashFcn,
+                                    ExtractKey,
+                                    EqualKey,
+                                    Alloc>;
+  friend struct _hashtable_const_iterator<Value,
+                                          Key,
+                                          HashFcn,
+                                          ExtractKey,
+                                          EqualKey,
+                                          Alloc>;
+
   /// 以下三者都是function object
   hasher hash;
   key_equal equals;
@@ -224,46 +245,118 @@ class hashtable {
   size_type num_elements;
 
  public:
+  // 节点句柄
+  typedef _node_handle<node, value_type, Alloc, &node::val> node_type;
+
   size_type bucket_count() const { return buckets.size(); }
   // 构造函数
   hashtable(size_type n, const HashFcn& hf, const EqualKey& eql)
       : hash(hf), equals(eql), get_key(ExtractKey()), num_elements(0) {
     initialize_buckets(n);
   }
+  hashtable(const hashtable& ht)
+      : hash(ht.hash), equals(ht.equals), get_key(ht.get_key), num_elements(0) {
+    copy_from(ht);
+  }
+  // 直接取走ht的bucket数组，ht换上一个最小的空表，O(1)
+  hashtable(hashtable&& ht)
+      : hash(ht.hash), equals(ht.equals), get_key(ht.get_key), num_elements(0) {
+    initialize_buckets(0);
+    swap(ht);
+  }
+  // 重用已有节点，只提供基本保证：复制中途抛出异常时本表被清空，异常照常抛出
+  hashtable& operator=(const hashtable& ht) {
+    if (this != &ht) {
+      hash = ht.hash;
+      equals = ht.equals;
+      get_key = ht.get_key;
+      copy_from(ht);
+    }
+    return *this;
+  }
+  hashtable& operator=(hashtable&& ht) {
+    swap(ht);
+    return *this;
+  }
   // 析构函数
   ~hashtable() { clear(); }
   size_type max_bucket_count() const {
     return _ministl_prime_list[_ministl_num_primes - 1];
   }
+  size_type size() const { return num_elements; }
+  size_type max_size() const { return size_type(-1); }
+  bool empty() const { return num_elements == 0; }
+  // 第一个非空bucket的首节点
+  iterator begin() {
+    for (size_type n = 0; n < buckets.size(); ++n)
+      if (buckets[n])
+        return iterator(buckets[n], this);
+    return end();
+  }
+  const_iterator begin() const {
+    for (size_type n = 0; n < buckets.size(); ++n)
+      if (buckets[n])
+        return const_iterator(buckets[n], this);
+    return end();
+  }
+  iterator end() { return iterator(0, this); }
+  const_iterator end() const { return const_iterator(0, this); }
   // 插入元素，不重复
   pair<iterator, bool> insert_unique(const value_type& obj) {
     resize(num_elements + 1);
     return insert_unique_noresize(obj);
   }
+  // 挂入句柄持有的节点，键值已存在时节点仍留在nh中
+  pair<iterator, bool> insert_unique(node_type&& nh);
   // 以下函数判断是否需要重建表格
   void resize(size_type num_elements_hint);
   // 删除
+  void erase(const_iterator it) { delete_node(_unlink(it.cur)); }
+  size_type erase(const key_type& key);
+  // 删除pred(元素)为真的所有元素，逐个bucket走一遍，返回删除的个数
+  template <class Predicate>
+  size_type erase_if(Predicate pred);
   void clear();
-  // copy
+  // 摘下节点交给句柄，不释放节点
+  node_type extract(const_iterator it) { return node_type(_unlink(it.cur)); }
+  node_type extract(const key_type& key) {
+    node* p = _find(key);
+    return p ? node_type(_unlink(p)) : node_type();
+  }
+  // 将ht中键值在本表中不存在的节点逐个转移过来，其余节点留在ht中
+  void merge_unique(hashtable& ht);
+  // copy，本表已有的节点被重用，只配置或释放两表节点数之差
   void copy_from(const hashtable& ht);
-  // find
-  iterator find(const key_type& key) {
-    size_type n = bkt_num_key(key);
-    node* first;
-    for (first = buckets[n]; first && !equals(get_key(first->val), key);
-         first = first->next) {
-    }
-    return iterator(first, this);
+  // 只交换bucket数组与函数对象，O(1)
+  // 迭代器记录了所属的表，交换后原有的迭代器失效
+  void swap(hashtable& ht) {
+    std::swap(hash, ht.hash);
+    std::swap(equals, ht.equals);
+    std::swap(get_key, ht.get_key);
+    buckets.swap(ht.buckets);
+    std::swap(num_elements, ht.num_elements);
   }
+  // find
+  iterator find(const key_type& key) { return iterator(_find(key), this); }
   // count
-  size_type count(const key_type& key) const {
-    const size_type n = bkt_num_key(key);
-    size_type result = 0;
-    for (const node* cur = buckets[n]; cur; cur = cur->next) {
-      if (equals(get_key(cur->val), key))
-        ++result;
-    }
-    return result;
+  size_type count(const key_type& key) const { return _count(key); }
+  // HashFcn与EqualKey都定义了is_transparent时，可直接以其他型别查找，
+  // 两者须对与键值相等的对象给出相同的结果
+  template <class K,
+            class H = HashFcn,
+            class E = EqualKey,
+            class = typename H::is_transparent,
+            class = typename E::is_transparent>
+  iterator find(const K& key) {
+    return iterator(_find(key), this);
+  }
+  template <class K,
+            class H = HashFcn,
+            class E = EqualKey,
+            class = typename H::is_transparent,
+            class = typename E::is_transparent>
+  size_type count(const K& key) const {
+    return _count(key);
   }
 
  private:
@@ -275,6 +368,7 @@ class hashtable {
       return n;
     } catch (...) {
       node_allocator::deallocate(n);
+      throw;
     }
   }
 
@@ -282,6 +376,36 @@ class hashtable {
     destroy(&n->val);
     node_allocator::deallocate(n);
   }
+  // 从pool链上取一个旧节点存放obj，pool为空时才配置新节点
+  node* reuse_node(node*& pool, const value_type& obj) {
+    if (pool == 0)
+      return new_node(obj);
+    node* n = pool;
+    pool = n->next;
+    n->next = 0;
+    try {
+      assign_val(n, obj, _is_assignable_value<value_type>());
+    } catch (...) {
+      node_allocator::deallocate(n);
+      throw;
+    }
+    return n;
+  }
+  // 释放pool链上剩下的节点
+  void free_pool(node* pool);
+  // 可赋值的元素直接覆盖，否则（键值为const）析构后重新构造
+  static void assign_val(node* n, const value_type& obj, std::true_type) {
+    try {
+      n->val = obj;
+    } catch (...) {
+      destroy(&n->val);
+      throw;
+    }
+  }
+  static void assign_val(node* n, const value_type& obj, std::false_type) {
+    destroy(&n->val);
+    construct(&n->val, obj);
+  }
 
   void initialize_buckets(size_type n) {
     const size_type n_bucktes = next_size(n);
@@ -293,6 +417,10 @@ class hashtable {
   size_type next_size(size_type n) const { return _ministl_next_prime(n); }
 
   pair<iterator, bool> insert_unique_noresize(const value_type& obj);
+  // 在p所在的bucket中找到p并将其摘下
+  node* _unlink(const node* p);
+  // 键值不存在时将p挂到所属bucket的头部
+  bool _link_unique(node* p);
 
   size_type bkt_num(const value_type& obj, size_t n) const {
     return bkt_num_key(get_key(obj), n);
@@ -300,12 +428,30 @@ class hashtable {
   size_type bkt_num(const value_type& obj) const {
     return bkt_num_key(get_key(obj));
   }
-  size_type bkt_num_key(const key_type& key) const {
+  template <class K>
+  size_type bkt_num_key(const K& key) const {
     return bkt_num_key(key, buckets.size());
   }
-  size_type bkt_num_key(const key_type& key, size_t n) const {
+  template <class K>
+  size_type bkt_num_key(const K& key, size_t n) const {
     return hash(key) % n;
   }
+  template <class K>
+  node* _find(const K& key) const {
+    node* first = buckets[bkt_num_key(key)];
+    while (first && !equals(get_key(first->val), key))
+      first = first->next;
+    return first;
+  }
+  template <class K>
+  size_type _count(const K& key) const {
+    size_type result = 0;
+    for (const node* cur = buckets[bkt_num_key(key)]; cur; cur = cur->next) {
+      if (equals(get_key(cur->val), key))
+        ++result;
+    }
+    return result;
+  }
 };
 
 template <class V, class K, class HF, class Ex, class Eq, class A>
@@ -324,6 +470,7 @@ void hashtable<V, K, HF, Ex, Eq, A>::resize(size_type num_elements_hint) {
             buckets[bucket] = first->next;
             // 2.3.将当前节点插入到新bucket内，成为其对应串行的第一个节点
             first->next = tmp[new_bucket];
+            tmp[new_bucket] = first;
             // 4. 回到旧bucket所指的待处理串行
             first = buckets[bucket];
           }
@@ -342,28 +489,120 @@ hashtable<V, K, HF, Ex, Eq, A>::insert_unique_noresize(const value_type& obj) {
   node* first = buckets[n];  // 令 first指向 bucket对应之链表头部
   // 如果buckets[n] 被占用，此时first不为0， 于是进入循环
   for (node* cur = first; cur; cur = cur->next) {
-    if (equals(get_key(cur->val), get_key(obj))) {
-      // 如果发现链表中的某键相同，马上插入
-      node* tmp = new_node(obj);
-      tmp->next = cur->next;
-      cur->next = tmp;
-      ++num_elements;
-      return iterator(tmp, this);  // 返回一个迭代器指向新增节点
+    if (equals(get_key(cur->val), get_key(obj)))
+      // 如果发现链表中的某键相同，不插入
+      return pair<iterator, bool>(iterator(cur, this), false);
+  }
+  // 如果没有重复，插入到链表头部
+  node* tmp = new_node(obj);
+  tmp->next = first;
+  buckets[n] = tmp;
+  ++num_elements;
+  return pair<iterator, bool>(iterator(tmp, this), true);
+}
+template <class V, class K, class HF, class Ex, class Eq, class A>
+typename hashtable<V, K, HF, Ex, Eq, A>::node*
+hashtable<V, K, HF, Ex, Eq, A>::_unlink(const node* p) {
+  node** link = &buckets[bkt_num(p->val)];
+  while (*link != p)
+    link = &(*link)->next;
+  node* n = *link;
+  *link = n->next;
+  n->next = 0;
+  --num_elements;
+  return n;
+}
+template <class V, class K, class HF, class Ex, class Eq, class A>
+bool hashtable<V, K, HF, Ex, Eq, A>::_link_unique(node* p) {
+  const size_type n = bkt_num(p->val);
+  for (node* cur = buckets[n]; cur; cur = cur->next)
+    if (equals(get_key(cur->val), get_key(p->val)))
+      return false;
+  p->next = buckets[n];
+  buckets[n] = p;
+  ++num_elements;
+  return true;
+}
+template <class V, class K, class HF, class Ex, class Eq, class A>
+pair<typename hashtable<V, K, HF, Ex, Eq, A>::iterator, bool>
+hashtable<V, K, HF, Ex, Eq, A>::insert_unique(node_type&& nh) {
+  if (nh.empty())
+    return pair<iterator, bool>(end(), false);
+  resize(num_elements + 1);
+  if (!_link_unique(nh._node()))
+    return pair<iterator, bool>(find(get_key(nh.value())), false);
+  return pair<iterator, bool>(iterator(nh._release(), this), true);
+}
+template <class V, class K, class HF, class Ex, class Eq, class A>
+typename hashtable<V, K, HF, Ex, Eq, A>::size_type
+hashtable<V, K, HF, Ex, Eq, A>::erase(const key_type& key) {
+  size_type erased = 0;
+  node** link = &buckets[bkt_num_key(key)];
+  while (*link) {
+    node* cur = *link;
+    if (equals(get_key(cur->val), key)) {
+      *link = cur->next;
+      delete_node(cur);
+      --num_elements;
+      ++erased;
+    } else
+      link = &cur->next;
+  }
+  return erased;
+}
+template <class V, class K, class HF, class Ex, class Eq, class A>
+template <class Predicate>
+typename hashtable<V, K, HF, Ex, Eq, A>::size_type
+hashtable<V, K, HF, Ex, Eq, A>::erase_if(Predicate pred) {
+  const size_type before = num_elements;
+  const size_type n = buckets.size();
+  for (size_type i = 0; i < n; ++i) {
+    if (i + _ministl_prefetch_distance < n)
+      MINISTL_PREFETCH(buckets[i + _ministl_prefetch_distance]);
+    node** link = &buckets[i];
+    while (*link) {
+      node* cur = *link;
+      MINISTL_PREFETCH(cur->next);
+      if (pred(cur->val)) {
+        *link = cur->next;
+        delete_node(cur);
+        --num_elements;
+      } else
+        link = &cur->next;
+    }
+  }
+  return before - num_elements;
+}
+template <class V, class K, class HF, class Ex, class Eq, class A>
+void hashtable<V, K, HF, Ex, Eq, A>::merge_unique(hashtable& ht) {
+  if (&ht == this)
+    return;
+  resize(num_elements + ht.num_elements);  // 先按最多转移全部节点扩表
+  const size_type n = ht.buckets.size();
+  for (size_type i = 0; i < n; ++i) {
+    node** link = &ht.buckets[i];
+    while (*link) {
+      node* cur = *link;
+      node* next = cur->next;
+      if (_link_unique(cur)) {  // cur已挂入本表，从ht的链表中去掉
+        *link = next;
+        --ht.num_elements;
+      } else
+        link = &cur->next;  // 键值重复，留在ht中
     }
-    // 如果没有重复
-    node* tmp = new_node(obj);
-    tmp->next = first;
-    buckets[n] = tmp;
-    ++num_elements;
-    return iterator(tmp, this);
   }
 }
 template <class V, class K, class HF, class Ex, class Eq, class A>
 void hashtable<V, K, HF, Ex, Eq, A>::clear() {
-  for (size_type i = 0; i < buckets.size(); ++i) {
+  const size_type n = buckets.size();
+  for (size_type i = 0; i < n; ++i) {
+    // bucket数组是连续的，可以提前取后面几个bucket的首节点
+    if (i + _ministl_prefetch_distance < n)
+      MINISTL_PREFETCH(buckets[i + _ministl_prefetch_distance]);
     node* cur = buckets[i];
     while (cur != 0) {
       node* next = cur->next;
+      MINISTL_PREFETCH(next);
       delete_node(cur);
       cur = next;
     }
@@ -373,25 +612,62 @@ void hashtable<V, K, HF, Ex, Eq, A>::clear() {
 }
 template <class V, class K, class HF, class Ex, class Eq, class A>
 void hashtable<V, K, HF, Ex, Eq, A>::copy_from(const hashtable& ht) {
+  // 先把原有节点全部摘下，串成一条单链备用
+  node* pool = 0;
+  for (size_type i = 0; i < buckets.size(); ++i) {
+    node* cur = buckets[i];
+    while (cur) {
+      node* next = cur->next;
+      cur->next = pool;
+      pool = cur;
+      cur = next;
+    }
+  }
+  num_elements = 0;
   buckets.clear();
   buckets.reserve(ht.buckets.size());
   buckets.insert(buckets.end(), ht.buckets.size(), (node*)0);
   try {
-    for (size_type i = 0; i < ht.buckets.size(); ++i) {
+    const size_type n = ht.buckets.size();
+    for (size_type i = 0; i < n; ++i) {
+      if (i + _ministl_prefetch_distance < n)
+        MINISTL_PREFETCH(ht.buckets[i + _ministl_prefetch_distance]);
       if (const node* cur = ht.buckets[i]) {
-        node* copy = new_node(cur->val);
+        node* copy = reuse_node(pool, cur->val);
         buckets[i] = copy;
 
         for (node* next = cur->next; next; cur = next, next = cur->next) {
-          copy->next = new_node(next->val);
+          MINISTL_PREFETCH(next->next);
+          copy->next = reuse_node(pool, next->val);
           copy = copy->next;
         }
       }
     }
     num_elements = ht.num_elements;
   } catch (...) {
+    // 已复制的部分与剩下的旧节点都不要了，异常照常抛出
     clear();
+    free_pool(pool);
+    throw;
   }
+  // 释放没有用到的旧节点
+  free_pool(pool);
+}
+
+template <class V, class K, class HF, class Ex, class Eq, class A>
+void hashtable<V, K, HF, Ex, Eq, A>::free_pool(node* pool) {
+  while (pool) {
+    node* next = pool->next;
+    delete_node(pool);
+    pool = next;
+  }
+}
+
+template <class V, class K, class HF, class Ex, class Eq, class A, class Pred>
+typename hashtable<V, K, HF, Ex, Eq, A>::size_type erase_if(
+    hashtable<V, K, HF, Ex, Eq, A>& ht,
+    Pred pred) {
+  return ht.erase_if(pred);
 }
 
 _MINISTL_END
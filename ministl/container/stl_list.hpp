@@ -2,10 +2,39 @@
 #define MINISTL_LIST_H
 
 #include "../configurator/allocator.hpp"
+#include "../functor/functor.hpp"
 #include "../iterator/iterator.hpp"
 
 _MINISTL_BEGIN
 
+// list::sort 使用的节点指针缓冲区
+// 每个线程一份，只增不减，预热之后排序不再配置内存
+struct _list_sort_buffer {
+  void** data;
+  size_t cap;
+  bool busy;  // 比较函数内又对list排序时，改用临时缓冲区
+
+  _list_sort_buffer() : data(0), cap(0), busy(false) {}
+  ~_list_sort_buffer() {
+    if (data)
+      malloc_alloc::deallocate(data, cap * sizeof(void*));
+  }
+  void** reserve(size_t n) {
+    if (n > cap) {
+      if (data)
+        malloc_alloc::deallocate(data, cap * sizeof(void*));
+      size_t len = cap * 2 > n ? cap * 2 : n;
+      data = (void**)malloc_alloc::allocate(len * sizeof(void*));
+      cap = len;
+    }
+    return data;
+  }
+  static _list_sort_buffer& local() {
+    static thread_local _list_sort_buffer buf;
+    return buf;
+  }
+};
+
 template <class T>
 struct _list_node {
   typedef _list_node<T>* void_pointer;
@@ -142,6 +171,7 @@ class list {
 
  protected:
   link_type node;
+  size_type node_count;  // 节点个数，使size()为O(1)
   // 配置一个节点并传回
   link_type get_node() { return list_node_allocator::allocate(); }
   // 释放一个节点
@@ -162,6 +192,7 @@ class list {
     node = get_node();  // 配置一个节点，令node指向它
     node->next = node;  // 令node头尾都指向自己
     node->prev = node;
+    node_count = 0;
   }
   // 将[first, last)内的所有元素移动到position之前
   void transfer(iterator position, iterator first, iterator last);
@@ -169,9 +200,25 @@ class list {
  public:
   // 构造函数
   list() { empty_initialize(); }
+  list(const list& x) {
+    empty_initialize();
+    for (const_iterator it = x.begin(); it != x.end(); ++it)
+      push_back(*it);
+  }
+  // 直接取走x的全部节点，x换上一个新的空头节点，O(1)
+  list(list&& x) : node(x.node), node_count(x.node_count) {
+    x.empty_initialize();
+  }
+  // 逐个覆盖已有节点的元素，只配置或释放两者长度之差的节点
+  list& operator=(const list& x);
+  list& operator=(list&& x) {
+    swap(x);
+    return *this;
+  }
   ~list() {
     if (node) {
       clear();
+      put_node(node);
     }
   }
   // 操作
@@ -195,11 +242,7 @@ class list {
   const_reverse_iterator crend() const { return rend(); }
 
   bool empty() const { return node->next == node; }
-  size_type size() const {
-    size_type result = 0;
-    result = distance(begin(), end());
-    return result;
-  }
+  size_type size() const { return node_count; }
   size_type max_size() const { return size_type(-1); }
 
   reference front() { return *begin(); }
@@ -226,39 +269,95 @@ class list {
   void clear();
   // 将数值为value 的所有元素删除
   void remove(const T& value);
+  // 将pred(元素)为真的所有元素删除
+  template <class Predicate>
+  void remove_if(Predicate pred);
   // 移除数值相同的连续元素，只有连续且相同的元素会被删为一个
   void unique();
   // 将x接合于position所指位置之前，x必须不同与*this
   void splice(iterator postiton, list& x) {
-    if (!x.empty())
+    if (!x.empty()) {
       transfer(postiton, x.begin(), x.end());
+      node_count += x.node_count;
+      x.node_count = 0;
+    }
   }
   // 将i接合于position所指位置之前，position和i可指向同一个list
-  void splice(iterator postiton, list&, iterator i) {
+  void splice(iterator postiton, list& x, iterator i) {
     iterator j = i;
     ++j;
     if (postiton == i || postiton == j)
       return;
     transfer(postiton, i, j);
+    ++node_count;
+    --x.node_count;
   }
   // 将[first,last)内的所有元素接合与position之前
   // position和[first,last)可指向同一个list；
   // 但position不能位于[first,last)之内
-  void splice(iterator postiton, list&, iterator first, iterator last) {
-    if (first != last)
+  // 来自另一个list时需要计算区间长度，为O(n)
+  void splice(iterator postiton, list& x, iterator first, iterator last) {
+    if (first != last) {
+      size_type n = this == &x ? 0 : size_type(distance(first, last));
+      splice(postiton, x, first, last, n);
+    }
+  }
+  // 同上，但由调用者给出区间长度n，为O(1)
+  void splice(iterator postiton,
+              list& x,
+              iterator first,
+              iterator last,
+              size_type n) {
+    if (first != last) {
       transfer(postiton, first, last);
+      if (this != &x) {
+        node_count += n;
+        x.node_count -= n;
+      }
+    }
   }
   // merge()将x合并到*this身上，两个list的内容必须经过sort递增排序
   void merge(list& x);
   // reverse()将*this的内容逆向重置
   void reverse();
-  // sort() 排序
+  // sort() 稳定排序，将节点指针收集到数组中排序后一次性重新链接
+  // 整数元素使用基数排序，其余使用归并排序
   void sort();
+  template <class Compare>
+  void sort(Compare comp);
   // 交换两个list
   void swap(list& x) {
     link_type tmp = x.node;
     x.node = (this->node);
     (this->node) = tmp;
+    size_type n = x.node_count;
+    x.node_count = node_count;
+    node_count = n;
+  }
+
+ protected:
+  // sort() 的辅助函数
+  void _sort(std::true_type);
+  void _sort(std::false_type) { sort(less<T>()); }
+  template <class Compare>
+  void _sort_nodes(void** a, void** tmp, Compare comp);
+  void _radix_sort_nodes(void** a, void** tmp);
+  void _gather(void** a) {
+    size_type i = 0;
+    for (link_type cur = node->next; cur != node; cur = cur->next)
+      a[i++] = cur;
+  }
+  // 按数组顺序重新链接所有节点
+  void _relink(void** a) {
+    link_type prev = node;
+    for (size_type i = 0; i < node_count; ++i) {
+      link_type cur = (link_type)a[i];
+      prev->next = cur;
+      cur->prev = prev;
+      prev = cur;
+    }
+    prev->next = node;
+    node->prev = prev;
   }
 };
 // 在迭代器position处插入一个节点内容为x
@@ -271,6 +370,7 @@ typename list<T, Alloc>::iterator list<T, Alloc>::insert(iterator position,
   tmp->prev = position.node->prev;
   (link_type(position.node->prev))->next = tmp;
   position.node->prev = tmp;
+  ++node_count;
   return tmp;
 }
 // 移除迭代器 position所指节点
@@ -281,8 +381,26 @@ typename list<T, Alloc>::iterator list<T, Alloc>::erase(iterator position) {
   prev_node->next = next_node;
   next_node->prev = prev_node;
   destroy_node(position.node);
+  --node_count;
   return iterator(next_node);
 }
+template <class T, class Alloc>
+list<T, Alloc>& list<T, Alloc>::operator=(const list& x) {
+  if (this != &x) {
+    iterator first1 = begin();
+    const_iterator first2 = x.begin();
+    for (; first1 != end() && first2 != x.end(); ++first1, ++first2)
+      *first1 = *first2;
+    if (first2 == x.end()) {  // x较短，释放多出的节点
+      while (first1 != end())
+        first1 = erase(first1);
+    } else {  // x较长，只为剩下的元素配置节点
+      for (; first2 != x.end(); ++first2)
+        push_back(*first2);
+    }
+  }
+  return *this;
+}
 // 清除所有节点
 template <class T, class Alloc>
 void list<T, Alloc>::clear() {
@@ -290,11 +408,13 @@ void list<T, Alloc>::clear() {
   while (cur != node) {  // 遍历每一个节点
     link_type tmp = cur;
     cur = (link_type)cur->next;
-    destroy_node(tmp);  // 销毁
+    MINISTL_PREFETCH(cur);  // 销毁tmp的同时取下一个节点
+    destroy_node(tmp);      // 销毁
   }
   // 恢复原始
   node->next = node;
   node->prev = node;
+  node_count = 0;
 }
 // 将数值为value 的所有元素删除
 template <class T, class Alloc>
@@ -309,6 +429,19 @@ void list<T, Alloc>::remove(const T& value) {
     first = next;
   }
 }
+template <class T, class Alloc>
+template <class Predicate>
+void list<T, Alloc>::remove_if(Predicate pred) {
+  iterator first = begin();
+  iterator last = end();
+  while (first != last) {
+    iterator next = first;
+    ++next;
+    if (pred(*first))
+      erase(first);
+    first = next;
+  }
+}
 // 移除数值相同的连续元素，只有连续且相同的元素会被删为一个
 template <class T, class Alloc>
 void list<T, Alloc>::unique() {
@@ -357,6 +490,8 @@ void list<T, Alloc>::merge(list<T, Alloc>& x) {
   }
   if (first2 != last2)
     transfer(last1, first2, last2);
+  node_count += x.node_count;
+  x.node_count = 0;
 }
 // reverse()将*this的内容逆向重置
 template <class T, class Alloc>
@@ -375,27 +510,123 @@ void list<T, Alloc>::reverse() {
 // sort() 排序
 template <class T, class Alloc>
 void list<T, Alloc>::sort() {
+  // bool没有对应的无符号类型，走归并排序
+  _sort(std::integral_constant<bool, std::is_integral<T>::value &&
+                                         !std::is_same<T, bool>::value>());
+}
+// 以comp为准的稳定排序
+template <class T, class Alloc>
+template <class Compare>
+void list<T, Alloc>::sort(Compare comp) {
   // 如果链表为空，或只有一个元素，不进行
-  if (node->next == node || link_type(node->next)->next == node)
+  if (node_count < 2)
     return;
-  // 一些新的lists，作为中介数据
-  list<T, Alloc> carry;
-  list<T, Alloc> counter[64];
-  int fill = 0;
-  while (!empty()) {
-    carry.splice(carry.begin(), *this, begin());
-    int i = 0;
-    while (i < fill && !counter[i].empty()) {
-      counter[i].merge(carry);
-      carry.swap(counter[i++]);
+  _list_sort_buffer& shared = _list_sort_buffer::local();
+  _list_sort_buffer local;
+  _list_sort_buffer& buf = shared.busy ? local : shared;
+  buf.busy = true;
+  void** a = buf.reserve(2 * node_count);
+  _gather(a);
+  try {
+    _sort_nodes(a, a + node_count, comp);
+  } catch (...) {
+    // 链接在_relink之前未被改动，链表保持原状
+    buf.busy = false;
+    throw;
+  }
+  buf.busy = false;
+}
+// 整数元素的基数排序，每次按一个字节分配，稳定
+template <class T, class Alloc>
+void list<T, Alloc>::_sort(std::true_type) {
+  if (node_count < 2)
+    return;
+  _list_sort_buffer& shared = _list_sort_buffer::local();
+  _list_sort_buffer local;
+  _list_sort_buffer& buf = shared.busy ? local : shared;
+  buf.busy = true;
+  void** a = buf.reserve(2 * node_count);
+  _gather(a);
+  _radix_sort_nodes(a, a + node_count);
+  buf.busy = false;
+}
+// 先对长度为16的小段做插入排序，再自底向上两两归并
+// a 与 tmp 轮流作为输出，最后按结果重新链接
+template <class T, class Alloc>
+template <class Compare>
+void list<T, Alloc>::_sort_nodes(void** a, void** tmp, Compare comp) {
+  const size_type n = node_count;
+  const size_type run = 16;
+  for (size_type lo = 0; lo < n; lo += run) {
+    size_type hi = lo + run < n ? lo + run : n;
+    for (size_type i = lo + 1; i < hi; ++i) {
+      void* v = a[i];
+      size_type j = i;
+      for (; j > lo && comp(((link_type)v)->data, ((link_type)a[j - 1])->data);
+           --j)
+        a[j] = a[j - 1];
+      a[j] = v;
+    }
+  }
+  for (size_type width = run; width < n; width *= 2) {
+    for (size_type lo = 0; lo < n; lo += 2 * width) {
+      size_type mid = lo + width < n ? lo + width : n;
+      size_type hi = lo + 2 * width < n ? lo + 2 * width : n;
+      size_type i = lo, j = mid, k = lo;
+      while (i < mid && j < hi) {
+        // 只有右侧严格小于左侧时才取右侧，保证稳定
+        if (comp(((link_type)a[j])->data, ((link_type)a[i])->data))
+          tmp[k++] = a[j++];
+        else
+          tmp[k++] = a[i++];
+      }
+      while (i < mid)
+        tmp[k++] = a[i++];
+      while (j < hi)
+        tmp[k++] = a[j++];
     }
-    carry.swap(counter[i]);
-    if (i == fill)
-      ++fill;
+    void** t = a;
+    a = tmp;
+    tmp = t;
   }
-  for (int i = 1; i < fill; ++i)
-    counter[i].merge(counter[i - 1]);
-  swap(counter[fill - 1]);
+  _relink(a);
+}
+// LSD基数排序，所有元素在某一字节相同时跳过该趟
+template <class T, class Alloc>
+void list<T, Alloc>::_radix_sort_nodes(void** a, void** tmp) {
+  typedef typename std::make_unsigned<T>::type U;
+  // 有符号数翻转符号位，使其按无符号顺序排列
+  const U flip = std::is_signed<T>::value ? U(U(1) << (sizeof(U) * 8 - 1))
+                                          : U(0);
+  const size_type n = node_count;
+  for (size_type shift = 0; shift < sizeof(U) * 8; shift += 8) {
+    size_type cnt[256] = {0};
+    for (size_type i = 0; i < n; ++i)
+      ++cnt[((U(((link_type)a[i])->data) ^ flip) >> shift) & 0xff];
+    if (cnt[((U(((link_type)a[0])->data) ^ flip) >> shift) & 0xff] == n)
+      continue;
+    size_type sum = 0;
+    for (size_type d = 0; d < 256; ++d) {
+      size_type c = cnt[d];
+      cnt[d] = sum;
+      sum += c;
+    }
+    for (size_type i = 0; i < n; ++i)
+      tmp[cnt[((U(((link_type)a[i])->data) ^ flip) >> shift) & 0xff]++] =
+          a[i];
+    void** t = a;
+    a = tmp;
+    tmp = t;
+  }
+  _relink(a);
+}
+
+template <class T, class Alloc, class Predicate>
+typename list<T, Alloc>::size_type erase_if(list<T, Alloc>& c,
+                                            Predicate pred) {
+  typename list<T, Alloc>::size_type n = c.size();
+  c.remove_if(pred);
+  return n - c.size();
 }
 
 _MINISTL_END
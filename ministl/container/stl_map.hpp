@@ -7,10 +7,12 @@
 
 _MINISTL_BEGIN
 
+// Augment为节点附加信息的维护策略，见rb_tree
 template <class Key,
           class T,
           class Compare = std::less<Key>,
-          class Alloc = alloc>
+          class Alloc = alloc,
+          class Augment = _rb_tree_no_augment>
 class map
 {
 public:
@@ -22,7 +24,7 @@ public:
   // 定义一个仿函数 //调用元素比较函数
   class value_compare : public binary_function<value_type, value_type, bool>
   {
-    friend class map<Key, T, Compare, Alloc>;
+    friend class map;
 
   protected:
     Compare comp;
@@ -40,9 +42,13 @@ private:
                   value_type,
                   select1st<value_type>,
                   key_compare,
-                  Alloc>
+                  Alloc,
+                  Augment>
       rep_type;
   rep_type t;
+  // 顺序统计须由节点记录子树大小
+  static const bool ranked =
+      std::is_same<Augment, _rb_tree_size_augment>::value;
 
 public:
   typedef typename rep_type::pointer pointer;
@@ -55,6 +61,8 @@ public:
   typedef typename rep_type::const_reverse_iterator const_reverse_iterator;
   typedef typename rep_type::size_type size_type;
   typedef typename rep_type::difference_type difference_type;
+  typedef typename rep_type::node_type node_type;
+  typedef _node_insert_return<iterator, node_type> insert_return_type;
 
   map() : t(Compare()) {}
   explicit map(const Compare &comp) : t(comp) {}
@@ -71,7 +79,23 @@ public:
     t.insert_unique(first, last);
   }
 
+  // 输入已严格递增时O(n)建树
+  template <class InputIter>
+  map(sorted_unique_t, InputIter first, InputIter last) : t(Compare())
+  {
+    t.insert_unique(sorted_unique, first, last);
+  }
+
+  template <class InputIter>
+  map(sorted_unique_t, InputIter first, InputIter last, const Compare &comp)
+      : t(comp)
+  {
+    t.insert_unique(sorted_unique, first, last);
+  }
+
   map(const map &x) : t(x.t) {}
+  // 移动与swap都只交换树的header，O(1)
+  map(map &&x) : t(std::move(x.t)) {}
 
   map &operator=(const map &x)
   {
@@ -79,6 +103,12 @@ public:
     return *this;
   }
 
+  map &operator=(map &&x)
+  {
+    t = std::move(x.t);
+    return *this;
+  }
+
   key_compare key_comp() const { return t.key_comp(); }
   value_compare value_comp() const { return value_compare(t.key_comp()); }
   // 迭代器r
@@ -101,9 +131,10 @@ public:
   size_type size() const { return t.size(); }
   size_type max_size() const { return t.max_size(); }
 
+  // 先查找，只在k不存在时才配置节点并原地构造元素
   T &operator[](const key_type &k)
   {
-    return (*(insert(value_type(k, T()))).first).second;
+    return (*t.try_emplace_unique(k, _emplace_second, k).first).second;
   }
   void swap(map &x) { t.swap(x.t); }
   // 插入
@@ -120,11 +151,77 @@ public:
   {
     t.insert_unique(first,last);
   }
+  template <class InputIter>
+  void insert(sorted_unique_t, InputIter first, InputIter last)
+  {
+    t.insert_unique(sorted_unique, first, last);
+  }
+  // 整批排序后按键值顺序并入，相邻两次插入只在附近查找，适合大树中插入一批随机键值
+  template <class InputIter>
+  void insert_batch(InputIter first, InputIter last)
+  {
+    t.insert_unique_batch(first, last);
+  }
+  // 以args原地构造元素后插入，键值已存在时构造出的元素被丢弃
+  template <class... Args>
+  pair<iterator, bool> emplace(Args &&...args)
+  {
+    return t.emplace_unique(std::forward<Args>(args)...);
+  }
+  template <class... Args>
+  iterator emplace_hint(iterator, Args &&...args)
+  {
+    return t.emplace_unique(std::forward<Args>(args)...).first;
+  }
+  // k不存在时以k与args原地构造元素，k已存在时什么也不做，args不会被移动
+  template <class... Args>
+  pair<iterator, bool> try_emplace(const key_type &k, Args &&...args)
+  {
+    return t.try_emplace_unique(k, _emplace_second, k,
+                                std::forward<Args>(args)...);
+  }
+  template <class... Args>
+  iterator try_emplace(iterator, const key_type &k, Args &&...args)
+  {
+    return try_emplace(k, std::forward<Args>(args)...).first;
+  }
+  // k不存在时插入(k, obj)，否则将obj赋值给已有元素
+  template <class M>
+  pair<iterator, bool> insert_or_assign(const key_type &k, M &&obj)
+  {
+    pair<iterator, bool> r =
+        t.try_emplace_unique(k, _emplace_second, k, std::forward<M>(obj));
+    if (!r.second)
+      (*r.first).second = std::forward<M>(obj);
+    return r;
+  }
+  template <class M>
+  iterator insert_or_assign(iterator, const key_type &k, M &&obj)
+  {
+    return insert_or_assign(k, std::forward<M>(obj)).first;
+  }
   // 删除
   void erase(iterator pos) { t.erase(pos); }
   size_type erase(const key_type &x) { return t.erase(x); }
   void erase(iterator first, iterator last) { t.erase(first, last); }
   void clear() { t.clear(); }
+  // 节点句柄：元素在同型别的map之间转移时不释放也不重新配置节点
+  node_type extract(const_iterator pos) { return t.extract(pos); }
+  node_type extract(const key_type &x) { return t.extract(x); }
+  // 键值已存在时节点随返回值的node交还调用者
+  insert_return_type insert(node_type &&nh)
+  {
+    pair<iterator, bool> p = t.insert_unique(std::move(nh));
+    return {p.first, p.second, std::move(nh)};
+  }
+  // 键值已存在时节点仍留在nh中
+  iterator insert(iterator, node_type &&nh)
+  {
+    return t.insert_unique(std::move(nh)).first;
+  }
+  // 转移src中键值不在本map中的元素，其余留在src中
+  void merge(map &src) { t.merge_unique(src.t); }
+  void merge(map &&src) { t.merge_unique(src.t); }
   // 操作
   iterator find(const key_type &x) { return t.find(x); }
   const_iterator find(const key_type &x) const { return t.find(x); }
@@ -147,10 +244,87 @@ public:
   {
     return t.equal_range(x);
   }
+  // 比较器定义了is_transparent时，可以不构造key_type直接查找
+  template <class K, class C = Compare, class = typename C::is_transparent>
+  iterator find(const K &x) { return t.find(x); }
+  template <class K, class C = Compare, class = typename C::is_transparent>
+  const_iterator find(const K &x) const { return t.find(x); }
+  template <class K, class C = Compare, class = typename C::is_transparent>
+  size_type count(const K &x) const { return t.count(x); }
+  template <class K, class C = Compare, class = typename C::is_transparent>
+  iterator lower_bound(const K &x) { return t.lower_bound(x); }
+  template <class K, class C = Compare, class = typename C::is_transparent>
+  const_iterator lower_bound(const K &x) const { return t.lower_bound(x); }
+  template <class K, class C = Compare, class = typename C::is_transparent>
+  iterator upper_bound(const K &x) { return t.upper_bound(x); }
+  template <class K, class C = Compare, class = typename C::is_transparent>
+  const_iterator upper_bound(const K &x) const { return t.upper_bound(x); }
+  template <class K, class C = Compare, class = typename C::is_transparent>
+  pair<iterator, iterator> equal_range(const K &x)
+  {
+    return t.equal_range(x);
+  }
+  template <class K, class C = Compare, class = typename C::is_transparent>
+  pair<const_iterator, const_iterator> equal_range(const K &x) const
+  {
+    return t.equal_range(x);
+  }
+  // 以键值做集合运算，结果留在本map中，键值相同时保留本map的元素，见rb_tree
+  // 以右值传入时直接取用x的节点，否则先复制x
+  void union_with(const map &x)
+  {
+    map tmp(x);
+    t.union_with(tmp.t);
+  }
+  void union_with(map &&x) { t.union_with(x.t); }
+  void intersect_with(const map &x) { t.intersect_with(x.t); }
+  void difference_with(const map &x) { t.difference_with(x.t); }
+  // 顺序统计，只对ranked_map可用，均为O(log n)
+  // 键值小于x的元素个数
+  size_type rank(const key_type &x) const
+  {
+    static_assert(ranked, "rank/select/index_of/distance require ranked_map");
+    return t.rank(x);
+  }
+  // 第n个元素（从0起），n >= size()时返回end()
+  iterator select(size_type n)
+  {
+    static_assert(ranked, "rank/select/index_of/distance require ranked_map");
+    return t.select(n);
+  }
+  const_iterator select(size_type n) const
+  {
+    static_assert(ranked, "rank/select/index_of/distance require ranked_map");
+    return t.select(n);
+  }
+  // pos之前的元素个数
+  size_type index_of(const_iterator pos) const
+  {
+    static_assert(ranked, "rank/select/index_of/distance require ranked_map");
+    return t.index_of(pos);
+  }
+  difference_type distance(const_iterator first, const_iterator last) const
+  {
+    static_assert(ranked, "rank/select/index_of/distance require ranked_map");
+    return t.distance(first, last);
+  }
   friend bool operator==(const map &x, const map &y) { return x.t == y.t; }
   friend bool operator<(const map &x, const map &y) { return x.t < y.t; }
+  // 删除pred为真的所有元素，中序走一遍，O(n)
+  template <class Predicate>
+  friend size_type erase_if(map &c, Predicate pred)
+  {
+    return c.t.erase_if(pred);
+  }
 };
 
+// 维护子树大小的map，支持rank/select
+template <class Key,
+          class T,
+          class Compare = std::less<Key>,
+          class Alloc = alloc>
+using ranked_map = map<Key, T, Compare, Alloc, _rb_tree_size_augment>;
+
 _MINISTL_END
 
 #endif
\ No newline at end of file
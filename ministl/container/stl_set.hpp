@@ -9,7 +9,11 @@
 
 _MINISTL_BEGIN
 
-template <class Key, class Compare = std::less<Key>, class Alloc = alloc>
+// Augment为节点附加信息的维护策略，见rb_tree
+template <class Key,
+          class Compare = std::less<Key>,
+          class Alloc = alloc,
+          class Augment = _rb_tree_no_augment>
 class set {
  public:
   typedef Key key_type;
@@ -22,9 +26,13 @@ class set {
                   value_type,
                   identity<value_type>,
                   key_compare,
-                  Alloc>
+                  Alloc,
+                  Augment>
       rep_type;
   rep_type t;
+  // 顺序统计须由节点记录子树大小
+  static const bool ranked =
+      std::is_same<Augment, _rb_tree_size_augment>::value;
 
  public:
   typedef typename rep_type::const_pointer pointer;
@@ -37,6 +45,8 @@ class set {
   typedef typename rep_type::const_reverse_iterator reverse_iterator;
   typedef typename rep_type::size_type size_type;
   typedef typename rep_type::difference_type difference_type;
+  typedef typename rep_type::node_type node_type;
+  typedef _node_insert_return<iterator, node_type> insert_return_type;
 
   set() : t(Compare()) {}
   explicit set(const Compare& comp) : t(comp) {}
@@ -50,11 +60,28 @@ class set {
     t.insert_unique(first, last);
   }
 
-  set(const set<Key, Compare, Alloc>& x) : t(x.t) {}
-  set<Key, Compare, Alloc>& operator=(const set<Key, Compare, Alloc>& x) {
+  // 输入已严格递增时O(n)建树
+  template <class InputIter>
+  set(sorted_unique_t, InputIter first, InputIter last) : t(Compare()) {
+    t.insert_unique(sorted_unique, first, last);
+  }
+  template <class InputIter>
+  set(sorted_unique_t, InputIter first, InputIter last, const Compare& comp)
+      : t(comp) {
+    t.insert_unique(sorted_unique, first, last);
+  }
+
+  set(const set& x) : t(x.t) {}
+  // 移动与swap都只交换树的header，O(1)
+  set(set&& x) : t(std::move(x.t)) {}
+  set& operator=(const set& x) {
     t = x.t;
     return *this;
   }
+  set& operator=(set&& x) {
+    t = std::move(x.t);
+    return *this;
+  }
 
   // accessors
   key_compare key_comp() const { return t.key_comp(); }
@@ -70,10 +97,10 @@ class set {
   void swap(set& x) { t.swap(x.t); }
 
   //   insert/erase
-  typedef std::pair<iterator, bool> pair_iterator_bool;
-  std::pair<iterator, bool> insert(const value_type& x) {
-    std::pair<typename rep_type::iterator, bool> p = t.insert_unique(x);
-    return std::pair<iterator, bool>(p.first, p.second);
+  typedef pair<iterator, bool> pair_iterator_bool;
+  pair<iterator, bool> insert(const value_type& x) {
+    pair<typename rep_type::iterator, bool> p = t.insert_unique(x);
+    return pair<iterator, bool>(p.first, p.second);
   }
   iterator insert(iterator position, const value_type& x) {
     typedef typename rep_type::iterator rep_iterator;
@@ -83,6 +110,26 @@ class set {
   void insert(InputIter first, InputIter last) {
     t.insert_unique(first, last);
   }
+  template <class InputIter>
+  void insert(sorted_unique_t, InputIter first, InputIter last) {
+    t.insert_unique(sorted_unique, first, last);
+  }
+  // 整批排序后按键值顺序并入，相邻两次插入只在附近查找，适合大树中插入一批随机键值
+  template <class InputIter>
+  void insert_batch(InputIter first, InputIter last) {
+    t.insert_unique_batch(first, last);
+  }
+  // 以args原地构造元素后插入，元素已存在时构造出的元素被丢弃
+  template <class... Args>
+  pair<iterator, bool> emplace(Args&&... args) {
+    pair<typename rep_type::iterator, bool> p =
+        t.emplace_unique(std::forward<Args>(args)...);
+    return pair<iterator, bool>(p.first, p.second);
+  }
+  template <class... Args>
+  iterator emplace_hint(iterator, Args&&... args) {
+    return emplace(std::forward<Args>(args)...).first;
+  }
   void erase(iterator position) {
     typedef typename rep_type::iterator rep_iterator;
     t.erase((rep_iterator&)position);
@@ -93,20 +140,97 @@ class set {
     t.erase((rep_iterator&)first, (rep_iterator&)last);
   }
   void clear() { t.clear(); }
+  // 节点句柄：元素在同型别的set之间转移时不释放也不重新配置节点，
+  // 摘下后可经value()修改键值再插回
+  node_type extract(const_iterator position) { return t.extract(position); }
+  node_type extract(const key_type& x) { return t.extract(x); }
+  // 键值已存在时节点随返回值的node交还调用者
+  insert_return_type insert(node_type&& nh) {
+    pair<typename rep_type::iterator, bool> p = t.insert_unique(std::move(nh));
+    return {p.first, p.second, std::move(nh)};
+  }
+  // 键值已存在时节点仍留在nh中
+  iterator insert(iterator, node_type&& nh) {
+    return t.insert_unique(std::move(nh)).first;
+  }
+  // 转移src中键值不在本set中的元素，其余留在src中
+  void merge(set& src) { t.merge_unique(src.t); }
+  void merge(set&& src) { t.merge_unique(src.t); }
   // set operations:
   iterator find(const key_type& x) const { return t.find(x); }
   size_type count(const key_type& x) const { return t.count(x); }
-  iterator lower_bound(const key_type& x) const { t.lower_bound(x); }
-  iterator upper_bound(const key_type& x) const { t.upper_bound(x); }
+  iterator lower_bound(const key_type& x) const { return t.lower_bound(x); }
+  iterator upper_bound(const key_type& x) const { return t.upper_bound(x); }
 
-  std::pair<iterator, iterator> equal_range(const key_type& x) const {
+  pair<iterator, iterator> equal_range(const key_type& x) const {
     return t.equal_range(x);
   }
+  // 比较器定义了is_transparent时，可以不构造key_type直接查找
+  template <class K, class C = Compare, class = typename C::is_transparent>
+  iterator find(const K& x) const {
+    return t.find(x);
+  }
+  template <class K, class C = Compare, class = typename C::is_transparent>
+  size_type count(const K& x) const {
+    return t.count(x);
+  }
+  template <class K, class C = Compare, class = typename C::is_transparent>
+  iterator lower_bound(const K& x) const {
+    return t.lower_bound(x);
+  }
+  template <class K, class C = Compare, class = typename C::is_transparent>
+  iterator upper_bound(const K& x) const {
+    return t.upper_bound(x);
+  }
+  template <class K, class C = Compare, class = typename C::is_transparent>
+  pair<iterator, iterator> equal_range(const K& x) const {
+    return t.equal_range(x);
+  }
+
+  // 集合运算，结果留在本set中，键值相同时保留本set的元素，见rb_tree
+  // 以右值传入时直接取用x的节点，否则先复制x
+  void union_with(const set& x) {
+    set tmp(x);
+    t.union_with(tmp.t);
+  }
+  void union_with(set&& x) { t.union_with(x.t); }
+  void intersect_with(const set& x) { t.intersect_with(x.t); }
+  void difference_with(const set& x) { t.difference_with(x.t); }
+
+  // 顺序统计，只对ranked_set可用，均为O(log n)
+  // 小于x的元素个数
+  size_type rank(const key_type& x) const {
+    static_assert(ranked, "rank/select/index_of/distance require ranked_set");
+    return t.rank(x);
+  }
+  // 第n个元素（从0起），n >= size()时返回end()
+  iterator select(size_type n) const {
+    static_assert(ranked, "rank/select/index_of/distance require ranked_set");
+    return t.select(n);
+  }
+  // position之前的元素个数
+  size_type index_of(iterator position) const {
+    static_assert(ranked, "rank/select/index_of/distance require ranked_set");
+    return t.index_of(position);
+  }
+  difference_type distance(iterator first, iterator last) const {
+    static_assert(ranked, "rank/select/index_of/distance require ranked_set");
+    return t.distance(first, last);
+  }
 
   friend bool operator==(const set& x, const set& y) { return x.t == y.t; }
   friend bool operator<(const set& x, const set& y) { return x.t < y.t; }
+  // 删除pred为真的所有元素，中序走一遍，O(n)
+  template <class Predicate>
+  friend size_type erase_if(set& c, Predicate pred) {
+    return c.t.erase_if(pred);
+  }
 };
 
+// 维护子树大小的set，支持rank/select
+template <class Key, class Compare = std::less<Key>, class Alloc = alloc>
+using ranked_set = set<Key, Compare, Alloc, _rb_tree_size_augment>;
+
 _MINISTL_END
 
 #endif
\ No newline at end of file
@@ -59,19 +59,19 @@ class vector {
     v.end_of_storage = 0;
   }
   vector& operator=(const vector& v) {
-    if (this != v) {
+    if (this != &v) {
       const auto len = v.size();
       if (len > capacity()) {
-        vector tmp(v.begin(), v.end());
+        vector tmp(v);
         swap(tmp);
       } else if (size() >= len) {
-        auto i = std::copy(v.begin(), v.end());
-        data_allocator::destroy(i, finish);
+        auto i = std::copy(v.begin(), v.end(), start);
+        destroy(i, finish);
         finish = start + len;
       } else {
         std::copy(v.begin(), v.begin() + size(), start);
         uninitialized_copy(v.begin() + size(), v.end(), finish);
-        end_of_storage = finish = start + len;
+        finish = start + len;
       }
     }
     return *this;
@@ -162,6 +162,13 @@ class vector {
     destroy(finish);
     return position;
   }
+  // 清除[first,last)中的所有元素
+  iterator erase(iterator first, iterator last) {
+    iterator i = std::copy(last, finish, first);
+    destroy(i, finish);
+    finish = finish - (last - first);
+    return first;
+  }
   // 重置大小
   void resize(size_type new_size, const T& x) {
     if (new_size < size()) {
@@ -173,7 +180,9 @@ class vector {
   void resize(size_type new_size) { resize(new_size, T()); }
   void clear() { erase(begin(), end()); }
   void insert(iterator position, size_type n, const T& x);
-  void insert(iterator position, const T& x) { insert(position, 1, x); }
+  void insert(iterator position, const T& x) {
+    insert(position, size_type(1), x);  // 避免T为整数时匹配到区间版本
+  }
   void swap(vector& v) {
     if (this != &v) {
       std::swap(start, v.start);
@@ -398,6 +407,26 @@ bool operator>=(const vector<T>& lhs, const vector<T>& rhs) {
   return !(lhs < rhs);
 }
 
+// 删除pred为真的所有元素：留下的元素一遍依次前移，最后一次截去尾端
+template <class T, class Alloc, class Predicate>
+typename vector<T, Alloc>::size_type erase_if(vector<T, Alloc>& c,
+                                              Predicate pred) {
+  typename vector<T, Alloc>::iterator first = c.begin();
+  typename vector<T, Alloc>::iterator last = c.end();
+  while (first != last && !pred(*first))
+    ++first;
+  typename vector<T, Alloc>::iterator result = first;
+  if (first != last) {
+    for (++first; first != last; ++first)
+      if (!pred(*first)) {
+        *result = std::move(*first);
+        ++result;
+      }
+  }
+  c.erase(result, last);
+  return last - result;
+}
+
 _MINISTL_END
 
 #endif
\ No newline at end of file
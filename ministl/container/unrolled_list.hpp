@@ -0,0 +1,381 @@
+#ifndef MINISTL_UNROLLED_LIST_H
+#define MINISTL_UNROLLED_LIST_H
+
+#include "../configurator/allocator.hpp"
+#include "../iterator/iterator.hpp"
+#include "../utils/util.hpp"
+
+_MINISTL_BEGIN
+
+// 每个节点容纳的元素个数，与deque的缓冲区大小决定方式相同
+// n != 0 时由用户指定，否则令节点的数据区约为256字节，至少4个元素
+template <class T, size_t BufSiz>
+struct _unrolled_node_size {
+  static const size_t value =
+      BufSiz != 0 ? BufSiz : (sizeof(T) <= 64 ? 256 / sizeof(T) : 4);
+};
+
+struct _unrolled_list_node_base {
+  typedef _unrolled_list_node_base* base_ptr;
+  base_ptr prev;
+  base_ptr next;
+};
+// 节点：一小段连续数组，count为已使用的元素个数
+// 除header外，链表中的节点至少包含一个元素
+template <class T, size_t N>
+struct _unrolled_list_node : public _unrolled_list_node_base {
+  size_t count;
+  alignas(T) unsigned char buf[N * sizeof(T)];
+
+  T* data() { return reinterpret_cast<T*>(buf); }
+};
+
+// 迭代器：节点指针加节点内下标
+template <class T, class Ref, class Ptr, size_t BufSiz>
+struct _unrolled_list_iterator {
+  typedef _unrolled_list_iterator<T, T&, T*, BufSiz> iterator;
+  typedef _unrolled_list_iterator<T, const T&, const T*, BufSiz>
+      const_iterator;
+  typedef _unrolled_list_iterator<T, Ref, Ptr, BufSiz> self;
+  static size_t node_size() { return _unrolled_node_size<T, BufSiz>::value; }
+
+  typedef bidirectional_iterator_tag iterator_category;
+  typedef T value_type;
+  typedef Ptr pointer;
+  typedef Ref reference;
+  typedef size_t size_type;
+  typedef ptrdiff_t difference_type;
+  typedef _unrolled_list_node_base* base_ptr;
+  typedef _unrolled_list_node<T, _unrolled_node_size<T, BufSiz>::value>*
+      link_type;
+
+  base_ptr node;  // 所在节点，end()时为header
+  size_t idx;     // 节点内下标
+
+  _unrolled_list_iterator(base_ptr x, size_t i) : node(x), idx(i) {}
+  _unrolled_list_iterator() {}
+  _unrolled_list_iterator(const iterator& x) : node(x.node), idx(x.idx) {}
+
+  bool operator==(const self& x) const {
+    return node == x.node && idx == x.idx;
+  }
+  bool operator!=(const self& x) const { return !(*this == x); }
+
+  reference operator*() const { return link_type(node)->data()[idx]; }
+  pointer operator->() const { return &(operator*()); }
+
+  self& operator++() {
+    if (++idx == link_type(node)->count) {  // 走出当前节点
+      node = node->next;
+      idx = 0;
+    }
+    return *this;
+  }
+  self operator++(int) {
+    self tmp = *this;
+    ++*this;
+    return tmp;
+  }
+  self& operator--() {
+    if (idx == 0) {  // 退回上一个节点的末尾
+      node = node->prev;
+      idx = link_type(node)->count;
+    }
+    --idx;
+    return *this;
+  }
+  self operator--(int) {
+    self tmp = *this;
+    --*this;
+    return tmp;
+  }
+};
+
+// 展开链表（unrolled linked list）
+// 以小数组为节点的双向链表：遍历时大部分步进只是下标加一，
+// 迭代器附近的插入删除只搬动一个节点内的元素，整节点可以O(1)接合
+template <class T, class Alloc = alloc, size_t BufSiz = 0>
+class unrolled_list {
+ public:
+  typedef _unrolled_list_iterator<T, T&, T*, BufSiz> iterator;
+  typedef _unrolled_list_iterator<T, const T&, const T*, BufSiz>
+      const_iterator;
+  typedef ministl::reverse_iterator<iterator> reverse_iterator;
+  typedef ministl::reverse_iterator<const_iterator> const_reverse_iterator;
+
+  typedef T value_type;
+  typedef T& reference;
+  typedef const T& const_reference;
+  typedef T* pointer;
+  typedef const T* const_pointer;
+  typedef size_t size_type;
+  typedef ptrdiff_t difference_type;
+
+ protected:
+  typedef _unrolled_list_node_base node_base;
+  typedef node_base* base_ptr;
+  typedef _unrolled_list_node<T, _unrolled_node_size<T, BufSiz>::value>
+      list_node;
+  typedef list_node* link_type;
+  typedef allocator<list_node, Alloc> node_allocator;
+  typedef allocator<node_base, Alloc> header_allocator;
+
+  static size_type node_size() { return iterator::node_size(); }
+
+  base_ptr header;       // 哨兵节点，不含数据
+  size_type elem_count;  // 元素个数
+
+  link_type create_node() {
+    link_type p = node_allocator::allocate();
+    p->count = 0;
+    return p;
+  }
+  void destroy_node(link_type p) {
+    ministl::destroy(p->data(), p->data() + p->count);
+    node_allocator::deallocate(p);
+  }
+  // 在position之前链接节点p
+  static void link_before(base_ptr position, base_ptr p) {
+    p->next = position;
+    p->prev = position->prev;
+    position->prev->next = p;
+    position->prev = p;
+  }
+  static void unlink_node(base_ptr p) {
+    p->prev->next = p->next;
+    p->next->prev = p->prev;
+  }
+  // 将节点链[first, last]移动到position之前
+  static void transfer(base_ptr position, base_ptr first, base_ptr last) {
+    first->prev->next = last->next;
+    last->next->prev = first->prev;
+    first->prev = position->prev;
+    last->next = position;
+    position->prev->next = first;
+    position->prev = last;
+  }
+  // 把节点p中[idx, count)的元素搬到dst尾部
+  static void move_tail(link_type p, size_type idx, link_type dst) {
+    T* src = p->data();
+    T* out = dst->data() + dst->count;
+    for (size_type i = idx; i < p->count; ++i, ++out) {
+      construct(out, src[i]);
+      destroy(src + i);
+    }
+    dst->count += p->count - idx;
+    p->count = idx;
+  }
+  // 在下标idx处切开节点p，返回以该处元素开头的节点（可能为header）
+  base_ptr split_node(base_ptr p, size_type idx) {
+    if (p == header || idx == 0)
+      return p;
+    if (idx == link_type(p)->count)
+      return p->next;
+    link_type tmp = create_node();
+    move_tail(link_type(p), idx, tmp);
+    link_before(p->next, tmp);
+    return tmp;
+  }
+  void empty_initialize() {
+    header = header_allocator::allocate();
+    header->next = header;
+    header->prev = header;
+    elem_count = 0;
+  }
+
+ public:
+  unrolled_list() { empty_initialize(); }
+  unrolled_list(const unrolled_list& x) {
+    empty_initialize();
+    for (const_iterator it = x.begin(); it != x.end(); ++it)
+      push_back(*it);
+  }
+  unrolled_list& operator=(const unrolled_list& x) {
+    if (this != &x) {
+      unrolled_list tmp(x);
+      swap(tmp);
+    }
+    return *this;
+  }
+  ~unrolled_list() {
+    clear();
+    header_allocator::deallocate(header);
+  }
+
+  iterator begin() { return iterator(header->next, 0); }
+  const_iterator begin() const { return const_iterator(header->next, 0); }
+  iterator end() { return iterator(header, 0); }
+  const_iterator end() const { return const_iterator(header, 0); }
+  reverse_iterator rbegin() { return reverse_iterator(end()); }
+  const_reverse_iterator rbegin() const {
+    return const_reverse_iterator(end());
+  }
+  reverse_iterator rend() { return reverse_iterator(begin()); }
+  const_reverse_iterator rend() const {
+    return const_reverse_iterator(begin());
+  }
+  const_iterator cbegin() const { return begin(); }
+  const_iterator cend() const { return end(); }
+
+  bool empty() const { return elem_count == 0; }
+  size_type size() const { return elem_count; }
+  size_type max_size() const { return size_type(-1); }
+
+  reference front() { return *begin(); }
+  const_reference front() const { return *begin(); }
+  reference back() { return *(--end()); }
+  const_reference back() const { return *(--end()); }
+
+  // 在position之前插入x，只搬动一个节点内的元素
+  iterator insert(iterator position, const T& x);
+  void push_back(const T& x) { insert(end(), x); }
+  void push_front(const T& x) { insert(begin(), x); }
+
+  // 移除position所指元素，返回其后元素的迭代器
+  iterator erase(iterator position);
+  iterator erase(iterator first, iterator last) {
+    size_type n = distance(first, last);
+    while (n--)
+      first = erase(first);
+    return first;
+  }
+  void pop_front() { erase(begin()); }
+  void pop_back() { erase(--end()); }
+  void clear();
+
+  // 将x的全部元素接合于position之前，x必须不同于*this
+  // position位于节点中间时先切开该节点，其余只是节点链的重新链接
+  void splice(iterator position, unrolled_list& x) {
+    if (!x.empty()) {
+      base_ptr p = split_node(position.node, position.idx);
+      transfer(p, x.header->next, x.header->prev);
+      elem_count += x.elem_count;
+      x.elem_count = 0;
+    }
+  }
+  // 将x中[first,last)接合于position之前，x必须不同于*this
+  // 两端最多各切开一个节点，计数需要遍历被移动的节点，而非元素
+  void splice(iterator position,
+              unrolled_list& x,
+              iterator first,
+              iterator last);
+
+  void swap(unrolled_list& x) {
+    base_ptr tmp = x.header;
+    x.header = header;
+    header = tmp;
+    size_type n = x.elem_count;
+    x.elem_count = elem_count;
+    elem_count = n;
+  }
+};
+
+template <class T, class Alloc, size_t BufSiz>
+typename unrolled_list<T, Alloc, BufSiz>::iterator
+unrolled_list<T, Alloc, BufSiz>::insert(iterator position, const T& x) {
+  base_ptr p = position.node;
+  size_type idx = position.idx;
+  // 插入点位于节点开头时，优先放到前一节点尾部的空位
+  if (idx == 0 && p->prev != header &&
+      link_type(p->prev)->count < node_size()) {
+    p = p->prev;
+    idx = link_type(p)->count;
+  }
+  if (p == header) {  // 前一节点不存在或已满，新建节点
+    link_type tmp = create_node();
+    link_before(header, tmp);
+    p = tmp;
+  } else if (idx == 0 && link_type(p)->count == node_size()) {
+    link_type tmp = create_node();
+    link_before(p, tmp);
+    p = tmp;
+  } else if (link_type(p)->count == node_size()) {
+    // 节点已满，将后半部分搬到新节点
+    link_type tmp = create_node();
+    move_tail(link_type(p), node_size() / 2, tmp);
+    link_before(p->next, tmp);
+    if (idx > link_type(p)->count) {
+      idx -= link_type(p)->count;
+      p = tmp;
+    }
+  }
+  link_type n = link_type(p);
+  T* d = n->data();
+  if (idx == n->count) {
+    construct(d + idx, x);
+  } else {
+    T x_copy = x;
+    construct(d + n->count, d[n->count - 1]);
+    for (size_type i = n->count - 1; i > idx; --i)
+      d[i] = d[i - 1];
+    d[idx] = x_copy;
+  }
+  ++n->count;
+  ++elem_count;
+  return iterator(p, idx);
+}
+
+template <class T, class Alloc, size_t BufSiz>
+typename unrolled_list<T, Alloc, BufSiz>::iterator
+unrolled_list<T, Alloc, BufSiz>::erase(iterator position) {
+  link_type n = link_type(position.node);
+  size_type idx = position.idx;
+  T* d = n->data();
+  for (size_type i = idx + 1; i < n->count; ++i)
+    d[i - 1] = d[i];
+  destroy(d + n->count - 1);
+  --n->count;
+  --elem_count;
+  base_ptr next = n->next;
+  if (n->count == 0) {  // 节点已空，释放
+    unlink_node(n);
+    destroy_node(n);
+    return iterator(next, 0);
+  }
+  // 与后继节点合计不足半满时合并，保证节点的平均利用率
+  if (next != header &&
+      n->count + link_type(next)->count <= node_size() / 2) {
+    move_tail(link_type(next), 0, n);
+    unlink_node(next);
+    destroy_node(link_type(next));
+  }
+  if (idx == n->count)
+    return iterator(n->next, 0);
+  return iterator(n, idx);
+}
+
+template <class T, class Alloc, size_t BufSiz>
+void unrolled_list<T, Alloc, BufSiz>::clear() {
+  base_ptr cur = header->next;
+  while (cur != header) {
+    base_ptr tmp = cur;
+    cur = cur->next;
+    destroy_node(link_type(tmp));
+  }
+  header->next = header;
+  header->prev = header;
+  elem_count = 0;
+}
+
+template <class T, class Alloc, size_t BufSiz>
+void unrolled_list<T, Alloc, BufSiz>::splice(iterator position,
+                                             unrolled_list& x,
+                                             iterator first,
+                                             iterator last) {
+  if (first == last)
+    return;
+  // 先切last再切first，切开后first仍有效
+  base_ptr l = x.split_node(last.node, last.idx);
+  base_ptr f = x.split_node(first.node, first.idx);
+  size_type n = 0;
+  for (base_ptr cur = f; cur != l; cur = cur->next)
+    n += link_type(cur)->count;
+  base_ptr p = split_node(position.node, position.idx);
+  transfer(p, f, l->prev);
+  elem_count += n;
+  x.elem_count -= n;
+}
+
+_MINISTL_END
+
+#endif
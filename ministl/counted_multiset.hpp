@@ -0,0 +1,3 @@
+#pragma once
+
+#include "./container/counted_multiset.hpp"
\ No newline at end of file
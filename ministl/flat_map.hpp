@@ -0,0 +1,3 @@
+#pragma once
+
+#include "./container/flat_map.hpp"
\ No newline at end of file
@@ -52,7 +52,7 @@ inline T identity_element(multiplies<T>) {
   return T(1);
 }
 // 关系运算仿函数
-template <class T>
+template <class T = void>
 struct equal_to : public binary_function<T, T, bool> {
   bool operator()(const T& x, const T& y) const { return x == y; }
 };
@@ -68,10 +68,28 @@ template <class T>
 struct greater_equal : public binary_function<T, T, bool> {
   bool operator()(const T& x, const T& y) const { return x >= y; }
 };
-template <class T>
+template <class T = void>
 struct less : public binary_function<T, T, bool> {
   bool operator()(const T& x, const T& y) const { return x < y; }
 };
+// equal_to<>与less<>可比较任意两种型别的对象，定义了is_transparent，
+// 用作关联容器的透明比较器时可以不构造键值直接查找
+template <>
+struct equal_to<void> {
+  typedef void is_transparent;
+  template <class T, class U>
+  bool operator()(const T& x, const U& y) const {
+    return x == y;
+  }
+};
+template <>
+struct less<void> {
+  typedef void is_transparent;
+  template <class T, class U>
+  bool operator()(const T& x, const U& y) const {
+    return x < y;
+  }
+};
 template <class T>
 struct less_equal : public binary_function<T, T, bool> {
   bool operator()(const T& x, const T& y) const { return x <= y; }
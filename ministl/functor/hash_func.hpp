@@ -29,6 +29,15 @@ inline size_t _ministl_hash_string(const char* s) {
 
   return size_t(h);
 }
+// 长度为n的字符序列，结果与以'\0'结尾的版本相同
+template <class CharType>
+inline size_t _ministl_hash_string(const CharType* s, size_t n) {
+  unsigned long h = 0;
+  for (size_t i = 0; i < n; ++i)
+    h = 5 * h + s[i];
+
+  return size_t(h);
+}
 
 template <>
 struct hash<char*> {
@@ -0,0 +1,3 @@
+#pragma once
+
+#include "./container/intrusive_list.hpp"
\ No newline at end of file
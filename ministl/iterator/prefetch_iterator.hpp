@@ -0,0 +1,97 @@
+#ifndef MINISTL_PREFETCH_ITERATOR_H
+#define MINISTL_PREFETCH_ITERATOR_H
+
+#include "../utils/util.hpp"
+#include "iterator.hpp"
+
+_MINISTL_BEGIN
+
+// 默认的预取距离：提前几个元素发出预取
+const size_t _ministl_prefetch_distance = 8;
+
+// 预取迭代器配接器
+// 内部维护一个领先k步的迭代器，每前进一步就预取领先迭代器所指的元素
+// 只对随机访问迭代器（vector、deque、hashtable的bucket数组等连续存储）有效：
+// 领先的位置由地址算出，预取比访问早k个元素
+// 对链表、树等节点式容器，领先迭代器前进时就要读取它将要预取的节点，
+// 预取最多只早一个节点，也就掩盖不了访存延迟；这类容器的clear与复制
+// 因此不用它，而是在处理当前节点时直接以MINISTL_PREFETCH取下一个要处理的
+// 节点（树中为另一棵子树的根）
+template <class Iterator>
+class prefetch_iterator {
+ public:
+  typedef forward_iterator_tag iterator_category;
+  typedef typename iterator_traits<Iterator>::value_type value_type;
+  typedef typename iterator_traits<Iterator>::difference_type difference_type;
+  typedef typename iterator_traits<Iterator>::pointer pointer;
+  typedef typename iterator_traits<Iterator>::reference reference;
+  typedef Iterator iterator_type;
+  typedef prefetch_iterator<Iterator> self;
+
+ protected:
+  Iterator current;  // 当前位置
+  Iterator ahead;    // 领先的位置，最多到last
+  Iterator last;
+
+ public:
+  prefetch_iterator() {}
+  // 以[first, last)构造，领先first k步
+  prefetch_iterator(Iterator first,
+                    Iterator l,
+                    size_t k = _ministl_prefetch_distance)
+      : current(first), ahead(first), last(l) {
+    for (; k > 0 && ahead != last; --k) {
+      ++ahead;
+      if (ahead != last)
+        MINISTL_PREFETCH(&*ahead);
+    }
+  }
+
+  iterator_type base() const { return current; }
+
+  reference operator*() const { return *current; }
+  pointer operator->() const { return &(operator*()); }
+
+  self& operator++() {
+    ++current;
+    if (ahead != last) {
+      ++ahead;
+      if (ahead != last)
+        MINISTL_PREFETCH(&*ahead);
+    }
+    return *this;
+  }
+  self operator++(int) {
+    self tmp = *this;
+    ++*this;
+    return tmp;
+  }
+
+  bool operator==(const self& x) const { return current == x.current; }
+  bool operator!=(const self& x) const { return current != x.current; }
+  bool operator==(const Iterator& x) const { return current == x; }
+  bool operator!=(const Iterator& x) const { return current != x; }
+};
+
+template <class Iterator>
+inline prefetch_iterator<Iterator> make_prefetch_iterator(
+    Iterator first,
+    Iterator last,
+    size_t k = _ministl_prefetch_distance) {
+  return prefetch_iterator<Iterator>(first, last, k);
+}
+
+// 带预取的for_each，同prefetch_iterator只对随机访问迭代器有提前量
+template <class InputIter, class Function>
+Function prefetch_for_each(InputIter first,
+                           InputIter last,
+                           Function f,
+                           size_t k = _ministl_prefetch_distance) {
+  for (prefetch_iterator<InputIter> it(first, last, k); it != last; ++it)
+    f(*it);
+  return f;
+}
+
+_MINISTL_END
+
+#endif
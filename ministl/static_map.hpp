@@ -0,0 +1,3 @@
+#pragma once
+
+#include "./container/static_map.hpp"
\ No newline at end of file
@@ -0,0 +1,3 @@
+#pragma once
+
+#include "./container/unrolled_list.hpp"
\ No newline at end of file
@@ -12,8 +12,19 @@
 #define _MINISTL_BEGIN namespace ministl {
 #define _MINISTL_END }
 
+// 软件预取：提前把addr所在的缓存行读入缓存，不支持的编译器上为空操作
+#if defined(__GNUC__) || defined(__clang__)
+#define MINISTL_PREFETCH(addr) __builtin_prefetch((const void*)(addr))
+#else
+#define MINISTL_PREFETCH(addr) ((void)0)
+#endif
+
 _MINISTL_BEGIN
 
+// 标记以其余参数原地构造pair::second，见map::try_emplace
+struct _emplace_second_t {};
+const _emplace_second_t _emplace_second = _emplace_second_t();
+
 template <class T1, class T2>
 struct pair {
   typedef T1 first_type;
@@ -25,8 +36,34 @@ struct pair {
   pair() : first(T1()), second(T2()) {}
   pair(const T1& a, const T2& b) : first(a), second(b) {}
   pair(const pair<T1,T2> & p) : first(p.first), second(p.second){}
+  pair& operator=(const pair& p) {
+    first = p.first;
+    second = p.second;
+    return *this;
+  }
+  // 以a构造first，以args构造second，两者都不经过临时对象
+  template <class U, class... Args>
+  pair(_emplace_second_t, U&& a, Args&&... args)
+      : first(std::forward<U>(a)), second(std::forward<Args>(args)...) {}
 };
 
+// 元素能否以赋值覆盖，供容器重用节点时选择赋值还是析构后重新构造
+// pair总是声明了operator=，须逐个检查其成员
+template <class T>
+struct _is_assignable_value : std::is_copy_assignable<T> {};
+template <class T1, class T2>
+struct _is_assignable_value<pair<T1, T2>>
+    : std::integral_constant<bool,
+                             _is_assignable_value<T1>::value &&
+                                 _is_assignable_value<T2>::value> {};
+
+// 标记输入区间已按键值严格递增排列且没有重复
+struct sorted_unique_t {};
+const sorted_unique_t sorted_unique = sorted_unique_t();
+// 标记输入区间已按键值非递减排列，可以有重复
+struct sorted_equivalent_t {};
+const sorted_equivalent_t sorted_equivalent = sorted_equivalent_t();
+
 _MINISTL_END
 
 #endif
\ No newline at end of file
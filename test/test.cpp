@@ -1,6 +1,17 @@
+// 检查都写在assert中，且多带有副作用，不能随NDEBUG关闭
+#undef NDEBUG
+#include <algorithm>
+#include <cassert>
+#include <cstdlib>
 #include <iostream>
+#include <list>
+#include <map>
 #include <queue>
+#include <set>
+#include <stdexcept>
 #include <thread>
+#include <utility>
+#include <vector>
 #include "../ministl/vector.hpp"
 #include "../ministl/list.hpp"
 #include "../ministl/string.hpp"
@@ -8,13 +19,100 @@
 #include "../ministl/stack.hpp"
 #include "../ministl/set.hpp"
 #include "../ministl/map.hpp"
+#include "../ministl/intrusive_list.hpp"
+#include "../ministl/unrolled_list.hpp"
+#include "../ministl/flat_map.hpp"
+#include "../ministl/flat_set.hpp"
+#include "../ministl/btree_map.hpp"
+#include "../ministl/btree_set.hpp"
+#include "../ministl/concurrent_map.hpp"
+#include "../ministl/persistent_map.hpp"
+#include "../ministl/persistent_set.hpp"
+#include "../ministl/interval_map.hpp"
+#include "../ministl/static_map.hpp"
+#include "../ministl/static_set.hpp"
+#include "../ministl/compact_list.hpp"
+#include "../ministl/compact_map.hpp"
+#include "../ministl/compact_set.hpp"
+#include "../ministl/counted_multiset.hpp"
 using namespace ministl;
 void print(list<int> &a);
 void print(string &a);
 void print(deque<int> &a);
 void print(map<int, int> &a);
+void test_intrusive_list();
+void test_unrolled_list();
+void test_flat_map_set();
+void test_btree();
+void test_order_statistics();
+void test_set_operations();
+void test_concurrent_map();
+void test_persistent();
+void test_interval_map();
+void test_static_map_set();
+void test_compact();
+void test_counted_multiset();
+
+// 比较单个元素，ministl::pair与std::pair按first、second比较
+template <class A, class B>
+bool same_elem(const A &a, const B &b) { return a == b; }
+template <class K1, class V1, class K2, class V2>
+bool same_elem(const pair<K1, V1> &a, const std::pair<K2, V2> &b)
+{
+  return a.first == b.first && a.second == b.second;
+}
+
+// c与参照容器ref大小相同，且按迭代顺序逐个元素相同
+template <class C, class R>
+void check_same(const C &c, const R &ref)
+{
+  assert(c.size() == ref.size());
+  auto i = c.begin();
+  for (auto j = ref.begin(); j != ref.end(); ++i, ++j) {
+    assert(i != c.end());
+    assert(same_elem(*i, *j));
+  }
+  assert(i == c.end());
+}
+
+// 第n个元素的迭代器
+template <class C>
+typename C::iterator nth(C &c, size_t n)
+{
+  typename C::iterator it = c.begin();
+  while (n--)
+    ++it;
+  return it;
+}
+
+// 反向遍历也与参照容器一致
+template <class C, class R>
+void check_same_reverse(const C &c, const R &ref)
+{
+  auto i = c.end();
+  for (auto j = ref.end(); j != ref.begin();) {
+    assert(i != c.begin());
+    assert(same_elem(*--i, *--j));
+  }
+  assert(i == c.begin());
+}
+
 int main()
 {
+  srand(1);
+  test_intrusive_list();
+  test_unrolled_list();
+  test_flat_map_set();
+  test_btree();
+  test_order_statistics();
+  test_set_operations();
+  test_concurrent_map();
+  test_persistent();
+  test_interval_map();
+  test_static_map_set();
+  test_compact();
+  test_counted_multiset();
+
   map<int, int> a;
   
   a[1] = 1;
@@ -26,8 +124,1088 @@ int main()
   return 0;
 }
 
+struct intrusive_item {
+  int v;
+  intrusive_list_hook hook;
+  explicit intrusive_item(int x) : v(x) {}
+  bool operator==(int x) const { return v == x; }
+};
+struct intrusive_item_less {
+  bool operator()(const intrusive_item &a, const intrusive_item &b) const
+  {
+    return a.v < b.v;
+  }
+};
+
+void test_intrusive_list()
+{
+  typedef intrusive_list<intrusive_item, &intrusive_item::hook> ilist;
+  std::vector<intrusive_item> items;
+  items.reserve(200);  // 元素链入之后不能再搬动
+  for (int i = 0; i < 200; ++i)
+    items.push_back(intrusive_item(i));
+
+  ilist l;
+  std::list<int> ref;
+  for (int i = 0; i < 100; ++i) {
+    if (i % 3 == 0) {
+      l.push_front(items[i]);
+      ref.push_front(i);
+    } else {
+      l.push_back(items[i]);
+      ref.push_back(i);
+    }
+  }
+  check_same(l, ref);
+  check_same_reverse(l, ref);
+  assert(l.front().v == ref.front() && l.back().v == ref.back());
+
+  // 经链表erase与元素自行unlink两种方式摘除
+  for (int i = 0; i < 100; i += 7) {
+    assert(items[i].hook.is_linked());
+    if (i % 2)
+      l.erase(ilist::iterator_to(items[i]));
+    else
+      items[i].hook.unlink();
+    assert(!items[i].hook.is_linked());
+    ref.remove(i);
+  }
+  check_same(l, ref);
+  check_same_reverse(l, ref);
+
+  // 在iterator_to所得位置之前插入
+  l.insert(ilist::iterator_to(items[50]), items[150]);
+  std::list<int>::iterator r = ref.begin();
+  while (*r != 50)
+    ++r;
+  ref.insert(r, 150);
+  check_same(l, ref);
+
+  // 整段与单个元素的splice
+  ilist m;
+  std::list<int> mref;
+  for (int i = 160; i < 170; ++i) {
+    m.push_back(items[i]);
+    mref.push_back(i);
+  }
+  l.splice(l.begin(), m, ilist::iterator_to(items[165]));
+  mref.remove(165);
+  ref.push_front(165);
+  check_same(m, mref);
+  l.splice(l.end(), m);
+  ref.splice(ref.end(), mref);
+  assert(m.empty());
+  check_same(l, ref);
+  check_same_reverse(l, ref);
+
+  l.reverse();
+  ref.reverse();
+  check_same(l, ref);
+  check_same_reverse(l, ref);
+
+  // 两个有序链表的merge
+  ilist a, b;
+  std::list<int> aref, bref;
+  for (int i = 170; i < 200; ++i) {
+    if (i % 3) {
+      a.push_back(items[i]);
+      aref.push_back(i);
+    } else {
+      b.push_back(items[i]);
+      bref.push_back(i);
+    }
+  }
+  a.merge(b, intrusive_item_less());
+  aref.merge(bref);
+  assert(b.empty());
+  check_same(a, aref);
+  check_same_reverse(a, aref);
+
+  a.swap(l);
+  check_same(a, ref);
+  check_same(l, aref);
+  l.clear();
+  assert(l.empty() && l.size() == 0);
+  assert(!items[170].hook.is_linked());
+  a.clear();
+}
+
 void print(map<int, int> &a){
   for(auto b = a.begin(); b!=a.end(); ++b){
     std::cout << b->first<< "==" << b->second << std::endl;
   }
 }
+
+void test_unrolled_list()
+{
+  // 每个节点只放4个元素，插入删除频繁地切分与合并节点
+  typedef unrolled_list<int, alloc, 4> ulist;
+  ulist l;
+  std::list<int> ref;
+  for (int i = 0; i < 3000; ++i) {
+    size_t k = ref.empty() ? 0 : rand() % (ref.size() + 1);
+    if (ref.empty() || rand() % 3) {
+      ulist::iterator it = l.insert(nth(l, k), i);
+      assert(*it == i);
+      ref.insert(nth(ref, k), i);
+    } else {
+      k = k % ref.size();
+      ulist::iterator it = l.erase(nth(l, k));
+      std::list<int>::iterator r = ref.erase(nth(ref, k));
+      assert(r == ref.end() ? it == l.end() : *it == *r);
+    }
+  }
+  check_same(l, ref);
+  check_same_reverse(l, ref);
+  assert(l.front() == ref.front() && l.back() == ref.back());
+
+  ulist c(l);
+  check_same(c, ref);
+  c.erase(nth(c, 10), nth(c, 300));
+  std::list<int> cref(ref);
+  cref.erase(nth(cref, 10), nth(cref, 300));
+  check_same(c, cref);
+  check_same_reverse(c, cref);
+
+  // 区间splice两端落在节点中间
+  ulist m;
+  std::list<int> mref;
+  for (int i = 0; i < 50; ++i) {
+    m.push_back(-i);
+    mref.push_back(-i);
+  }
+  l.splice(nth(l, 5), m, nth(m, 3), nth(m, 41));
+  ref.splice(nth(ref, 5), mref, nth(mref, 3), nth(mref, 41));
+  check_same(l, ref);
+  check_same(m, mref);
+  check_same_reverse(m, mref);
+  l.splice(nth(l, 17), m);
+  ref.splice(nth(ref, 17), mref);
+  assert(m.empty());
+  check_same(l, ref);
+  check_same_reverse(l, ref);
+
+  while (!l.empty()) {
+    l.pop_front();
+    ref.pop_front();
+    if (!l.empty()) {
+      l.pop_back();
+      ref.pop_back();
+    }
+  }
+  assert(l.size() == 0 && l.begin() == l.end());
+  c = l;
+  assert(c.empty());
+}
+
+void test_flat_map_set()
+{
+  flat_map<int, int> m;
+  flat_set<int> s;
+  std::map<int, int> mref;
+  std::set<int> sref;
+  for (int i = 0; i < 2000; ++i) {
+    int k = rand() % 500;
+    if (rand() % 4) {
+      bool fresh = mref.find(k) == mref.end();
+      assert(m.insert(pair<int, int>(k, i)).second == fresh);
+      assert(s.insert(k).second == fresh);
+      mref.insert(std::make_pair(k, i));
+      sref.insert(k);
+    } else {
+      size_t n = mref.erase(k);
+      assert(m.erase(k) == n);
+      assert(s.erase(k) == n);
+      sref.erase(k);
+    }
+  }
+  check_same(m, mref);
+  check_same_reverse(m, mref);
+  check_same(s, sref);
+  check_same_reverse(s, sref);
+
+  for (int k = -1; k <= 501; ++k) {
+    std::map<int, int>::iterator r = mref.find(k);
+    flat_map<int, int>::iterator it = m.find(k);
+    assert(r == mref.end() ? it == m.end() : (*it).second == r->second);
+    assert((s.find(k) == s.end()) == (sref.find(k) == sref.end()));
+    std::set<int>::iterator lb = sref.lower_bound(k);
+    flat_set<int>::iterator slb = s.lower_bound(k);
+    assert(lb == sref.end() ? slb == s.end() : *slb == *lb);
+    std::set<int>::iterator ub = sref.upper_bound(k);
+    flat_set<int>::iterator sub = s.upper_bound(k);
+    assert(ub == sref.end() ? sub == s.end() : *sub == *ub);
+    assert(size_t(s.equal_range(k).second - s.equal_range(k).first) ==
+           sref.count(k));
+  }
+  m[1000] = 7;
+  mref[1000] = 7;
+  ++m[3];
+  ++mref[3];
+  check_same(m, mref);
+
+  // 无序批量插入，重复的键只保留先出现的一个
+  std::vector<pair<int, int> > batch;
+  for (int i = 0; i < 800; ++i) {
+    int k = rand() % 1500;
+    batch.push_back(pair<int, int>(k, -i));
+    mref.insert(std::make_pair(k, -i));
+  }
+  m.insert(batch.begin(), batch.end());
+  check_same(m, mref);
+
+  // sorted_unique：输入已有序且无重复，直接建立
+  std::vector<int> sorted;
+  for (int i = 0; i < 1000; ++i)
+    sorted.push_back(i * 3);
+  flat_set<int> fs(sorted_unique, sorted.begin(), sorted.end());
+  check_same(fs, sorted);
+  fs.insert(sorted_unique, sorted.begin(), sorted.end());
+  check_same(fs, sorted);
+  std::vector<pair<int, int> > sorted_pairs;
+  std::map<int, int> pref;
+  for (int i = 0; i < 1000; ++i) {
+    sorted_pairs.push_back(pair<int, int>(i * 2, i));
+    pref.insert(std::make_pair(i * 2, i));
+  }
+  flat_map<int, int> fm(sorted_unique, sorted_pairs.begin(),
+                        sorted_pairs.end());
+  check_same(fm, pref);
+
+  fm.erase(fm.find(10), fm.find(1000));
+  pref.erase(pref.find(10), pref.find(1000));
+  check_same(fm, pref);
+  check_same_reverse(fm, pref);
+}
+
+struct btree_odd_key {
+  template <class P>
+  bool operator()(const P &x) const { return x.first % 2; }
+};
+
+void test_btree()
+{
+  // 元素足够多，叶节点与内部节点都会反复分裂与合并
+  btree_map<int, int> m;
+  std::map<int, int> ref;
+  for (int i = 0; i < 30000; ++i) {
+    int k = rand() % 8000;
+    if (rand() % 3) {
+      bool fresh = ref.find(k) == ref.end();
+      pair<btree_map<int, int>::iterator, bool> r =
+          m.insert(pair<int, int>(k, i));
+      assert(r.second == fresh && (*r.first).first == k);
+      ref.insert(std::make_pair(k, i));
+    } else {
+      assert(m.erase(k) == ref.erase(k));
+    }
+  }
+  check_same(m, ref);
+  check_same_reverse(m, ref);
+  for (int k = -1; k <= 8001; ++k) {
+    std::map<int, int>::iterator r = ref.find(k);
+    btree_map<int, int>::iterator it = m.find(k);
+    assert(r == ref.end() ? it == m.end() : (*it).second == r->second);
+    assert(m.count(k) == ref.count(k));
+    std::map<int, int>::iterator lb = ref.lower_bound(k);
+    btree_map<int, int>::iterator mlb = m.lower_bound(k);
+    assert(lb == ref.end() ? mlb == m.end() : (*mlb).first == lb->first);
+    std::map<int, int>::iterator ub = ref.upper_bound(k);
+    btree_map<int, int>::iterator mub = m.upper_bound(k);
+    assert(ub == ref.end() ? mub == m.end() : (*mub).first == ub->first);
+  }
+
+  // try_emplace不覆盖，insert_or_assign覆盖，operator[]缺失时插入
+  assert(!m.try_emplace((*m.begin()).first, -1).second);
+  assert(m.try_emplace(9000, -1).second);
+  ref.insert(std::make_pair(9000, -1));
+  assert(!m.insert_or_assign(9000, -2).second);
+  ref[9000] = -2;
+  assert(m.insert_or_assign(9001, -3).second);
+  ref[9001] = -3;
+  m[9002] += 5;
+  ref[9002] += 5;
+  check_same(m, ref);
+
+  // 横跨多个叶节点的区间删除
+  btree_map<int, int> c(m);
+  std::map<int, int> cref(ref);
+  btree_map<int, int>::iterator it =
+      c.erase(c.lower_bound(1000), c.lower_bound(6000));
+  cref.erase(cref.lower_bound(1000), cref.lower_bound(6000));
+  assert((*it).first == cref.lower_bound(1000)->first);
+  check_same(c, cref);
+  check_same_reverse(c, cref);
+  c.erase(c.begin(), c.end());
+  assert(c.empty() && c.begin() == c.end());
+
+  size_t odd = 0;
+  for (std::map<int, int>::iterator r = ref.begin(); r != ref.end();)
+    if (r->first % 2) {
+      ref.erase(r++);
+      ++odd;
+    } else {
+      ++r;
+    }
+  assert(erase_if(m, btree_odd_key()) == odd);
+  check_same(m, ref);
+  btree_map<int, int> moved(std::move(m));
+  assert(m.empty());
+  check_same(moved, ref);
+
+  // sorted_unique批量建立，再删去大部分元素
+  std::vector<int> sorted;
+  for (int i = 0; i < 20000; ++i)
+    sorted.push_back(i * 2);
+  btree_set<int> s(sorted_unique, sorted.begin(), sorted.end());
+  std::set<int> sref(sorted.begin(), sorted.end());
+  check_same(s, sref);
+  for (int i = 0; i < 18000; ++i) {
+    int k = rand() % 40000;
+    assert(s.erase(k) == sref.erase(k));
+  }
+  check_same(s, sref);
+  check_same_reverse(s, sref);
+  assert(*s.emplace(-5).first == -5);
+  sref.insert(-5);
+  check_same(s, sref);
+
+  // 重复的键按插入顺序排在已有元素之后
+  btree_multimap<int, int> mm;
+  std::multimap<int, int> mmref;
+  btree_multiset<int> ms;
+  std::multiset<int> msref;
+  for (int i = 0; i < 20000; ++i) {
+    int k = rand() % 300;
+    if (rand() % 5) {
+      mm.insert(pair<int, int>(k, i));
+      mmref.insert(std::make_pair(k, i));
+      ms.insert(k);
+      msref.insert(k);
+    } else {
+      assert(mm.erase(k) == mmref.erase(k));
+      assert(ms.erase(k) == msref.erase(k));
+    }
+  }
+  check_same(mm, mmref);
+  check_same_reverse(mm, mmref);
+  check_same(ms, msref);
+  for (int k = 0; k < 300; ++k) {
+    assert(mm.count(k) == mmref.count(k));
+    assert(ms.count(k) == msref.count(k));
+    size_t n = 0;
+    for (btree_multiset<int>::iterator i = ms.equal_range(k).first;
+         i != ms.equal_range(k).second; ++i, ++n)
+      assert(*i == k);
+    assert(n == msref.count(k));
+  }
+}
+
+// 逐个检查rank/select/index_of与有序参照数组一致
+template <class S>
+void check_ranks(const S &s, const std::vector<int> &ref)
+{
+  assert(s.size() == ref.size());
+  assert(s.select(ref.size()) == s.end());
+  assert(s.index_of(s.end()) == ref.size());
+  typename S::iterator it = s.begin();
+  for (size_t i = 0; i < ref.size(); ++i, ++it) {
+    assert(s.select(i) == it);
+    assert(s.index_of(it) == i);
+    assert(s.rank(ref[i]) == i);
+    assert(s.rank(ref[i] + 1) ==
+           size_t(std::lower_bound(ref.begin(), ref.end(), ref[i] + 1) -
+                  ref.begin()));
+  }
+}
+
+void test_order_statistics()
+{
+  ranked_set<int> s;
+  std::set<int> ref;
+  for (int i = 0; i < 5000; ++i) {
+    int k = rand() % 3000;
+    if (rand() % 3) {
+      s.insert(k);
+      ref.insert(k);
+    } else {
+      assert(s.erase(k) == ref.erase(k));
+    }
+  }
+  check_same(s, ref);
+  check_ranks(s, std::vector<int>(ref.begin(), ref.end()));
+  assert(s.rank(-1) == 0 && s.rank(3000) == s.size());
+  assert(s.distance(s.select(10), s.select(400)) == 390);
+  assert(s.distance(s.select(400), s.select(10)) == -390);
+
+  // 大区间删除与集合运算经split/join，子树大小要随之维护
+  s.erase(s.select(100), s.select(1000));
+  std::set<int>::iterator b = ref.begin(), e;
+  std::advance(b, 100);
+  e = b;
+  std::advance(e, 900);
+  ref.erase(b, e);
+  check_same(s, ref);
+  check_ranks(s, std::vector<int>(ref.begin(), ref.end()));
+
+  ranked_set<int> t;
+  for (int i = 0; i < 3000; i += 7) {
+    t.insert(i);
+    ref.insert(i);
+  }
+  s.union_with(t);
+  check_same(s, ref);
+  check_ranks(s, std::vector<int>(ref.begin(), ref.end()));
+
+  ranked_map<int, int> m;
+  std::map<int, int> mref;
+  for (int i = 0; i < 2000; ++i) {
+    int k = rand() % 1000;
+    m[k] = i;
+    mref[k] = i;
+  }
+  check_same(m, mref);
+  size_t i = 0;
+  for (std::map<int, int>::iterator r = mref.begin(); r != mref.end();
+       ++r, ++i) {
+    assert((*m.select(i)).first == r->first);
+    assert(m.rank(r->first) == i);
+    assert(m.index_of(m.find(r->first)) == i);
+  }
+}
+
+// n个不同的随机键值，取自[0, range)
+std::vector<int> random_keys(size_t n, int range)
+{
+  std::set<int> keys;
+  while (keys.size() < n)
+    keys.insert(rand() % range);
+  return std::vector<int>(keys.begin(), keys.end());
+}
+
+void test_set_operations()
+{
+  // 大小悬殊、相近、一方为空以及不相交的各种组合
+  const size_t sizes[][2] = {{0, 100},     {100, 0},       {30, 40000},
+                             {40000, 30}, {20000, 25000}, {3000, 3000}};
+  for (size_t c = 0; c < sizeof(sizes) / sizeof(sizes[0]); ++c) {
+    std::vector<int> a = random_keys(sizes[c][0], 100000);
+    std::vector<int> b = random_keys(sizes[c][1], 100000);
+    if (c == 5)  // 两者不相交
+      for (size_t i = 0; i < b.size(); ++i)
+        b[i] += 100000;
+    std::vector<int> u, n, d;
+    std::set_union(a.begin(), a.end(), b.begin(), b.end(),
+                   std::back_inserter(u));
+    std::set_intersection(a.begin(), a.end(), b.begin(), b.end(),
+                          std::back_inserter(n));
+    std::set_difference(a.begin(), a.end(), b.begin(), b.end(),
+                        std::back_inserter(d));
+    set<int> sa(a.data(), a.data() + a.size());
+    set<int> sb(b.data(), b.data() + b.size());
+
+    set<int> r(sa);
+    r.union_with(sb);
+    check_same(r, u);
+    check_same_reverse(r, u);
+    check_same(sb, b);  // 以左值传入时x不变
+    r = sa;
+    r.union_with(set<int>(sb));
+    check_same(r, u);
+    r = sa;
+    r.intersect_with(sb);
+    check_same(r, n);
+    check_same_reverse(r, n);
+    r = sa;
+    r.difference_with(sb);
+    check_same(r, d);
+    check_same_reverse(r, d);
+    // 结果仍是可以正常增删的红黑树
+    for (int i = 0; i < 1000; ++i) {
+      int k = rand() % 100000;
+      r.insert(k);
+      d.insert(std::lower_bound(d.begin(), d.end(), k), k);
+      d.erase(std::unique(d.begin(), d.end()), d.end());
+    }
+    check_same(r, d);
+  }
+
+  // map的键值相同时保留本map的实值
+  map<int, int> ma, mb;
+  std::map<int, int> ref;
+  for (int i = 0; i < 5000; ++i) {
+    int k = rand() % 8000;
+    ma[k] = 1;
+    ref[k] = 1;
+  }
+  for (int i = 0; i < 5000; ++i) {
+    int k = rand() % 8000;
+    mb[k] = 2;
+    ref.insert(std::make_pair(k, 2));
+  }
+  map<int, int> mu(ma);
+  mu.union_with(mb);
+  check_same(mu, ref);
+  map<int, int> mi(ma);
+  mi.intersect_with(mb);
+  std::map<int, int> iref;
+  for (map<int, int>::iterator it = ma.begin(); it != ma.end(); ++it)
+    if (mb.find((*it).first) != mb.end())
+      iref.insert(std::make_pair((*it).first, 1));
+  check_same(mi, iref);
+  mi.difference_with(mi);
+  assert(mi.empty());
+
+  // 超过split门限的区间删除以split/join摘下整段
+  set<int> big;
+  std::vector<int> keys = random_keys(20000, 1000000);
+  for (size_t i = 0; i < keys.size(); ++i)
+    big.insert(keys[i]);
+  for (int round = 0; round < 20 && keys.size() > 10; ++round) {
+    size_t lo = rand() % (keys.size() / 2);
+    size_t hi = lo + rand() % (keys.size() - lo);
+    big.erase(big.find(keys[lo]), hi == keys.size() ? big.end()
+                                                    : big.find(keys[hi]));
+    keys.erase(keys.begin() + lo, keys.begin() + hi);
+    check_same(big, keys);
+  }
+  check_same_reverse(big, keys);
+}
+
+typedef concurrent_map<int, int> cmap;
+
+// 写者每次发布都同时加入k与k + 100000，读者看到的每个版本都应成对
+void concurrent_map_reader(const cmap *c, int rounds)
+{
+  for (int r = 0; r < rounds; ++r) {
+    cmap::snapshot s = c->read();
+    size_t n = 0;
+    int prev = -1;
+    for (cmap::map_type::const_iterator it = s->begin();
+         it != s->end(); ++it, ++n) {
+      int k = (*it).first;
+      assert(k > prev);
+      prev = k;
+      assert((*it).second == k);
+      if (k < 100000)
+        assert(s->count(k + 100000) == 1);
+    }
+    assert(n == s->size() && n % 2 == 0);
+  }
+}
+
+void test_concurrent_map()
+{
+  cmap c;
+  std::map<int, int> ref;
+  for (int i = 0; i < 3000; ++i) {
+    int k = rand() % 1000;
+    switch (rand() % 3) {
+      case 0:
+        assert(c.insert(pair<int, int>(k, i)) ==
+               ref.insert(std::make_pair(k, i)).second);
+        break;
+      case 1:
+        c.insert_or_assign(k, i);
+        ref[k] = i;
+        break;
+      default:
+        assert(c.erase(k) == ref.erase(k));
+    }
+  }
+  assert(c.size() == ref.size());
+  check_same(*c.read(), ref);
+  for (int k = 0; k < 1000; ++k) {
+    int v = -1;
+    std::map<int, int>::iterator r = ref.find(k);
+    assert(c.get(k, v) == (r != ref.end()));
+    assert(c.contains(k) == (r != ref.end()));
+    if (r != ref.end())
+      assert(v == r->second);
+  }
+
+  // 快照不受之后的写入影响
+  {
+    cmap::snapshot s = c.read();
+    std::map<int, int> old(ref);
+    c.update([](cmap::map_type &m) {
+      for (int k = 0; k < 500; ++k)
+        m.erase(k);
+      m.insert_or_assign(5000, 1);
+    });
+    for (int k = 0; k < 500; ++k)
+      ref.erase(k);
+    ref[5000] = 1;
+    check_same(*s, old);
+    check_same(*c.read(), ref);
+  }
+  // update中抛出异常时什么也不发布
+  try {
+    c.update([](cmap::map_type &m) {
+      m.clear();
+      throw std::runtime_error("abort");
+    });
+    assert(false);
+  } catch (std::runtime_error &) {
+  }
+  check_same(*c.read(), ref);
+  c.clear();
+  assert(c.empty() && c.size() == 0);
+
+  // 一个写者与两个读者并发
+  std::thread r1(concurrent_map_reader, &c, 300);
+  std::thread r2(concurrent_map_reader, &c, 300);
+  for (int k = 0; k < 2000; ++k)
+    c.update([k](cmap::map_type &m) {
+      m.insert_or_assign(k, k);
+      m.insert_or_assign(k + 100000, k + 100000);
+    });
+  r1.join();
+  r2.join();
+  assert(c.size() == 4000);
+}
+
+void test_persistent()
+{
+  // 每步修改前取一次快照，最后逐个核对各快照仍是当时的内容
+  persistent_set<int> s;
+  std::set<int> ref;
+  std::vector<persistent_set<int> > snaps;
+  std::vector<std::set<int> > refs;
+  for (int i = 0; i < 3000; ++i) {
+    if (i % 10 == 0) {
+      snaps.push_back(s);
+      refs.push_back(ref);
+      assert(snaps.back().shares_root_with(s));
+    }
+    int k = rand() % 1000;
+    if (rand() % 3) {
+      pair<persistent_set<int>::iterator, bool> r = s.insert(k);
+      assert(r.second == ref.insert(k).second && *r.first == k);
+    } else {
+      assert(s.erase(k) == ref.erase(k));
+    }
+  }
+  check_same(s, ref);
+  check_same_reverse(s, ref);
+  for (size_t i = 0; i < snaps.size(); ++i)
+    check_same(snaps[i], refs[i]);
+  for (int k = -1; k <= 1000; ++k) {
+    assert(s.count(k) == ref.count(k));
+    std::set<int>::iterator lb = ref.lower_bound(k);
+    persistent_set<int>::iterator slb = s.lower_bound(k);
+    assert(lb == ref.end() ? slb == s.end() : *slb == *lb);
+    std::set<int>::iterator ub = ref.upper_bound(k);
+    persistent_set<int>::iterator sub = s.upper_bound(k);
+    assert(ub == ref.end() ? sub == s.end() : *sub == *ub);
+  }
+  std::vector<int> seen;
+  s.for_each([&seen](int x) { seen.push_back(x); });
+  check_same(seen, ref);
+
+  // 修改快照不影响原对象
+  persistent_set<int> t(s);
+  t.clear();
+  assert(t.empty() && !t.shares_root_with(s));
+  check_same(s, ref);
+
+  persistent_map<int, int> m;
+  std::map<int, int> mref;
+  std::vector<persistent_map<int, int> > msnaps;
+  std::vector<std::map<int, int> > mrefs;
+  for (int i = 0; i < 3000; ++i) {
+    if (i % 10 == 0) {
+      msnaps.push_back(m);
+      mrefs.push_back(mref);
+    }
+    int k = rand() % 500;
+    switch (rand() % 3) {
+      case 0: {
+        pair<persistent_map<int, int>::iterator, bool> r =
+            m.insert(pair<int, int>(k, i));
+        bool fresh = mref.insert(std::make_pair(k, i)).second;
+        assert(r.second == fresh && (*r.first).second == mref[k]);
+        break;
+      }
+      case 1: {
+        bool fresh = mref.find(k) == mref.end();
+        assert(m.insert_or_assign(k, i).second == fresh);
+        mref[k] = i;
+        break;
+      }
+      default:
+        assert(m.erase(k) == mref.erase(k));
+    }
+  }
+  check_same(m, mref);
+  for (size_t i = 0; i < msnaps.size(); ++i)
+    check_same(msnaps[i], mrefs[i]);
+  for (std::map<int, int>::iterator r = mref.begin(); r != mref.end(); ++r)
+    assert(m.at(r->first) == r->second);
+  bool thrown = false;
+  try {
+    m.at(-1);
+  } catch (std::out_of_range &) {
+    thrown = true;
+  }
+  assert(thrown);
+}
+
+// 区间的参照：以(low, high)为键的std::multimap，实值为插入序号
+typedef std::multimap<std::pair<int, int>, int> interval_ref;
+
+template <class M>
+void check_intervals(const M &m, const interval_ref &ref)
+{
+  assert(m.size() == ref.size());
+  typename M::const_iterator it = m.begin();
+  for (interval_ref::const_iterator r = ref.begin(); r != ref.end();
+       ++r, ++it) {
+    assert((*it).first.low == r->first.first);
+    assert((*it).first.high == r->first.second);
+    assert((*it).second == r->second);
+  }
+  assert(it == m.end());
+}
+
+// 与[lo, hi]相交的元素，按区间顺序
+std::vector<int> brute_overlaps(const interval_ref &ref, int lo, int hi)
+{
+  std::vector<int> v;
+  for (interval_ref::const_iterator r = ref.begin(); r != ref.end(); ++r)
+    if (r->first.first <= hi && r->first.second >= lo)
+      v.push_back(r->second);
+  return v;
+}
+
+// 依次记下查询结果的实值
+struct collect_mapped {
+  std::vector<int> &out;
+  explicit collect_mapped(std::vector<int> &v) : out(v) {}
+  template <class V>
+  void operator()(const V &v) const { out.push_back(v.second); }
+};
+
+void test_interval_map()
+{
+  typedef interval_map<int, int> imap;
+  imap m;
+  interval_ref ref;
+  for (int i = 0; i < 3000; ++i) {
+    int lo = rand() % 1000;
+    int hi = lo + rand() % (rand() % 4 ? 20 : 300);
+    if (rand() % 4) {
+      imap::iterator it = m.insert(lo, hi, i);
+      assert((*it).second == i);
+      ref.insert(std::make_pair(std::make_pair(lo, hi), i));
+    } else if (!ref.empty()) {
+      // 删去某个已有区间的第一次出现
+      interval_ref::iterator r = ref.begin();
+      std::advance(r, rand() % ref.size());
+      r = ref.lower_bound(r->first);
+      imap::iterator it =
+          m.find(interval<int>(r->first.first, r->first.second));
+      assert((*it).second == r->second);
+      m.erase(it);
+      ref.erase(r);
+    }
+  }
+  check_intervals(m, ref);
+
+  // 区间与点的查询，结果的个数与顺序都与逐个检查相同
+  for (int q = 0; q < 500; ++q) {
+    int lo = rand() % 1400 - 200;
+    int hi = lo + rand() % 50;
+    std::vector<int> want = brute_overlaps(ref, lo, hi);
+    std::vector<int> got;
+    m.for_each_overlap(lo, hi, collect_mapped(got));
+    assert(got == want);
+    assert(m.count_overlaps(lo, hi) == want.size());
+    imap::iterator any = m.find_overlap(lo, hi);
+    if (want.empty()) {
+      assert(any == m.end());
+    } else {
+      assert((*any).first.low <= hi && (*any).first.high >= lo);
+    }
+
+    std::vector<int> stab = brute_overlaps(ref, lo, lo);
+    got.clear();
+    m.for_each_containing(lo, collect_mapped(got));
+    assert(got == stab);
+  }
+
+  // 按区间整个删除后，最大右端点仍正确维护
+  for (int i = 0; i < 200 && !ref.empty(); ++i) {
+    interval_ref::iterator r = ref.begin();
+    std::advance(r, rand() % ref.size());
+    std::pair<int, int> k = r->first;
+    assert(m.erase(interval<int>(k.first, k.second)) == ref.erase(k));
+  }
+  check_intervals(m, ref);
+  for (int x = -10; x < 1400; x += 7)
+    assert(m.count_overlaps(x, x) == brute_overlaps(ref, x, x).size());
+
+  imap c(m);
+  check_intervals(c, ref);
+  m.clear();
+  assert(m.empty() && m.count_overlaps(0, 2000) == 0);
+  assert(m.find_overlap(0, 2000) == m.end());
+  check_intervals(c, ref);
+}
+
+// 对[lo, hi]内的每个键比较查找结果
+template <class S, class R>
+void check_lookups(const S &s, const R &ref, int lo, int hi)
+{
+  for (int k = lo; k <= hi; ++k) {
+    assert((s.find(k) == s.end()) == (ref.find(k) == ref.end()));
+    assert(s.count(k) == ref.count(k));
+    typename R::const_iterator lb = ref.lower_bound(k);
+    typename S::const_iterator slb = s.lower_bound(k);
+    assert(lb == ref.end() ? slb == s.end() : same_elem(*slb, *lb));
+    typename R::const_iterator ub = ref.upper_bound(k);
+    typename S::const_iterator sub = s.upper_bound(k);
+    assert(ub == ref.end() ? sub == s.end() : same_elem(*sub, *ub));
+    assert(s.equal_range(k).first == slb && s.equal_range(k).second == sub);
+  }
+}
+
+void test_static_map_set()
+{
+  // 各种大小，Eytzinger数组的最后一层有满、不满与只有一个的情形
+  for (int n = 0; n < 2000; n = n < 70 ? n + 1 : n * 3) {
+    std::vector<int> keys;
+    for (int i = 0; i < n; ++i)
+      keys.push_back(rand() % (2 * n + 1));  // 含重复的键
+    static_set<int> s(keys.data(), keys.data() + keys.size());
+    std::set<int> ref(keys.begin(), keys.end());
+    check_same(s, ref);
+    check_same_reverse(s, ref);
+    check_lookups(s, ref, -1, 2 * n + 2);
+  }
+
+  std::set<int> ref;
+  set<int> src;
+  std::map<int, int> mref;
+  map<int, int> msrc;
+  for (int i = 0; i < 5000; ++i) {
+    int k = rand() % 20000;
+    ref.insert(k);
+    src.insert(k);
+    mref.insert(std::make_pair(k, i));
+    msrc.insert(pair<int, int>(k, i));
+  }
+  static_set<int> fs = freeze(src);
+  check_same(fs, ref);
+  check_lookups(fs, ref, -1, 20001);
+  std::vector<int> sorted(ref.begin(), ref.end());
+  static_set<int> us(sorted_unique, sorted.data(),
+                     sorted.data() + sorted.size());
+  assert(us == fs);
+  check_same_reverse(us, ref);
+
+  static_map<int, int> fm = freeze(msrc);
+  check_same(fm, mref);
+  check_same_reverse(fm, mref);
+  check_lookups(fm, mref, -1, 20001);
+  for (std::map<int, int>::iterator r = mref.begin(); r != mref.end(); ++r)
+    assert(fm.at(r->first) == r->second);
+  // 实值可以修改，键集合不变
+  for (static_map<int, int>::iterator it = fm.begin(); it != fm.end(); ++it)
+    (*it).second = -(*it).second;
+  for (std::map<int, int>::iterator r = mref.begin(); r != mref.end(); ++r)
+    r->second = -r->second;
+  fm.at(*sorted.begin()) = 7;
+  mref[*sorted.begin()] = 7;
+  check_same(fm, mref);
+  bool thrown = false;
+  try {
+    fm.at(-1);
+  } catch (std::out_of_range &) {
+    thrown = true;
+  }
+  assert(thrown);
+  fm.clear();
+  assert(fm.empty() && fm.begin() == fm.end() && fm.find(0) == fm.end());
+}
+
+// 只比较first，用来检查排序的稳定性
+struct first_less {
+  template <class P>
+  bool operator()(const P &a, const P &b) const { return a.first < b.first; }
+};
+
+void test_compact()
+{
+  // compact_list：位置随机的插入删除，被删节点的下标随后重用
+  compact_list<int> l;
+  std::list<int> ref;
+  for (int i = 0; i < 3000; ++i) {
+    size_t k = ref.empty() ? 0 : rand() % (ref.size() + 1);
+    if (ref.empty() || rand() % 3) {
+      assert(*l.insert(nth(l, k), i) == i);
+      ref.insert(nth(ref, k), i);
+    } else {
+      k = k % ref.size();
+      compact_list<int>::iterator it = l.erase(nth(l, k));
+      std::list<int>::iterator r = ref.erase(nth(ref, k));
+      assert(r == ref.end() ? it == l.end() : *it == *r);
+    }
+  }
+  check_same(l, ref);
+  check_same_reverse(l, ref);
+  l.reverse();
+  ref.reverse();
+  check_same(l, ref);
+  l.remove(ref.front());
+  ref.remove(ref.front());
+  check_same(l, ref);
+  l.sort();
+  ref.sort();
+  check_same(l, ref);
+  check_same_reverse(l, ref);
+  for (int i = 0; i < 100; ++i) {
+    l.push_back(i);
+    ref.push_back(i);
+  }
+  l.sort();
+  ref.sort();
+  l.unique();
+  ref.unique();
+  check_same(l, ref);
+
+  // 相等的键保持原来的先后
+  compact_list<std::pair<int, int> > pl;
+  std::list<std::pair<int, int> > pref;
+  for (int i = 0; i < 2000; ++i) {
+    std::pair<int, int> v(rand() % 50, i);
+    pl.push_back(v);
+    pref.push_back(v);
+  }
+  pl.sort(first_less());
+  pref.sort(first_less());
+  check_same(pl, pref);
+  check_same_reverse(pl, pref);
+  pl.push_front(std::make_pair(-1, -1));
+  pref.push_front(std::make_pair(-1, -1));
+  check_same(pl, pref);
+
+  // compact_set / compact_map：下标链接的红黑树
+  compact_set<int> s;
+  std::set<int> sref;
+  compact_map<int, int> m;
+  std::map<int, int> mref;
+  for (int i = 0; i < 20000; ++i) {
+    int k = rand() % 5000;
+    if (rand() % 3) {
+      bool fresh = sref.insert(k).second;
+      assert(s.insert(k).second == fresh);
+      assert(m.insert(pair<int, int>(k, i)).second == fresh);
+      mref.insert(std::make_pair(k, i));
+    } else {
+      size_t n = sref.erase(k);
+      assert(s.erase(k) == n);
+      assert(m.erase(k) == mref.erase(k));
+    }
+  }
+  check_same(s, sref);
+  check_same_reverse(s, sref);
+  check_same(m, mref);
+  check_same_reverse(m, mref);
+  check_lookups(s, sref, -1, 5001);
+  check_lookups(m, mref, -1, 5001);
+  for (int k = 4990; k < 5010; ++k) {
+    m[k] += 3;
+    mref[k] += 3;
+  }
+  check_same(m, mref);
+
+  compact_set<int> c(s);
+  c.erase(c.lower_bound(1000), c.lower_bound(4000));
+  std::set<int> cref(sref);
+  cref.erase(cref.lower_bound(1000), cref.lower_bound(4000));
+  check_same(c, cref);
+  check_same_reverse(c, cref);
+  check_same(s, sref);
+  compact_set<int> moved(std::move(c));
+  assert(c.empty());
+  check_same(moved, cref);
+  for (int k = 0; k < 1000; ++k) {
+    moved.insert(k * 7);
+    cref.insert(k * 7);
+  }
+  check_same(moved, cref);
+  m.erase(m.begin(), m.end());
+  assert(m.empty() && m.begin() == m.end());
+}
+
+void test_counted_multiset()
+{
+  counted_multiset<int> s;
+  std::multiset<int> ref;
+  for (int i = 0; i < 20000; ++i) {
+    int k = rand() % 300;
+    switch (rand() % 6) {
+      case 0: {  // 删除一次出现
+        counted_multiset<int>::iterator it = s.find(k);
+        assert((it == s.end()) == (ref.find(k) == ref.end()));
+        if (it != s.end()) {
+          s.erase(it);
+          ref.erase(ref.find(k));
+        }
+        break;
+      }
+      case 1:
+        if (rand() % 4 == 0)
+          assert(s.erase(k) == ref.erase(k));
+        break;
+      case 2: {
+        size_t n = rand() % 4;
+        counted_multiset<int>::iterator it = s.insert_n(k, n);
+        assert(it == s.lower_bound(k) || *it == k);
+        for (size_t j = 0; j < n; ++j)
+          ref.insert(k);
+        break;
+      }
+      default: {
+        counted_multiset<int>::iterator it = s.insert(k);
+        assert(*it == k && ++it == s.upper_bound(k));
+        ref.insert(k);
+      }
+    }
+  }
+  check_same(s, ref);
+  check_same_reverse(s, ref);
+  assert(s.distinct_size() == std::set<int>(ref.begin(), ref.end()).size());
+  for (int k = -1; k <= 300; ++k) {
+    assert(s.count(k) == ref.count(k));
+    size_t n = 0;
+    for (counted_multiset<int>::iterator it = s.equal_range(k).first;
+         it != s.equal_range(k).second; ++it, ++n)
+      assert(*it == k);
+    assert(n == ref.count(k));
+    std::multiset<int>::iterator lb = ref.lower_bound(k);
+    counted_multiset<int>::iterator slb = s.lower_bound(k);
+    assert(lb == ref.end() ? slb == s.end() : *slb == *lb);
+  }
+
+  // 区间的两端落在某个键值的若干次出现之间
+  std::vector<int> flat(ref.begin(), ref.end());
+  size_t lo = std::lower_bound(flat.begin(), flat.end(), 50) - flat.begin();
+  size_t hi = std::lower_bound(flat.begin(), flat.end(), 200) - flat.begin();
+  assert(ref.count(50) > 2 && ref.count(200) > 1);
+  lo += 2;
+  hi += 1;
+  counted_multiset<int> c(s);
+  assert(c == s && !(c < s) && !(s < c));
+  c.erase(nth(c, lo), nth(c, hi));
+  std::vector<int> cref(flat);
+  cref.erase(cref.begin() + lo, cref.begin() + hi);
+  check_same(c, cref);
+  check_same_reverse(c, cref);
+  assert(c.count(50) == 2 && c.count(200) == ref.count(200) - 1);
+  assert(!(c == s) && (c < s) != (s < c));
+  c.erase(c.begin(), c.end());
+  assert(c.empty() && c.size() == 0 && c.distinct_size() == 0);
+  check_same(s, ref);
+}